@@ -53,6 +53,7 @@
 #include "cafUiProcess.h"
 
 #include "RimUiTreeModelPdm.h"
+#include "RifEclipseCaseLoader.h"
 #include "RiaImageCompareReporter.h"
 #include "RiaImageFileCompare.h"
 
@@ -382,6 +383,8 @@ bool RIApplication::closeProject(bool askToSaveIfDirty)
         }
     }
 
+    cancelCaseLoading();
+
     mainWnd->cleanupGuiBeforeProjectClose();
 
     caf::EffectGenerator::clearEffectCache();
@@ -469,6 +472,160 @@ bool RIApplication::openEclipseCase(const QString& caseName, const QString& case
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/// Open the case without blocking the application. The grid, faults and cached data are computed in 
+/// a worker thread, and the grid is shown as soon as it is ready. The results and wells are read
+/// while the grid is shown, and attached when all of the case is read. 
+/// A progress dialog shows the current stage, and lets the user cancel the loading
+//--------------------------------------------------------------------------------------------------
+bool RIApplication::openEclipseCaseInBackground(const QString& fileName)
+{
+    if (!QFile::exists(fileName)) return false;
+
+    QFileInfo gridFileName(fileName);
+
+    RimResultReservoir* rimResultReservoir = new RimResultReservoir();
+    rimResultReservoir->caseName = gridFileName.completeBaseName();
+    rimResultReservoir->caseFileName = fileName;
+    rimResultReservoir->caseDirectory = gridFileName.absolutePath();
+
+    // The case is added to the project when the grid is loaded
+
+    RifEclipseCaseLoader* loader = new RifEclipseCaseLoader(fileName, this);
+    loader->setWeldCoincidentNodes(m_preferences->shareCoincidentGridNodes);
+    loader->setResultCacheFileEnabled(m_preferences->useResultCacheFile);
+
+    m_caseLoaders[loader] = rimResultReservoir;
+
+    QProgressDialog* progressDialog = new QProgressDialog(RIMainWindow::instance());
+    progressDialog->setWindowTitle("Opening " + rimResultReservoir->caseName());
+    progressDialog->setWindowModality(Qt::NonModal);
+    progressDialog->setRange(0, 0);
+    progressDialog->setMinimumDuration(0);
+
+    connect(loader, SIGNAL(stageStarted(QString)), progressDialog, SLOT(setLabelText(QString)));
+    connect(progressDialog, SIGNAL(canceled()), loader, SLOT(cancel()));
+    connect(loader, SIGNAL(finished()), progressDialog, SLOT(deleteLater()));
+
+    connect(loader, SIGNAL(geometryLoaded()), this, SLOT(slotCaseGeometryLoaded()));
+    connect(loader, SIGNAL(finished()), this, SLOT(slotCaseLoadingFinished()));
+
+    loader->start();
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Add the case to the project and show its grid, while the rest of the case is read
+//--------------------------------------------------------------------------------------------------
+void RIApplication::slotCaseGeometryLoaded()
+{
+    RifEclipseCaseLoader* loader = qobject_cast<RifEclipseCaseLoader*>(sender());
+
+    std::map<RifEclipseCaseLoader*, caf::PdmPointer<RimResultReservoir> >::iterator it = m_caseLoaders.find(loader);
+    if (it == m_caseLoaders.end() || it->second.isNull() || loader->isCancelled()) return;
+
+    RimResultReservoir* rimResultReservoir = it->second;
+    rimResultReservoir->attachLoadedGeometry(loader);
+
+    m_project->reservoirs.push_back(rimResultReservoir);
+
+    RimReservoirView* riv = rimResultReservoir->createAndAddReservoirView();
+
+    if (m_preferences->autocomputeSOIL)
+    {
+        // Select SOIL as default result variable. It is loaded when the results are attached
+        riv->cellResult()->resultType = RimDefines::DYNAMIC_NATIVE;
+        riv->cellResult()->resultVariable = "SOIL";
+        riv->animationMode = true;
+    }
+
+    riv->loadDataAndUpdate();
+
+    onProjectOpenedOrClosed();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Attach the results and wells to the case and update its views. A case that was cancelled or 
+/// could not be read is removed
+//--------------------------------------------------------------------------------------------------
+void RIApplication::slotCaseLoadingFinished()
+{
+    RifEclipseCaseLoader* loader = qobject_cast<RifEclipseCaseLoader*>(sender());
+
+    std::map<RifEclipseCaseLoader*, caf::PdmPointer<RimResultReservoir> >::iterator it = m_caseLoaders.find(loader);
+    if (it == m_caseLoaders.end()) return;
+
+    caf::PdmPointer<RimResultReservoir> rimResultReservoir = it->second;
+    m_caseLoaders.erase(it);
+    loader->deleteLater();
+
+    // The case is gone if the project was closed while the case was loaded
+    if (rimResultReservoir.isNull()) return;
+
+    bool isInProject = rimResultReservoir->reservoirData() != NULL;
+
+    if (loader->isCompleted() && isInProject)
+    {
+        rimResultReservoir->attachLoadedResults(loader);
+
+        size_t i;
+        for (i = 0; i < rimResultReservoir->reservoirViews().size(); ++i)
+        {
+            RimReservoirView* riv = rimResultReservoir->reservoirViews()[i];
+            CVF_ASSERT(riv);
+
+            riv->loadDataAndUpdate();
+
+            if (!riv->cellResult()->hasResult())
+            {
+                riv->cellResult()->resultVariable = RimDefines::undefinedResultName();
+            }
+        }
+
+        return;
+    }
+
+    if (!loader->isCancelled())
+    {
+        QMessageBox::warning(RIMainWindow::instance(), "Error when opening case", "Could not open the Eclipse Grid file (EGRID/GRID): \n" + loader->fileName());
+    }
+
+    if (isInProject)
+    {
+        m_project->reservoirs().removeChildObject(rimResultReservoir.p());
+    }
+
+    delete rimResultReservoir.p();
+
+    if (isInProject)
+    {
+        onProjectOpenedOrClosed();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Stop all the cases being loaded in the background, and delete the ones not yet in the project
+//--------------------------------------------------------------------------------------------------
+void RIApplication::cancelCaseLoading()
+{
+    std::map<RifEclipseCaseLoader*, caf::PdmPointer<RimResultReservoir> >::iterator it;
+    for (it = m_caseLoaders.begin(); it != m_caseLoaders.end(); ++it)
+    {
+        RifEclipseCaseLoader* loader = it->first;
+        loader->cancel();
+        loader->wait();
+        loader->deleteLater();
+
+        if (it->second.notNull() && it->second->reservoirData() == NULL)
+        {
+            delete it->second.p();
+        }
+    }
+
+    m_caseLoaders.clear();
+}
+
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
@@ -32,6 +32,8 @@
 class RIProcess;
 class RigReservoir;
 class RimReservoir;
+class RimResultReservoir;
+class RifEclipseCaseLoader;
 class Drawable;
 class RiaSocketServer;
 class RIPreferences;
@@ -80,6 +82,7 @@ public:
 
     bool                openEclipseCaseFromFile(const QString& fileName);
     bool                openEclipseCase(const QString& caseName, const QString& caseFileName);
+    bool                openEclipseCaseInBackground(const QString& fileName);
     bool                openInputEclipseCase(const QString& caseName, const QStringList& caseFileNames);
 
     bool                loadLastUsedProject();
@@ -123,11 +126,14 @@ public:
 private:
     void		        onProjectOpenedOrClosed();
     void		        setWindowCaptionFromAppState();
+    void                cancelCaseLoading();
     
    
 
 private slots:
     void                slotWorkerProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void                slotCaseGeometryLoaded();
+    void                slotCaseLoadingFinished();
 
 
 private:
@@ -141,5 +147,7 @@ private:
     RIPreferences*                  m_preferences;
 
     std::map<QString, QString>      m_fileDialogDefaultDirectories;
+
+    std::map<RifEclipseCaseLoader*, caf::PdmPointer<RimResultReservoir> > m_caseLoaders; ///< Cases being loaded in the background
     QString                         m_startupDefaultDirectory;
 };
@@ -42,12 +42,17 @@ RIPreferences::RIPreferences(void)
 
     CAF_PDM_InitField(&useShaders,                      "useShaders", true, "Use Shaders", "", "", "");
     CAF_PDM_InitField(&showHud,                         "showHud", false, "Show 3D Information", "", "", "");
+    CAF_PDM_InitField(&useCellResultTextures,           "useCellResultTextures", false, "Color cells on the GPU", "", "Upload one color per cell when the time step changes, and let the shader find the color of each cell face", "");
 
     CAF_PDM_InitFieldNoDefault(&lastUsedProjectFileName,"lastUsedProjectFileName", "Last Used Project File", "", "", "");
     lastUsedProjectFileName.setUiHidden(true);
 
     CAF_PDM_InitField(&autocomputeSOIL,                 "autocomputeSOIL", true, "SOIL", "", "SOIL = 1.0 - SGAS - SWAT", "");
     CAF_PDM_InitField(&autocomputeDepthRelatedProperties,"autocomputeDepth", true, "DEPTH related properties", "", "DEPTH, DX, DY, DZ, TOP, BOTTOM", "");
+
+    CAF_PDM_InitField(&shareCoincidentGridNodes,        "shareCoincidentGridNodes", true, "Share coincident grid nodes", "", "Store corner nodes shared by neighbour cells only once to reduce memory usage", "");
+    CAF_PDM_InitField(&useResultCacheFile,              "useResultCacheFile", false, "Cache results next to case", "", "Store results read from Eclipse files in a binary file next to the case, making them faster to read when the case is opened again", "");
+    CAF_PDM_InitField(&resultTimeStepMemoryBudget,      "resultTimeStepMemoryBudget", 2048, "Dynamic results memory (MB)", "", "Max memory used by time steps read from file. The least recently used time steps are released when exceeded. 0 means unlimited", "");
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -88,9 +93,15 @@ void RIPreferences::defineUiOrdering(QString uiConfigName, caf::PdmUiOrdering& u
     caf::PdmUiGroup* defaultSettingsGroup = uiOrdering.addNewGroup("Default settings");
     defaultSettingsGroup->add(&defaultScaleFactorZ);
     defaultSettingsGroup->add(&defaultGridLines);
+    defaultSettingsGroup->add(&useCellResultTextures);
 
     caf::PdmUiGroup* autoComputeGroup = uiOrdering.addNewGroup("Compute when loading new case");
     autoComputeGroup->add(&autocomputeSOIL);
     autoComputeGroup->add(&autocomputeDepthRelatedProperties);
+
+    caf::PdmUiGroup* memoryGroup = uiOrdering.addNewGroup("Memory usage");
+    memoryGroup->add(&shareCoincidentGridNodes);
+    memoryGroup->add(&resultTimeStepMemoryBudget);
+    memoryGroup->add(&useResultCacheFile);
 }
 
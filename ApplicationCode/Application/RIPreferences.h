@@ -41,12 +41,17 @@ public: // Pdm Fields
 
     caf::PdmField<bool>     useShaders;
     caf::PdmField<bool>     showHud;
+    caf::PdmField<bool>     useCellResultTextures;
 
     caf::PdmField<QString>  lastUsedProjectFileName;
 
     caf::PdmField<bool>     autocomputeSOIL;
     caf::PdmField<bool>     autocomputeDepthRelatedProperties;
 
+    caf::PdmField<bool>     shareCoincidentGridNodes;
+    caf::PdmField<int>      resultTimeStepMemoryBudget;
+    caf::PdmField<bool>     useResultCacheFile;
+
 
 protected:
     virtual void defineEditorAttribute(const caf::PdmFieldHandle* field, QString uiConfigName, caf::PdmUiEditorAttribute* attribute);
@@ -0,0 +1,165 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include "RIStdInclude.h"
+#include "gtest/gtest.h"
+
+#include "RifEclipseResultCacheFile.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+static void writeSourceFile(const QString& fileName, const QByteArray& contents)
+{
+    QFile file(fileName);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    ASSERT_EQ(contents.size(), file.write(contents));
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Source file and cache file in the temp directory, with the cache file removed
+//--------------------------------------------------------------------------------------------------
+static void createTestFiles(QStringList* sourceFileSet, QString* cacheFileName)
+{
+    QString sourceFileName = QDir::tempPath() + "/RifEclipseResultCacheFileTest.UNRST";
+    writeSourceFile(sourceFileName, "RESTART1");
+
+    sourceFileSet->clear();
+    sourceFileSet->append(sourceFileName);
+
+    *cacheFileName = RifEclipseResultCacheFile::cacheFileName(sourceFileName);
+    QFile::remove(*cacheFileName);
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+TEST(RifEclipseResultCacheFileTest, WriteAndReopen)
+{
+    QStringList sourceFileSet;
+    QString cacheFileName;
+    createTestFiles(&sourceFileSet, &cacheFileName);
+
+    std::vector<double> floatValues;
+    floatValues.push_back(1.0);
+    floatValues.push_back(0.25);
+    floatValues.push_back(HUGE_VAL);
+
+    std::vector<double> doubleValues;
+    doubleValues.push_back(0.1);
+    doubleValues.push_back(1.0e-300);
+
+    {
+        cvf::ref<RifEclipseResultCacheFile> cacheFile = new RifEclipseResultCacheFile;
+        ASSERT_TRUE(cacheFile->open(cacheFileName, sourceFileSet));
+        EXPECT_TRUE(cacheFile->addValues("SOIL", &floatValues[0], floatValues.size()));
+        EXPECT_TRUE(cacheFile->addValues("PRESSURE", &doubleValues[0], doubleValues.size()));
+
+        // The same case opened again while the cache is being appended to does not use it
+        cvf::ref<RifEclipseResultCacheFile> otherCacheFile = new RifEclipseResultCacheFile;
+        EXPECT_FALSE(otherCacheFile->open(cacheFileName, sourceFileSet));
+    }
+
+    cvf::ref<RifEclipseResultCacheFile> cacheFile = new RifEclipseResultCacheFile;
+    ASSERT_TRUE(cacheFile->open(cacheFileName, sourceFileSet));
+    EXPECT_FALSE(cacheFile->hasValues("SWAT"));
+
+    size_t valueCount = 0;
+    const float* singlePrecisionValues = cacheFile->singlePrecisionValues("SOIL", &valueCount);
+    ASSERT_TRUE(singlePrecisionValues != NULL);
+    ASSERT_EQ(floatValues.size(), valueCount);
+    EXPECT_EQ(0.25f, singlePrecisionValues[1]);
+    EXPECT_EQ(HUGE_VAL, singlePrecisionValues[2]);
+
+    EXPECT_TRUE(cacheFile->singlePrecisionValues("PRESSURE", &valueCount) == NULL);
+
+    std::vector<double> values;
+    ASSERT_TRUE(cacheFile->values("PRESSURE", &values));
+    EXPECT_TRUE(values == doubleValues);
+
+    values.clear();
+    ASSERT_TRUE(cacheFile->values("SOIL", &values));
+    EXPECT_TRUE(values == floatValues);
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+TEST(RifEclipseResultCacheFileTest, StaleCacheIsReset)
+{
+    QStringList sourceFileSet;
+    QString cacheFileName;
+    createTestFiles(&sourceFileSet, &cacheFileName);
+
+    double value = 1.0;
+    {
+        cvf::ref<RifEclipseResultCacheFile> cacheFile = new RifEclipseResultCacheFile;
+        ASSERT_TRUE(cacheFile->open(cacheFileName, sourceFileSet));
+        EXPECT_TRUE(cacheFile->addValues("SOIL", &value, 1));
+    }
+
+    // Rewrite the source file with the same size, typically within the same second
+    QDateTime lastModified = QFileInfo(sourceFileSet[0]).lastModified();
+    for (int i = 0; i < 100000 && QFileInfo(sourceFileSet[0]).lastModified() == lastModified; ++i)
+    {
+        writeSourceFile(sourceFileSet[0], "RESTART2");
+    }
+
+    cvf::ref<RifEclipseResultCacheFile> cacheFile = new RifEclipseResultCacheFile;
+    ASSERT_TRUE(cacheFile->open(cacheFileName, sourceFileSet));
+    EXPECT_FALSE(cacheFile->hasValues("SOIL"));
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+TEST(RifEclipseResultCacheFileTest, TruncatedFileIsReset)
+{
+    QStringList sourceFileSet;
+    QString cacheFileName;
+    createTestFiles(&sourceFileSet, &cacheFileName);
+
+    std::vector<double> values(100, 1.0);
+    {
+        cvf::ref<RifEclipseResultCacheFile> cacheFile = new RifEclipseResultCacheFile;
+        ASSERT_TRUE(cacheFile->open(cacheFileName, sourceFileSet));
+        EXPECT_TRUE(cacheFile->addValues("SOIL", &values[0], values.size()));
+        EXPECT_TRUE(cacheFile->addValues("SWAT", &values[0], values.size()));
+    }
+
+    // Cut the file in the middle of the last block
+    {
+        QFile file(cacheFileName);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        ASSERT_TRUE(file.resize(file.size() - 100));
+    }
+
+    cvf::ref<RifEclipseResultCacheFile> cacheFile = new RifEclipseResultCacheFile;
+    ASSERT_TRUE(cacheFile->open(cacheFileName, sourceFileSet));
+    EXPECT_FALSE(cacheFile->hasValues("SOIL"));
+    EXPECT_FALSE(cacheFile->hasValues("SWAT"));
+
+    // The reset cache is usable again
+    EXPECT_TRUE(cacheFile->addValues("SOIL", &values[0], values.size()));
+    EXPECT_TRUE(cacheFile->hasValues("SOIL"));
+}
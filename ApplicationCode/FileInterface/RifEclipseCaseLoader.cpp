@@ -0,0 +1,150 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#include "RifEclipseCaseLoader.h"
+
+#include "RigReservoir.h"
+#include "RigMainGrid.h"
+#include "RigReservoirCellResults.h"
+#include "RifReaderEclipseOutput.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RifEclipseCaseLoader::RifEclipseCaseLoader(const QString& fileName, QObject* parent)
+    : QThread(parent),
+    m_fileName(fileName),
+    m_weldCoincidentNodes(false),
+    m_useResultCacheFile(false),
+    m_cancelRequested(0),
+    m_isGeometryLoaded(false),
+    m_isCompleted(false)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RifEclipseCaseLoader::~RifEclipseCaseLoader()
+{
+    cancel();
+    wait();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Ask the loader to stop. It stops when the current stage is done
+//--------------------------------------------------------------------------------------------------
+void RifEclipseCaseLoader::cancel()
+{
+    m_cancelRequested.fetchAndStoreOrdered(1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+bool RifEclipseCaseLoader::isCancelled() const
+{
+    return m_cancelRequested != 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The reservoir is available when geometryLoaded() is emitted. From then on the worker thread only 
+/// reads the grid, so the grid can be displayed while the rest of the case is loaded
+//--------------------------------------------------------------------------------------------------
+RigReservoir* RifEclipseCaseLoader::reservoir()
+{
+    return m_isGeometryLoaded ? m_reservoir.p() : NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The reader, and the results and wells read by it, are available when the thread has finished
+/// and isCompleted() is true
+//--------------------------------------------------------------------------------------------------
+RifReaderEclipseOutput* RifEclipseCaseLoader::reader()
+{
+    return m_isCompleted ? m_reader.p() : NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RigReservoirCellResults* RifEclipseCaseLoader::results(RifReaderInterface::PorosityModelResultType porosityModel)
+{
+    if (!m_isCompleted) return NULL;
+
+    if (porosityModel == RifReaderInterface::MATRIX_RESULTS)
+    {
+        return m_matrixModelResults.p();
+    }
+
+    return m_fractureModelResults.p();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Run the stages of loading the case, checking for cancel between each of them.
+/// Progress is reported by stageStarted() only, as caf::ProgressInfo does nothing outside the GUI thread
+//--------------------------------------------------------------------------------------------------
+void RifEclipseCaseLoader::run()
+{
+    m_reservoir = new RigReservoir;
+    m_reader = new RifReaderEclipseOutput;
+    m_reader->setResultCacheFileEnabled(m_useResultCacheFile);
+
+    emit stageStarted("Reading grid");
+
+    if (!m_reader->openGrid(m_fileName, m_reservoir.p())) return;
+    if (isCancelled()) return;
+
+    RigMainGrid* mainGrid = m_reservoir->mainGrid();
+
+    if (m_weldCoincidentNodes)
+    {
+        emit stageStarted("Sharing coincident grid nodes");
+        mainGrid->weldCoincidentNodes();
+        if (isCancelled()) return;
+    }
+
+    emit stageStarted("Computing faults");
+    m_reservoir->computeFaults();
+    if (isCancelled()) return;
+
+    emit stageStarted("Computing cache");
+    mainGrid->computeCachedData();
+    if (isCancelled()) return;
+
+    // The grid is complete. The rest is read into objects the main thread does not see yet
+
+    m_isGeometryLoaded = true;
+    emit geometryLoaded();
+
+    emit stageStarted("Reading result index");
+
+    m_matrixModelResults = new RigReservoirCellResults(mainGrid);
+    m_fractureModelResults = new RigReservoirCellResults(mainGrid);
+
+    if (!m_reader->readResultMetaData(m_matrixModelResults.p(), m_fractureModelResults.p())) return;
+    if (isCancelled()) return;
+
+    emit stageStarted("Reading well information");
+    m_reader->readWellCells(m_reservoir.p(), &m_wellResults);
+    if (isCancelled()) return;
+
+    m_isCompleted = true;
+}
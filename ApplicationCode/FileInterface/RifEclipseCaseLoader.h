@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "cvfBase.h"
+#include "cvfObject.h"
+#include "cvfCollection.h"
+
+#include "RifReaderInterface.h"
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QString>
+
+class RigReservoir;
+class RigReservoirCellResults;
+class RigWellResults;
+class RifReaderEclipseOutput;
+
+
+//==================================================================================================
+//
+// Reads an Eclipse case in a worker thread, in stages: Grid, geometry, faults, result meta data
+// and wells. geometryLoaded() is emitted as soon as the grid can be displayed, while the results
+// and wells are read into objects that are not yet attached to the reservoir. They can be attached
+// from the main thread when the thread has finished.
+// Loading can be cancelled between the stages.
+//
+//==================================================================================================
+class RifEclipseCaseLoader : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit RifEclipseCaseLoader(const QString& fileName, QObject* parent = 0);
+    virtual ~RifEclipseCaseLoader();
+
+    void                                    setWeldCoincidentNodes(bool weld)       { m_weldCoincidentNodes = weld; }
+    void                                    setResultCacheFileEnabled(bool enable)  { m_useResultCacheFile = enable; }
+
+    QString                                 fileName() const        { return m_fileName; }
+    bool                                    isGeometryLoaded() const { return m_isGeometryLoaded; }
+    bool                                    isCompleted() const     { return m_isCompleted; }
+    bool                                    isCancelled() const;
+
+    RigReservoir*                           reservoir();
+    RifReaderEclipseOutput*                 reader();
+    RigReservoirCellResults*                results(RifReaderInterface::PorosityModelResultType porosityModel);
+    const cvf::Collection<RigWellResults>&  wellResults() const     { return m_wellResults; }
+
+public slots:
+    void                                    cancel();
+
+signals:
+    void                                    stageStarted(const QString& description);
+    void                                    geometryLoaded();
+
+protected:
+    virtual void                            run();
+
+private:
+    QString                                 m_fileName;
+    bool                                    m_weldCoincidentNodes;
+    bool                                    m_useResultCacheFile;
+
+    cvf::ref<RigReservoir>                  m_reservoir;
+    cvf::ref<RifReaderEclipseOutput>        m_reader;
+    cvf::ref<RigReservoirCellResults>       m_matrixModelResults;
+    cvf::ref<RigReservoirCellResults>       m_fractureModelResults;
+    cvf::Collection<RigWellResults>         m_wellResults;
+
+    QAtomicInt                              m_cancelRequested;
+    bool                                    m_isGeometryLoaded;
+    bool                                    m_isCompleted;
+};
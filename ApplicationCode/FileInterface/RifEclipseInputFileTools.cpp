@@ -154,7 +154,7 @@ bool RifEclipseInputFileTools::openGridFile(const QString& fileName, RigReservoi
 
     progress.setProgress(6);
 
-    RifReaderEclipseOutput::transferGeometry(inputGrid, reservoir);
+    bool isTransferred = RifReaderEclipseOutput::transferGeometry(inputGrid, reservoir);
 
     progress.setProgress(7);
     progress.setProgressDescription("Cleaning up ...");
@@ -165,11 +165,11 @@ bool RifEclipseInputFileTools::openGridFile(const QString& fileName, RigReservoi
     if (actNumKw) ecl_kw_free(actNumKw);
     if (mapAxesKw) ecl_kw_free(mapAxesKw);
 
-    ecl_grid_free(inputGrid);
+    if (inputGrid) ecl_grid_free(inputGrid);
 
     util_fclose(gridFilePointer);
     
-    return true;
+    return isTransferred;
 }
 
 
@@ -151,7 +151,7 @@ void RifEclipseOutputFileTools::timeSteps(ecl_file_type* ecl_file, QList<QDateTi
 
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Append the values of the given keyword occurrence to values
 //--------------------------------------------------------------------------------------------------
 bool RifEclipseOutputFileTools::keywordData(ecl_file_type* ecl_file, const QString& keyword, size_t fileKeywordOccurrence, std::vector<double>* values)
 {
@@ -160,11 +160,14 @@ bool RifEclipseOutputFileTools::keywordData(ecl_file_type* ecl_file, const QStri
     {
         size_t numValues = ecl_kw_get_size(kwData);
 
-        std::vector<double> doubleData;
-        doubleData.resize(numValues);
+        // Convert directly into the end of the destination, avoiding an intermediate copy
+        size_t startPosition = values->size();
+        values->resize(startPosition + numValues);
 
-        ecl_kw_get_data_as_double(kwData, doubleData.data());
-        values->insert(values->end(), doubleData.begin(), doubleData.end());
+        if (numValues > 0)
+        {
+            ecl_kw_get_data_as_double(kwData, &(*values)[startPosition]);
+        }
 
         return true;
     }
@@ -148,14 +148,10 @@ bool RifEclipseRestartFilesetAccess::results(const QString& resultName, size_t t
     size_t i;
     for (i = 0; i < numOccurrences; i++)
     {
-        std::vector<double> partValues;
-
-        if (!RifEclipseOutputFileTools::keywordData(m_ecl_files[timeStep], resultName, i, &partValues))
+        if (!RifEclipseOutputFileTools::keywordData(m_ecl_files[timeStep], resultName, i, values))
         {
             return false;
         }
-
-        values->insert(values->end(), partValues.begin(), partValues.end());
     }
 
     return true;
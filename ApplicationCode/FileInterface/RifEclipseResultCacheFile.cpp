@@ -0,0 +1,506 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include "RifEclipseResultCacheFile.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+
+#include <cstring>
+
+#ifdef WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/file.h>
+#endif
+
+namespace
+{
+    const char      cacheFileMagic[8]   = { 'R', 'I', 'C', 'A', 'C', 'H', 'E', '\0' };
+    const quint32   cacheFileVersion    = 2;
+    const quint32   cacheByteOrderMark  = 0x01020304;
+
+    // Header: magic, version, byte order mark, source size, source signature, committed size
+    const qint64    headerCommittedSizePosition = 32;
+    const qint64    headerSize                  = 64;
+
+    // The file is grown by at least this amount at a time, to avoid remapping it on every append
+    const qint64    fileGrowthChunkSize         = 64*1024*1024;
+
+    qint64 alignedOffset(qint64 offset)
+    {
+        return (offset + 7) & ~qint64(7);
+    }
+
+    template <typename T>
+    bool writeValue(QFile& file, const T& value)
+    {
+        return file.write(reinterpret_cast<const char*>(&value), sizeof(T)) == sizeof(T);
+    }
+
+    template <typename T>
+    bool readValue(QFile& file, T* value)
+    {
+        return file.read(reinterpret_cast<char*>(value), sizeof(T)) == sizeof(T);
+    }
+
+    // Advisory lock on the whole file, released when the file is closed. Does not wait for other holders
+    bool lockFile(QFile& file, bool exclusive)
+    {
+#ifdef WIN32
+        HANDLE fileHandle = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(overlapped));
+
+        DWORD flags = LOCKFILE_FAIL_IMMEDIATELY | (exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0);
+        return LockFileEx(fileHandle, flags, 0, MAXDWORD, MAXDWORD, &overlapped) != 0;
+#else
+        return flock(file.handle(), LOCK_NB | (exclusive ? LOCK_EX : LOCK_SH)) == 0;
+#endif
+    }
+
+    void unlockFile(QFile& file)
+    {
+#ifdef WIN32
+        HANDLE fileHandle = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(overlapped));
+
+        UnlockFileEx(fileHandle, 0, MAXDWORD, MAXDWORD, &overlapped);
+#else
+        flock(file.handle(), LOCK_UN);
+#endif
+    }
+
+    // FNV-1a hash of the bytes, continuing from the given hash value
+    quint64 addToHash(quint64 hash, const char* data, size_t byteCount)
+    {
+        for (size_t i = 0; i < byteCount; i++)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    bool padToOffset(QFile& file, qint64 offset)
+    {
+        qint64 padding = offset - file.size();
+        if (padding <= 0) return true;
+
+        if (!file.seek(file.size())) return false;
+
+        QByteArray zeros(static_cast<int>(padding), '\0');
+        return file.write(zeros) == padding;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RifEclipseResultCacheFile::RifEclipseResultCacheFile()
+    : m_mappedData(NULL),
+    m_isAppendable(false),
+    m_sourceSize(0),
+    m_sourceSignature(0),
+    m_committedSize(0)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RifEclipseResultCacheFile::~RifEclipseResultCacheFile()
+{
+    close();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Open the cache file, or create it if it does not exist or was written for other source files.
+/// The source files are identified by their total size, and a hash of the name, size and modification
+/// time in milliseconds of each file.
+/// Results are only appended by the one holding an exclusive lock on the file. When another reader
+/// of the case is appending, the cache is not used. When others are only reading it, it is used as it is
+//--------------------------------------------------------------------------------------------------
+bool RifEclipseResultCacheFile::open(const QString& cacheFileName, const QStringList& sourceFileSet)
+{
+    close();
+
+    m_sourceSize = 0;
+    m_sourceSignature = 14695981039346656037ULL;
+    for (int i = 0; i < sourceFileSet.size(); i++)
+    {
+        QFileInfo fi(sourceFileSet[i]);
+        QByteArray fileName = fi.fileName().toUtf8();
+        qint64 fileSize = fi.size();
+        qint64 fileModified = fi.lastModified().toMSecsSinceEpoch();
+
+        m_sourceSize += fileSize;
+
+        m_sourceSignature = addToHash(m_sourceSignature, fileName.constData(), fileName.size());
+        m_sourceSignature = addToHash(m_sourceSignature, reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+        m_sourceSignature = addToHash(m_sourceSignature, reinterpret_cast<const char*>(&fileModified), sizeof(fileModified));
+    }
+
+    m_file.setFileName(cacheFileName);
+
+    if (m_file.open(QIODevice::ReadWrite))
+    {
+        if (lockFile(m_file, true))
+        {
+            m_isAppendable = true;
+
+            if (m_file.size() > 0 && readHeaderAndIndex()) return true;
+
+            // Stale or unreadable cache, start over
+            m_blocks.clear();
+            if (m_file.resize(0) && writeEmptyFile()) return true;
+        }
+        else if (lockFile(m_file, false))
+        {
+            // Used by another reader of the case. Use it without appending
+            if (readHeaderAndIndex()) return true;
+        }
+    }
+    else if (m_file.open(QIODevice::ReadOnly))
+    {
+        // Cache next to a case in a read only location can still be used when it is up to date
+        if (lockFile(m_file, false) && readHeaderAndIndex()) return true;
+    }
+
+    close();
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RifEclipseResultCacheFile::close()
+{
+    unmap();
+
+    if (m_file.isOpen())
+    {
+        // Drop the unused part of the last growth chunk
+        if (m_isAppendable && m_committedSize >= headerSize && m_file.size() > m_committedSize)
+        {
+            m_file.resize(m_committedSize);
+        }
+
+        unlockFile(m_file);
+        m_file.close();
+    }
+
+    m_isAppendable = false;
+    m_blocks.clear();
+    m_committedSize = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+bool RifEclipseResultCacheFile::hasValues(const QString& key) const
+{
+    return m_blocks.find(key) != m_blocks.end();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Append the cached values for the given key to values. Returns false if the key is not cached
+//--------------------------------------------------------------------------------------------------
+bool RifEclipseResultCacheFile::values(const QString& key, std::vector<double>* values)
+{
+    CVF_ASSERT(values);
+
+    std::map<QString, BlockInfo>::const_iterator it = m_blocks.find(key);
+    if (it == m_blocks.end()) return false;
+
+    const BlockInfo& block = it->second;
+    size_t valueSize = block.m_isSinglePrecision ? sizeof(float) : sizeof(double);
+
+    if (block.m_offset + static_cast<qint64>(block.m_valueCount * valueSize) > m_file.size()) return false;
+
+    const uchar* data = mappedData();
+    if (!data) return false;
+
+    size_t startPosition = values->size();
+    values->resize(startPosition + block.m_valueCount);
+
+    if (block.m_isSinglePrecision)
+    {
+        const float* source = reinterpret_cast<const float*>(data + block.m_offset);
+        for (size_t i = 0; i < block.m_valueCount; i++)
+        {
+            (*values)[startPosition + i] = source[i];
+        }
+    }
+    else if (block.m_valueCount > 0)
+    {
+        memcpy(&(*values)[startPosition], data + block.m_offset, block.m_valueCount * sizeof(double));
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The single precision values cached for the given key, referenced in the file mapping without
+/// copying. Returns NULL if the key is not cached, or is cached in double precision.
+/// The values are valid until the next call to addValues() or close()
+//--------------------------------------------------------------------------------------------------
+const float* RifEclipseResultCacheFile::singlePrecisionValues(const QString& key, size_t* valueCount)
+{
+    CVF_ASSERT(valueCount);
+
+    std::map<QString, BlockInfo>::const_iterator it = m_blocks.find(key);
+    if (it == m_blocks.end() || !it->second.m_isSinglePrecision) return NULL;
+
+    const BlockInfo& block = it->second;
+    if (block.m_offset + static_cast<qint64>(block.m_valueCount * sizeof(float)) > m_file.size()) return NULL;
+
+    const uchar* data = mappedData();
+    if (!data) return NULL;
+
+    *valueCount = static_cast<size_t>(block.m_valueCount);
+
+    return reinterpret_cast<const float*>(data + block.m_offset);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Append a value block to the cache file. Values that survive a round trip through float
+/// (which is the case for most Eclipse data) are stored in single precision
+//--------------------------------------------------------------------------------------------------
+bool RifEclipseResultCacheFile::addValues(const QString& key, const double* values, size_t valueCount)
+{
+    if (!m_file.isOpen() || !m_isAppendable) return false;
+    if (hasValues(key)) return true;
+
+    bool isSinglePrecision = true;
+    for (size_t i = 0; i < valueCount; i++)
+    {
+        if (static_cast<double>(static_cast<float>(values[i])) != values[i])
+        {
+            isSinglePrecision = false;
+            break;
+        }
+    }
+
+    QByteArray keyData = key.toUtf8();
+    quint32 keyLength = static_cast<quint32>(keyData.size());
+    quint32 singlePrecisionFlag = isSinglePrecision ? 1 : 0;
+    quint64 blockValueCount = valueCount;
+
+    size_t valueSize = isSinglePrecision ? sizeof(float) : sizeof(double);
+    qint64 recordHeaderSize = sizeof(keyLength) + keyData.size() + sizeof(singlePrecisionFlag) + sizeof(blockValueCount);
+    qint64 requiredSize = alignedOffset(alignedOffset(m_committedSize + recordHeaderSize) + static_cast<qint64>(valueCount * valueSize));
+
+    if (!reserveFileSize(requiredSize)) return false;
+
+    // Any partially written record from an earlier failure is overwritten
+    if (!m_file.seek(m_committedSize)) return false;
+
+    if (!writeValue(m_file, keyLength)) return false;
+    if (m_file.write(keyData) != keyData.size()) return false;
+    if (!writeValue(m_file, singlePrecisionFlag)) return false;
+    if (!writeValue(m_file, blockValueCount)) return false;
+
+    BlockInfo block;
+    block.m_offset = alignedOffset(m_file.pos());
+    block.m_valueCount = valueCount;
+    block.m_isSinglePrecision = isSinglePrecision;
+
+    if (!m_file.seek(block.m_offset)) return false;
+
+    if (isSinglePrecision)
+    {
+        std::vector<float> floatValues(values, values + valueCount);
+        qint64 byteCount = static_cast<qint64>(valueCount * sizeof(float));
+        if (valueCount > 0 && m_file.write(reinterpret_cast<const char*>(&floatValues[0]), byteCount) != byteCount) return false;
+    }
+    else
+    {
+        qint64 byteCount = static_cast<qint64>(valueCount * sizeof(double));
+        if (valueCount > 0 && m_file.write(reinterpret_cast<const char*>(values), byteCount) != byteCount) return false;
+    }
+
+    qint64 committedSize = alignedOffset(m_file.pos());
+    if (!writeCommittedSize(committedSize)) return false;
+
+    m_blocks[key] = block;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The cache file is placed next to the case file, using the case base name
+//--------------------------------------------------------------------------------------------------
+QString RifEclipseResultCacheFile::cacheFileName(const QString& caseFileName)
+{
+    QFileInfo fi(caseFileName);
+    return fi.absolutePath() + "/" + fi.completeBaseName() + ".RICACHE";
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+QString RifEclipseResultCacheFile::resultKey(const QString& resultName, int porosityModel, size_t timeStepIndex)
+{
+    return QString("%1:%2:%3").arg(resultName).arg(porosityModel).arg(static_cast<qulonglong>(timeStepIndex));
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Validate the header and build the block index by walking the committed records
+//--------------------------------------------------------------------------------------------------
+bool RifEclipseResultCacheFile::readHeaderAndIndex()
+{
+    m_blocks.clear();
+    m_committedSize = 0;
+
+    if (m_file.size() < headerSize) return false;
+    if (!m_file.seek(0)) return false;
+
+    char magic[sizeof(cacheFileMagic)];
+    quint32 version = 0;
+    quint32 byteOrderMark = 0;
+    qint64 sourceSize = 0;
+    quint64 sourceSignature = 0;
+    qint64 committedSize = 0;
+
+    if (m_file.read(magic, sizeof(magic)) != sizeof(magic)) return false;
+    if (memcmp(magic, cacheFileMagic, sizeof(magic)) != 0) return false;
+
+    if (!readValue(m_file, &version) || version != cacheFileVersion) return false;
+    if (!readValue(m_file, &byteOrderMark) || byteOrderMark != cacheByteOrderMark) return false;
+    if (!readValue(m_file, &sourceSize) || sourceSize != m_sourceSize) return false;
+    if (!readValue(m_file, &sourceSignature) || sourceSignature != m_sourceSignature) return false;
+    if (!readValue(m_file, &committedSize)) return false;
+
+    if (committedSize < headerSize || committedSize > m_file.size()) return false;
+
+    qint64 recordOffset = headerSize;
+    while (recordOffset < committedSize)
+    {
+        if (!m_file.seek(recordOffset)) return false;
+
+        quint32 keyLength = 0;
+        if (!readValue(m_file, &keyLength)) return false;
+
+        // The key length, key, precision flag and value count must all be within the committed records
+        qint64 recordHeaderSize = sizeof(quint32) + static_cast<qint64>(keyLength) + sizeof(quint32) + sizeof(quint64);
+        if (recordHeaderSize > committedSize - recordOffset) return false;
+
+        QByteArray key = m_file.read(keyLength);
+        if (key.size() != static_cast<int>(keyLength)) return false;
+
+        quint32 singlePrecisionFlag = 0;
+        quint64 valueCount = 0;
+        if (!readValue(m_file, &singlePrecisionFlag)) return false;
+        if (!readValue(m_file, &valueCount)) return false;
+
+        BlockInfo block;
+        block.m_offset = alignedOffset(m_file.pos());
+        block.m_valueCount = valueCount;
+        block.m_isSinglePrecision = singlePrecisionFlag != 0;
+
+        size_t valueSize = block.m_isSinglePrecision ? sizeof(float) : sizeof(double);
+        if (block.m_offset > committedSize) return false;
+        if (valueCount > static_cast<quint64>(committedSize - block.m_offset) / valueSize) return false;
+
+        m_blocks[QString::fromUtf8(key.constData(), key.size())] = block;
+
+        recordOffset = alignedOffset(block.m_offset + static_cast<qint64>(valueCount * valueSize));
+    }
+
+    m_committedSize = committedSize;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+bool RifEclipseResultCacheFile::writeEmptyFile()
+{
+    if (!m_file.seek(0)) return false;
+
+    if (m_file.write(cacheFileMagic, sizeof(cacheFileMagic)) != sizeof(cacheFileMagic)) return false;
+    if (!writeValue(m_file, cacheFileVersion)) return false;
+    if (!writeValue(m_file, cacheByteOrderMark)) return false;
+    if (!writeValue(m_file, m_sourceSize)) return false;
+    if (!writeValue(m_file, m_sourceSignature)) return false;
+
+    if (!padToOffset(m_file, headerSize)) return false;
+
+    return writeCommittedSize(headerSize);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Flush the records written so far, then let the header include them
+//--------------------------------------------------------------------------------------------------
+bool RifEclipseResultCacheFile::writeCommittedSize(qint64 committedSize)
+{
+    if (!m_file.flush()) return false;
+
+    if (!m_file.seek(headerCommittedSizePosition)) return false;
+    if (!writeValue(m_file, committedSize)) return false;
+    if (!m_file.flush()) return false;
+
+    m_committedSize = committedSize;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Make sure the file is at least requiredSize bytes, growing it by whole chunks of zeros.
+/// The mapping is dropped when the file grows, and recreated by the next read
+//--------------------------------------------------------------------------------------------------
+bool RifEclipseResultCacheFile::reserveFileSize(qint64 requiredSize)
+{
+    if (requiredSize <= m_file.size()) return true;
+
+    unmap();
+
+    qint64 newSize = ((requiredSize + fileGrowthChunkSize - 1) / fileGrowthChunkSize) * fileGrowthChunkSize;
+
+    return m_file.resize(newSize);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+const uchar* RifEclipseResultCacheFile::mappedData()
+{
+    if (!m_mappedData && m_file.isOpen())
+    {
+        m_mappedData = m_file.map(0, m_file.size());
+    }
+
+    return m_mappedData;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RifEclipseResultCacheFile::unmap()
+{
+    if (m_mappedData)
+    {
+        m_file.unmap(m_mappedData);
+        m_mappedData = NULL;
+    }
+}
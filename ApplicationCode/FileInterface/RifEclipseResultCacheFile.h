@@ -0,0 +1,89 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "cvfBase.h"
+#include "cvfObject.h"
+
+#include <QString>
+#include <QStringList>
+#include <QFile>
+
+#include <map>
+#include <vector>
+
+//==================================================================================================
+//
+// Binary sidecar file caching result values already extracted from the Eclipse output files.
+// 
+// Layout: A fixed size header identifying the source files, followed by appended records of
+// key, value type, value count and an 8 byte aligned block of float or double values.
+// The header holds the size of the completely written records, so an interrupted append leaves the
+// previous contents readable. Blocks are read through a memory mapping of the file. The file is
+// grown in large chunks, so the mapping is only recreated when a chunk is filled, and is truncated
+// to the committed records when closed. An exclusive lock is held by the instance appending to the
+// file, and a shared lock by instances only reading it.
+//
+//==================================================================================================
+class RifEclipseResultCacheFile : public cvf::Object
+{
+public:
+    RifEclipseResultCacheFile();
+    virtual ~RifEclipseResultCacheFile();
+
+    bool                open(const QString& cacheFileName, const QStringList& sourceFileSet);
+    void                close();
+
+    bool                hasValues(const QString& key) const;
+    bool                values(const QString& key, std::vector<double>* values);
+    const float*        singlePrecisionValues(const QString& key, size_t* valueCount);
+    bool                addValues(const QString& key, const double* values, size_t valueCount);
+
+    static QString      cacheFileName(const QString& caseFileName);
+    static QString      resultKey(const QString& resultName, int porosityModel, size_t timeStepIndex);
+
+private:
+    struct BlockInfo
+    {
+        BlockInfo() : m_offset(0), m_valueCount(0), m_isSinglePrecision(false) {}
+
+        qint64  m_offset;
+        quint64 m_valueCount;
+        bool    m_isSinglePrecision;
+    };
+
+    bool                readHeaderAndIndex();
+    bool                writeEmptyFile();
+    bool                writeCommittedSize(qint64 committedSize);
+    bool                reserveFileSize(qint64 requiredSize);
+
+    const uchar*        mappedData();
+    void                unmap();
+
+private:
+    QFile                               m_file;
+    uchar*                              m_mappedData;
+    bool                                m_isAppendable;     ///< Holds the exclusive lock, and may append records
+
+    qint64                              m_sourceSize;
+    quint64                             m_sourceSignature;  ///< Hash of the name, size and modification time of each source file
+    qint64                              m_committedSize;
+
+    std::map<QString, BlockInfo>        m_blocks;
+};
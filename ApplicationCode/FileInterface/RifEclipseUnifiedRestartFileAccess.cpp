@@ -108,10 +108,7 @@ bool RifEclipseUnifiedRestartFileAccess::results(const QString& resultName, size
     size_t occurrenceIdx;
     for (occurrenceIdx = startIndex; occurrenceIdx < startIndex + gridCount; occurrenceIdx++)
     {
-        std::vector<double> partValues;
-        RifEclipseOutputFileTools::keywordData(m_ecl_file, resultName, occurrenceIdx, &partValues);
-
-        values->insert(values->end(), partValues.begin(), partValues.end());
+        RifEclipseOutputFileTools::keywordData(m_ecl_file, resultName, occurrenceIdx, values);
     }
 
     return true;
@@ -26,6 +26,7 @@
 #include "RifEclipseOutputFileTools.h"
 #include "RifEclipseUnifiedRestartFileAccess.h"
 #include "RifEclipseRestartFilesetAccess.h"
+#include "RifEclipseResultCacheFile.h"
 #include "RifReaderInterface.h"
 
 #include <iostream>
@@ -84,29 +85,37 @@ static const size_t cellMappingECLRi[8] = { 0, 1, 3, 2, 4, 5, 7, 6 };
 // Static functions
 //**************************************************************************************************
 
-bool transferGridCellData(RigMainGrid* mainGrid, RigGridBase* localGrid, const ecl_grid_type* localEclGrid, size_t matrixActiveStartIndex, size_t fractureActiveStartIndex)
+//--------------------------------------------------------------------------------------------------
+/// A range of cells in one of the grids in the file, transferred in one piece
+//--------------------------------------------------------------------------------------------------
+struct GridCellRange
 {
-    int cellCount = ecl_grid_get_global_size(localEclGrid);
-    size_t cellStartIndex = mainGrid->cells().size();
-    size_t nodeStartIndex = mainGrid->nodes().size();
-
-    RigCell defaultCell;
-    defaultCell.setHostGrid(localGrid);
-    mainGrid->cells().resize(cellStartIndex + cellCount, defaultCell);
+    RigGridBase*            grid;
+    const ecl_grid_type*    eclGrid;
+    size_t                  cellStartIndex;         ///< Index of the first cell of the grid in the main grid cell array
+    size_t                  matrixActiveStartIndex;
+    size_t                  fractureActiveStartIndex;
+    int                     firstCell;              ///< Range of cells in the grid: [firstCell, endCell)
+    int                     endCell;
+};
 
-    mainGrid->nodes().resize(nodeStartIndex + cellCount*8, cvf::Vec3d(0,0,0));
-
-    int progTicks = 100;
-    double cellsPrProgressTick = cellCount/(float)progTicks;
-    caf::ProgressInfo progInfo(progTicks, "");
-    size_t computedCellCount = 0;
-    // Loop over cells and fill them with data
+//--------------------------------------------------------------------------------------------------
+/// Fill the cells in the given range of a grid with data. The cells and nodes of the main grid must
+/// already be allocated, making it safe to transfer separate ranges concurrently
+//--------------------------------------------------------------------------------------------------
+void transferGridCellData(RigMainGrid* mainGrid, const GridCellRange& range)
+{
+    RigGridBase* localGrid = range.grid;
+    const ecl_grid_type* localEclGrid = range.eclGrid;
+    size_t cellStartIndex = range.cellStartIndex;
+    size_t nodeStartIndex = 8 * cellStartIndex;
 
-#pragma omp parallel for
-    for (int gIdx = 0; gIdx < cellCount; ++gIdx)
+    for (int gIdx = range.firstCell; gIdx < range.endCell; ++gIdx)
     {
         RigCell& cell = mainGrid->cells()[cellStartIndex + gIdx];
 
+        cell.setHostGrid(localGrid);
+
         bool invalid = ecl_grid_cell_invalid1(localEclGrid, gIdx);
         cell.setInvalid(invalid);
         cell.setCellIndex(gIdx);
@@ -116,7 +125,7 @@ bool transferGridCellData(RigMainGrid* mainGrid, RigGridBase* localGrid, const e
         int matrixActiveIndex = ecl_grid_get_active_index1(localEclGrid, gIdx);
         if (matrixActiveIndex != -1)
         {
-            cell.setActiveIndexInMatrixModel(matrixActiveStartIndex + matrixActiveIndex);
+            cell.setActiveIndexInMatrixModel(range.matrixActiveStartIndex + matrixActiveIndex);
         }
         else
         {
@@ -126,7 +135,7 @@ bool transferGridCellData(RigMainGrid* mainGrid, RigGridBase* localGrid, const e
         int fractureActiveIndex = ecl_grid_get_active_fracture_index1(localEclGrid, gIdx);
         if (fractureActiveIndex != -1)
         {
-            cell.setActiveIndexInFractureModel(fractureActiveStartIndex + fractureActiveIndex);
+            cell.setActiveIndexInFractureModel(range.fractureActiveStartIndex + fractureActiveIndex);
         }
         else
         {
@@ -156,7 +165,7 @@ bool transferGridCellData(RigMainGrid* mainGrid, RigGridBase* localGrid, const e
             double * point = mainGrid->nodes()[nodeStartIndex + gIdx * 8 + cellMappingECLRi[cIdx]].ptr();
             ecl_grid_get_corner_xyz1(localEclGrid, gIdx, cIdx, &(point[0]), &(point[1]), &(point[2]));
             point[2] = -point[2];
-            cell.cornerIndices()[cIdx] = nodeStartIndex + gIdx*8 + cIdx;
+            cell.cornerIndices()[cIdx] = static_cast<cvf::uint>(nodeStartIndex + gIdx*8 + cIdx);
         }
 
         // Sub grid in cell
@@ -173,13 +182,7 @@ bool transferGridCellData(RigMainGrid* mainGrid, RigGridBase* localGrid, const e
         {
             cell.setInvalid(cell.isLongPyramidCell());
         }
-
-#pragma omp atomic
-        computedCellCount++;
-
-        progInfo.setProgress((int)(computedCellCount/cellsPrProgressTick));
     }
-    return true;
 }
 
 //==================================================================================================
@@ -193,6 +196,8 @@ bool transferGridCellData(RigMainGrid* mainGrid, RigGridBase* localGrid, const e
 //--------------------------------------------------------------------------------------------------
 RifReaderEclipseOutput::RifReaderEclipseOutput()
 {
+    m_useResultCacheFile = false;
+
     ground();
 }
 
@@ -222,10 +227,20 @@ void RifReaderEclipseOutput::close()
 {
     m_ecl_file     = NULL;
     m_dynamicResultsAccess    = NULL;
+    m_resultCacheFile = NULL;
 
     ground();
 }
 
+//--------------------------------------------------------------------------------------------------
+/// Enable storing of extracted results in a sidecar file next to the case, used when reopening it.
+/// Must be set before open() to have effect
+//--------------------------------------------------------------------------------------------------
+void RifReaderEclipseOutput::setResultCacheFileEnabled(bool enable)
+{
+    m_useResultCacheFile = enable;
+}
+
 //--------------------------------------------------------------------------------------------------
 /// Read geometry from file given by name into given reservoir object
 //--------------------------------------------------------------------------------------------------
@@ -248,9 +263,25 @@ bool RifReaderEclipseOutput::transferGeometry(const ecl_grid_type* mainEclGrid,
         mainGrid->setGridPointDimensions(gridPointDim);
     }
 
-    // Get and set grid and lgr metadata
+    // Get and set grid and lgr metadata, and find the cells and active cells of each grid 
+    // in the main grid arrays. The main grid comes first, then the LGRs in file order
+
+    std::vector<const ecl_grid_type*> eclGrids;
+    eclGrids.push_back(mainEclGrid);
+
+    std::vector<RigGridBase*> grids;
+    grids.push_back(mainGrid);
+
+    std::vector<size_t> cellStartIndices(1, 0);
+    std::vector<size_t> matrixActiveStartIndices(1, 0);
+    std::vector<size_t> fractureActiveStartIndices(1, 0);
 
     size_t totalCellCount = static_cast<size_t>(ecl_grid_get_global_size(mainEclGrid));
+    size_t globalMatrixActiveSize = ecl_grid_get_nactive(mainEclGrid);
+    size_t globalFractureActiveSize = ecl_grid_get_nactive_fracture(mainEclGrid);
+
+    mainGrid->setMatrixModelActiveCellCount(globalMatrixActiveSize);
+    mainGrid->setFractureModelActiveCellCount(globalFractureActiveSize);
 
     int numLGRs = ecl_grid_get_num_lgr(mainEclGrid);
     int lgrIdx;
@@ -271,48 +302,81 @@ bool RifReaderEclipseOutput::transferGeometry(const ecl_grid_type* mainEclGrid,
         localGrid->setGridName(lgrName);
         localGrid->setGridPointDimensions(gridPointDim);
 
+        eclGrids.push_back(localEclGrid);
+        grids.push_back(localGrid);
+        cellStartIndices.push_back(totalCellCount);
+        matrixActiveStartIndices.push_back(globalMatrixActiveSize);
+        fractureActiveStartIndices.push_back(globalFractureActiveSize);
+
         totalCellCount += ecl_grid_get_global_size(localEclGrid);
-    }
 
-    // Reserve room for the cells and nodes and fill them with data
+        int activeCellCount = ecl_grid_get_nactive(localEclGrid);
+        localGrid->setMatrixModelActiveCellCount(activeCellCount);
+        globalMatrixActiveSize += activeCellCount;
 
-    mainGrid->cells().reserve(totalCellCount);
-    mainGrid->nodes().reserve(8*totalCellCount);
+        activeCellCount = ecl_grid_get_nactive_fracture(localEclGrid);
+        localGrid->setFractureModelActiveCellCount(activeCellCount);
+        globalFractureActiveSize += activeCellCount;
+    }
 
-    caf::ProgressInfo progInfo(3 + numLGRs, "");
-    progInfo.setProgressDescription("Main Grid");
-    progInfo.setNextProgressIncrement(3);
+    // The cells reference their corner nodes by 32 bit indices
+    if (8*totalCellCount >= cvf::UNDEFINED_UINT)
+    {
+        return false;
+    }
 
-    transferGridCellData(mainGrid, mainGrid, mainEclGrid, 0, 0);
+    // Allocate the cells and nodes of all the grids at once
 
-    progInfo.setProgress(3);
+    mainGrid->cells().resize(totalCellCount);
+    mainGrid->nodes().resize(8*totalCellCount, cvf::Vec3d(0,0,0));
 
-    size_t globalMatrixActiveSize = ecl_grid_get_nactive(mainEclGrid);
-    size_t globalFractureActiveSize = ecl_grid_get_nactive_fracture(mainEclGrid);
+    // Split the grids into ranges of cells. Large grids are split in several ranges, 
+    // while each small LGR is one range, so many LGRs are transferred concurrently
 
-    mainGrid->setMatrixModelActiveCellCount(globalMatrixActiveSize);
-    mainGrid->setFractureModelActiveCellCount(globalFractureActiveSize);
+    const int maxCellsInRange = 20000;
 
-    for (lgrIdx = 0; lgrIdx < numLGRs; ++lgrIdx)
+    std::vector<GridCellRange> ranges;
+    size_t gridIdx;
+    for (gridIdx = 0; gridIdx < grids.size(); ++gridIdx)
     {
-        progInfo.setProgressDescription("LGR number " + QString::number(lgrIdx+1));
+        int gridCellCount = ecl_grid_get_global_size(eclGrids[gridIdx]);
+        for (int firstCell = 0; firstCell < gridCellCount; firstCell += maxCellsInRange)
+        {
+            GridCellRange range;
+            range.grid                      = grids[gridIdx];
+            range.eclGrid                   = eclGrids[gridIdx];
+            range.cellStartIndex            = cellStartIndices[gridIdx];
+            range.matrixActiveStartIndex    = matrixActiveStartIndices[gridIdx];
+            range.fractureActiveStartIndex  = fractureActiveStartIndices[gridIdx];
+            range.firstCell                 = firstCell;
+            range.endCell                   = qMin(firstCell + maxCellsInRange, gridCellCount);
+
+            ranges.push_back(range);
+        }
+    }
 
-        ecl_grid_type* localEclGrid = ecl_grid_iget_lgr(mainEclGrid, lgrIdx);
-        RigLocalGrid* localGrid = static_cast<RigLocalGrid*>(mainGrid->gridByIndex(lgrIdx+1));
+    // Transfer the ranges in parallel, a batch at a time. The progress is updated between the batches,
+    // as it can only be done from the main thread
 
-        transferGridCellData(mainGrid, localGrid, localEclGrid, globalMatrixActiveSize, globalFractureActiveSize);
+    const int rangesInBatch = 64;
+    int rangeCount = static_cast<int>(ranges.size());
+    int batchCount = (rangeCount + rangesInBatch - 1) / rangesInBatch;
 
-        int activeCellCount = ecl_grid_get_nactive(localEclGrid);
-        localGrid->setMatrixModelActiveCellCount(activeCellCount);
-        globalMatrixActiveSize += activeCellCount;
+    caf::ProgressInfo progInfo(qMax(1, batchCount), "");
+    progInfo.setProgressDescription(numLGRs > 0 ? QString("Main Grid and %1 LGRs").arg(numLGRs) : QString("Main Grid"));
 
-        activeCellCount = ecl_grid_get_nactive_fracture(localEclGrid);
-        localGrid->setFractureModelActiveCellCount(activeCellCount);
-        globalFractureActiveSize += activeCellCount;
+    for (int batchIdx = 0; batchIdx < batchCount; ++batchIdx)
+    {
+        int batchEnd = qMin((batchIdx + 1) * rangesInBatch, rangeCount);
 
-        progInfo.setProgress(3 + lgrIdx);
-    }
+#pragma omp parallel for schedule(dynamic)
+        for (int rIdx = batchIdx * rangesInBatch; rIdx < batchEnd; ++rIdx)
+        {
+            transferGridCellData(mainGrid, ranges[rIdx]);
+        }
 
+        progInfo.setProgress(batchIdx + 1);
+    }
 
     mainGrid->setGlobalMatrixModelActiveCellCount(globalMatrixActiveSize);
     mainGrid->setGlobalFractureModelActiveCellCount(globalFractureActiveSize);
@@ -328,6 +392,42 @@ bool RifReaderEclipseOutput::open(const QString& fileName, RigReservoir* reservo
     CVF_ASSERT(reservoir);
     caf::ProgressInfo progInfo(100, "");
 
+    progInfo.setNextProgressIncrement(32);
+
+    if (!openGrid(fileName, reservoir)) return false;
+    progInfo.incrementProgress();
+
+    progInfo.setProgressDescription("Reading Result index");
+    progInfo.setNextProgressIncrement(60);
+
+    RigReservoirCellResults* matrixModelResults = reservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+    RigReservoirCellResults* fractureModelResults = reservoir->mainGrid()->results(RifReaderInterface::FRACTURE_RESULTS);
+
+    matrixModelResults->setReaderInterface(this);
+    fractureModelResults->setReaderInterface(this);
+    
+    // Build results meta data
+    if (!readResultMetaData(matrixModelResults, fractureModelResults)) return false;
+    progInfo.incrementProgress();
+
+    progInfo.setNextProgressIncrement(8);
+    progInfo.setProgressDescription("Reading Well information");
+    
+    cvf::Collection<RigWellResults> wells;
+    readWellCells(reservoir, &wells);
+    reservoir->setWellResults(wells);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Find the files of the case and read the grid geometry into the given reservoir object
+//--------------------------------------------------------------------------------------------------
+bool RifReaderEclipseOutput::openGrid(const QString& fileName, RigReservoir* reservoir)
+{
+    CVF_ASSERT(reservoir);
+    caf::ProgressInfo progInfo(32, "");
+
     progInfo.setProgressDescription("Reading Grid");
 
     // Make sure everything's closed
@@ -341,6 +441,7 @@ bool RifReaderEclipseOutput::open(const QString& fileName, RigReservoir* reservo
 
     progInfo.setNextProgressIncrement(20);
     // Keep the set of files of interest
+    m_fileName = fileName;
     m_fileSet = fileSet;
 
     // Read geometry
@@ -351,30 +452,29 @@ bool RifReaderEclipseOutput::open(const QString& fileName, RigReservoir* reservo
     progInfo.setNextProgressIncrement(10);
     progInfo.setProgressDescription("Transferring grid geometry");
 
-    if (!transferGeometry(mainEclGrid, reservoir)) return false;
+    bool isTransferred = transferGeometry(mainEclGrid, reservoir);
     progInfo.incrementProgress();
 
     progInfo.setProgressDescription("Releasing reader memory");
-    ecl_grid_free( mainEclGrid );
+    if (mainEclGrid) ecl_grid_free( mainEclGrid );
     progInfo.incrementProgress();
 
-    progInfo.setProgressDescription("Reading Result index");
-    progInfo.setNextProgressIncrement(60);
+    if (!isTransferred) return false;
 
     m_mainGrid = reservoir->mainGrid();
-    
-    reservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS)->setReaderInterface(this);
-    reservoir->mainGrid()->results(RifReaderInterface::FRACTURE_RESULTS)->setReaderInterface(this);
-    
-    // Build results meta data
-    if (!buildMetaData(reservoir)) return false;
-    progInfo.incrementProgress();
 
-    progInfo.setNextProgressIncrement(8);
-    progInfo.setProgressDescription("Reading Well information");
-    
-    readWellCells(reservoir);
+    return true;
+}
 
+//--------------------------------------------------------------------------------------------------
+/// Add the results found in the files of the case opened by openGrid() to the given result objects.
+/// The result objects must belong to the main grid of the case
+//--------------------------------------------------------------------------------------------------
+bool RifReaderEclipseOutput::readResultMetaData(RigReservoirCellResults* matrixModelResults, RigReservoirCellResults* fractureModelResults)
+{
+    if (!buildMetaData(matrixModelResults, fractureModelResults)) return false;
+
+    if (m_useResultCacheFile) openResultCacheFile();
 
     return true;
 }
@@ -382,9 +482,9 @@ bool RifReaderEclipseOutput::open(const QString& fileName, RigReservoir* reservo
 //--------------------------------------------------------------------------------------------------
 /// Build meta data - get states and results info
 //--------------------------------------------------------------------------------------------------
-bool RifReaderEclipseOutput::buildMetaData(RigReservoir* reservoir)
+bool RifReaderEclipseOutput::buildMetaData(RigReservoirCellResults* matrixModelResults, RigReservoirCellResults* fractureModelResults)
 {
-    CVF_ASSERT(reservoir);
+    CVF_ASSERT(matrixModelResults && fractureModelResults);
     CVF_ASSERT(m_fileSet.size() > 0);
 
     caf::ProgressInfo progInfo(m_fileSet.size() + 3,"");
@@ -400,9 +500,6 @@ bool RifReaderEclipseOutput::buildMetaData(RigReservoir* reservoir)
 
     progInfo.incrementProgress();
 
-    RigReservoirCellResults* matrixModelResults = reservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
-    RigReservoirCellResults* fractureModelResults = reservoir->mainGrid()->results(RifReaderInterface::FRACTURE_RESULTS);
-
     if (m_dynamicResultsAccess.notNull())
     {
         // Get time steps 
@@ -533,19 +630,30 @@ bool RifReaderEclipseOutput::staticResult(const QString& result, PorosityModelRe
     CVF_ASSERT(values);
     CVF_ASSERT(m_ecl_file);
 
+    // Static results are cached with an undefined time step index
+    QString cacheKey = RifEclipseResultCacheFile::resultKey(result, matrixOrFracture, cvf::UNDEFINED_SIZE_T);
+    if (m_resultCacheFile.notNull() && m_resultCacheFile->values(cacheKey, values))
+    {
+        return true;
+    }
+
+    size_t startPosition = values->size();
     std::vector<double> fileValues;
 
     size_t numOccurrences = ecl_file_get_num_named_kw(m_ecl_file, result.toAscii().data());
     size_t i;
     for (i = 0; i < numOccurrences; i++)
     {
-        std::vector<double> partValues;
-        RifEclipseOutputFileTools::keywordData(m_ecl_file, result, i, &partValues);
-        fileValues.insert(fileValues.end(), partValues.begin(), partValues.end());
+        RifEclipseOutputFileTools::keywordData(m_ecl_file, result, i, &fileValues);
     }
 
     extractResultValuesBasedOnPorosityModel(matrixOrFracture, values, fileValues);
 
+    if (m_resultCacheFile.notNull() && values->size() > startPosition)
+    {
+        m_resultCacheFile->addValues(cacheKey, &(*values)[startPosition], values->size() - startPosition);
+    }
+
     return true;
 }
 
@@ -556,6 +664,13 @@ bool RifReaderEclipseOutput::dynamicResult(const QString& result, PorosityModelR
 {
     CVF_ASSERT(m_dynamicResultsAccess.notNull());
 
+    QString cacheKey = RifEclipseResultCacheFile::resultKey(result, matrixOrFracture, stepIndex);
+    if (m_resultCacheFile.notNull() && m_resultCacheFile->values(cacheKey, values))
+    {
+        return true;
+    }
+
+    size_t startPosition = values->size();
     std::vector<double> fileValues;
     if (!m_dynamicResultsAccess->results(result, stepIndex, m_mainGrid->gridCount(), &fileValues))
     {
@@ -564,15 +679,53 @@ bool RifReaderEclipseOutput::dynamicResult(const QString& result, PorosityModelR
 
     extractResultValuesBasedOnPorosityModel(matrixOrFracture, values, fileValues);
 
+    if (m_resultCacheFile.notNull() && values->size() > startPosition)
+    {
+        m_resultCacheFile->addValues(cacheKey, &(*values)[startPosition], values->size() - startPosition);
+    }
+
     return true;
 }
 
 //--------------------------------------------------------------------------------------------------
-///
+/// Get a dynamic result stored in single precision in the result cache file, copied directly from
+/// the file mapping. Returns false if the result is not cached in single precision
+//--------------------------------------------------------------------------------------------------
+bool RifReaderEclipseOutput::singlePrecisionDynamicResult(const QString& result, PorosityModelResultType matrixOrFracture, size_t stepIndex, std::vector<float>* values)
+{
+    CVF_ASSERT(values);
+
+    if (m_resultCacheFile.isNull()) return false;
+
+    size_t valueCount = 0;
+    const float* cachedValues = m_resultCacheFile->singlePrecisionValues(RifEclipseResultCacheFile::resultKey(result, matrixOrFracture, stepIndex), &valueCount);
+    if (!cachedValues) return false;
+
+    values->assign(cachedValues, cachedValues + valueCount);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Open or create the result cache file next to the case. Results are read from the Eclipse files
+/// as usual if the cache can not be used
 //--------------------------------------------------------------------------------------------------
-void RifReaderEclipseOutput::readWellCells(RigReservoir* reservoir)
+void RifReaderEclipseOutput::openResultCacheFile()
+{
+    m_resultCacheFile = new RifEclipseResultCacheFile;
+    if (!m_resultCacheFile->open(RifEclipseResultCacheFile::cacheFileName(m_fileName), m_fileSet))
+    {
+        m_resultCacheFile = NULL;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Read the well cells of all the time steps into the given collection
+//--------------------------------------------------------------------------------------------------
+void RifReaderEclipseOutput::readWellCells(RigReservoir* reservoir, cvf::Collection<RigWellResults>* wells)
 {
     CVF_ASSERT(reservoir);
+    CVF_ASSERT(wells);
 
     if (m_dynamicResultsAccess.isNull()) return;
 
@@ -585,7 +738,7 @@ void RifReaderEclipseOutput::readWellCells(RigReservoir* reservoir)
     std::vector<RigGridBase*> grids;
     reservoir->allGrids(&grids);
 
-    cvf::Collection<RigWellResults> wells;
+    wells->clear();
     caf::ProgressInfo progress(well_info_get_num_wells(ert_well_info), "");
 
     int wellIdx;
@@ -736,14 +889,12 @@ void RifReaderEclipseOutput::readWellCells(RigReservoir* reservoir)
 
         wellResults->computeMappingFromResultTimeIndicesToWellTimeIndices(m_timeSteps);
 
-        wells.push_back(wellResults.p());
+        wells->push_back(wellResults.p());
 
         progress.incrementProgress();
     }
 
     well_info_free(ert_well_info);
-
-    reservoir->setWellResults(wells);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -19,13 +19,17 @@
 #pragma once
 
 #include "RifReaderInterface.h"
+#include "cvfCollection.h"
 #include <QList>
 #include <QDateTime>
 
 class RifEclipseOutputFileTools;
 class RifEclipseRestartDataAccess;
+class RifEclipseResultCacheFile;
 class RigGridBase;
 class RigMainGrid;
+class RigReservoirCellResults;
+class RigWellResults;
 
 typedef struct ecl_grid_struct ecl_grid_type;
 typedef struct ecl_file_struct ecl_file_type;
@@ -45,15 +49,23 @@ public:
     bool                    open(const QString& fileName, RigReservoir* reservoir);
     void                    close();
 
+    // The stages of open(), usable separately to load a case in the background
+    bool                    openGrid(const QString& fileName, RigReservoir* reservoir);
+    bool                    readResultMetaData(RigReservoirCellResults* matrixModelResults, RigReservoirCellResults* fractureModelResults);
+    void                    readWellCells(RigReservoir* reservoir, cvf::Collection<RigWellResults>* wells);
+
+    void                    setResultCacheFileEnabled(bool enable);
+
     bool                    staticResult(const QString& result, PorosityModelResultType matrixOrFracture, std::vector<double>* values);
     bool                    dynamicResult(const QString& result, PorosityModelResultType matrixOrFracture, size_t stepIndex, std::vector<double>* values);
+    bool                    singlePrecisionDynamicResult(const QString& result, PorosityModelResultType matrixOrFracture, size_t stepIndex, std::vector<float>* values);
 
     static bool             transferGeometry(const ecl_grid_type* mainEclGrid, RigReservoir* reservoir);
 
 private:
     void                    ground();
-    bool                    buildMetaData(RigReservoir* reservoir);
-    void                    readWellCells(RigReservoir* reservoir);
+    bool                    buildMetaData(RigReservoirCellResults* matrixModelResults, RigReservoirCellResults* fractureModelResults);
+    void                    openResultCacheFile();
 
     void                    extractResultValuesBasedOnPorosityModel(PorosityModelResultType matrixOrFracture, std::vector<double>* values, const std::vector<double>& fileValues);
     
@@ -74,4 +86,7 @@ private:
 
     ecl_file_type*                          m_ecl_file;    // File access to static results
     cvf::ref<RifEclipseRestartDataAccess>   m_dynamicResultsAccess;   // File access to dynamic results
+
+    bool                                    m_useResultCacheFile;
+    cvf::ref<RifEclipseResultCacheFile>     m_resultCacheFile;        // Sidecar file with previously extracted results
 };
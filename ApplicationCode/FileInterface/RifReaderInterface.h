@@ -51,5 +51,8 @@ public:
    
     virtual bool                staticResult(const QString& result, PorosityModelResultType matrixOrFracture, std::vector<double>* values) = 0;
     virtual bool                dynamicResult(const QString& result, PorosityModelResultType matrixOrFracture, size_t stepIndex, std::vector<double>* values) = 0;
+
+    // Readers holding results in single precision can return them without a round trip through double
+    virtual bool                singlePrecisionDynamicResult(const QString& result, PorosityModelResultType matrixOrFracture, size_t stepIndex, std::vector<float>* values) { return false; }
 };
 
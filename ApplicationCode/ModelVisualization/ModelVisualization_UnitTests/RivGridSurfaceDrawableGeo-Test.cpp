@@ -0,0 +1,144 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#include "gtest/gtest.h"
+
+#include "cvfLibCore.h"
+#include "cvfLibRender.h"
+#include "cvfLibGeometry.h"
+
+#include "RivGridSurfaceDrawableGeo.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/// Horizontal layers of unit quads, stacked at z = 0, 1, 2 ...
+//--------------------------------------------------------------------------------------------------
+cvf::ref<cvf::Vec3fArray> buildQuadLayers(int quadCountX, int quadCountY, int layerCount)
+{
+    cvf::ref<cvf::Vec3fArray> vertices = new cvf::Vec3fArray;
+    vertices->reserve(quadCountX*quadCountY*layerCount*4);
+
+    for (int z = 0; z < layerCount; z++)
+    {
+        for (int y = 0; y < quadCountY; y++)
+        {
+            for (int x = 0; x < quadCountX; x++)
+            {
+                vertices->add(cvf::Vec3f(x, y, z));
+                vertices->add(cvf::Vec3f(x + 1, y, z));
+                vertices->add(cvf::Vec3f(x + 1, y + 1, z));
+                vertices->add(cvf::Vec3f(x, y + 1, z));
+            }
+        }
+    }
+
+    return vertices;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RivGridSurfaceDrawableGeoTest, SameHitsAsDrawableGeo)
+{
+    cvf::ref<cvf::Vec3fArray> vertices = buildQuadLayers(20, 10, 3);
+
+    cvf::ref<cvf::DrawableGeo> referenceGeo = new cvf::DrawableGeo;
+    referenceGeo->setFromQuadVertexArray(vertices.p());
+
+    cvf::ref<cvf::DrawableGeo> geo = new RivGridSurfaceDrawableGeo;
+    geo->setFromQuadVertexArray(vertices.p());
+
+    const cvf::Vec3d origins[] = { cvf::Vec3d(3.25, 4.75, 10), cvf::Vec3d(19.9, 0.1, 10), cvf::Vec3d(-5, 5.5, 1.5), cvf::Vec3d(25, 5, 10) };
+    const cvf::Vec3d directions[] = { cvf::Vec3d(0, 0, -1), cvf::Vec3d(0, 0, -1), cvf::Vec3d(1, 0, -0.2), cvf::Vec3d(0, 0, -1) };
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        cvf::Ray ray;
+        ray.setOrigin(origins[i]);
+        ray.setDirection(directions[i].getNormalized());
+
+        cvf::Vec3d referencePoint;
+        cvf::ref<cvf::HitDetail> referenceDetail;
+        bool referenceHit = referenceGeo->rayIntersectCreateDetail(ray, &referencePoint, &referenceDetail);
+
+        cvf::Vec3d point;
+        cvf::ref<cvf::HitDetail> detail;
+        bool hit = geo->rayIntersectCreateDetail(ray, &point, &detail);
+
+        ASSERT_EQ(referenceHit, hit);
+        if (!hit) continue;
+
+        EXPECT_TRUE((referencePoint - point).length() < 1.0e-9);
+
+        const cvf::HitDetailDrawableGeo* referenceGeoDetail = dynamic_cast<const cvf::HitDetailDrawableGeo*>(referenceDetail.p());
+        const cvf::HitDetailDrawableGeo* geoDetail = dynamic_cast<const cvf::HitDetailDrawableGeo*>(detail.p());
+        ASSERT_TRUE(referenceGeoDetail && geoDetail);
+        EXPECT_EQ(referenceGeoDetail->faceIndex(), geoDetail->faceIndex());
+    }
+
+    // The top layer is hit first from above
+    cvf::Ray ray;
+    ray.setOrigin(cvf::Vec3d(3.25, 4.75, 10));
+    ray.setDirection(cvf::Vec3d(0, 0, -1));
+
+    cvf::Vec3d point;
+    ASSERT_TRUE(geo->rayIntersectCreateDetail(ray, &point, NULL));
+    EXPECT_DOUBLE_EQ(2.0, point.z());
+}
+
+//--------------------------------------------------------------------------------------------------
+/// A quad folded across its diagonal, so that a vertical ray passes through both its triangles
+//--------------------------------------------------------------------------------------------------
+TEST(RivGridSurfaceDrawableGeoTest, NonPlanarQuadNearestHit)
+{
+    cvf::ref<cvf::Vec3fArray> vertices = new cvf::Vec3fArray;
+    vertices->reserve(4);
+    vertices->add(cvf::Vec3f(0, 0, 0));
+    vertices->add(cvf::Vec3f(2, 0, 0));
+    vertices->add(cvf::Vec3f(2, 2, 0));
+    vertices->add(cvf::Vec3f(1.8f, 0.2f, 1));
+
+    cvf::ref<cvf::DrawableGeo> geo = new RivGridSurfaceDrawableGeo;
+    geo->setFromQuadVertexArray(vertices.p());
+
+    // From above, the raised triangle (0, 2, 3) is hit first
+    cvf::Ray ray;
+    ray.setOrigin(cvf::Vec3d(1.5, 0.8, 10));
+    ray.setDirection(cvf::Vec3d(0, 0, -1));
+
+    cvf::Vec3d point;
+    cvf::ref<cvf::HitDetail> detail;
+    ASSERT_TRUE(geo->rayIntersectCreateDetail(ray, &point, &detail));
+    EXPECT_NEAR(0.4375, point.z(), 1.0e-6);
+
+    const cvf::HitDetailDrawableGeo* geoDetail = dynamic_cast<const cvf::HitDetailDrawableGeo*>(detail.p());
+    ASSERT_TRUE(geoDetail != NULL);
+    EXPECT_EQ(1u, geoDetail->faceIndex());
+
+    // From below, the flat triangle (0, 1, 2) is hit first
+    ray.setOrigin(cvf::Vec3d(1.5, 0.8, -10));
+    ray.setDirection(cvf::Vec3d(0, 0, 1));
+
+    ASSERT_TRUE(geo->rayIntersectCreateDetail(ray, &point, &detail));
+    EXPECT_NEAR(0.0, point.z(), 1.0e-6);
+
+    geoDetail = dynamic_cast<const cvf::HitDetailDrawableGeo*>(detail.p());
+    ASSERT_TRUE(geoDetail != NULL);
+    EXPECT_EQ(0u, geoDetail->faceIndex());
+}
@@ -102,7 +102,15 @@ void RivCellEdgeGeometryGenerator::addCellEdgeResultsToDrawableGeo(
         }
 
         RifReaderInterface::PorosityModelResultType porosityModel = RigReservoirCellResults::convertFromProjectModelPorosityModel(cellResultSlot->porosityModel());
-        cellScalarResultUseGlobalActiveIndex = grid->mainGrid()->results(porosityModel)->isUsingGlobalActiveIndex(cellResultSlot->gridScalarIndex());
+        RigReservoirCellResults* cellResults = grid->mainGrid()->results(porosityModel);
+
+        // Load the time step up front, as the values are accessed from several threads below
+        if (timeStepIndex < cellResults->timeStepCount(cellResultSlot->gridScalarIndex()))
+        {
+            cellResults->loadTimeStep(cellResultSlot->gridScalarIndex(), timeStepIndex);
+        }
+
+        cellScalarResultUseGlobalActiveIndex = cellResults->isUsingGlobalActiveIndex(cellResultSlot->gridScalarIndex());
     }
 
     size_t resultIndices[6];
@@ -115,7 +123,15 @@ void RivCellEdgeGeometryGenerator::addCellEdgeResultsToDrawableGeo(
         {
             if (resultIndices[cubeFaceIdx] != cvf::UNDEFINED_SIZE_T)
             {
-                edgeScalarResultUseGlobalActiveIndex[cubeFaceIdx] = grid->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS)->isUsingGlobalActiveIndex(resultIndices[cubeFaceIdx]);
+                RigReservoirCellResults* edgeResults = grid->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+
+                // Time step zero is used for the edges, and must be loaded before the threads access it
+                if (edgeResults->timeStepCount(resultIndices[cubeFaceIdx]) > 0)
+                {
+                    edgeResults->loadTimeStep(resultIndices[cubeFaceIdx], 0);
+                }
+
+                edgeScalarResultUseGlobalActiveIndex[cubeFaceIdx] = edgeResults->isUsingGlobalActiveIndex(resultIndices[cubeFaceIdx]);
             }
         }
     }
@@ -0,0 +1,296 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#include "RIStdInclude.h"
+
+#include "RivCellResultTexture.h"
+
+#include "cvfBase.h"
+#include "cvfAssert.h"
+#include "cvfStructGridGeometryGenerator.h"
+#include "cvfStructGridScalarDataAccess.h"
+#include "cvfScalarMapper.h"
+#include "cvfTexture.h"
+#include "cvfTextureImage.h"
+#include "cvfSampler.h"
+#include "cvfUniform.h"
+#include "cvfShaderProgram.h"
+#include "cvfShaderProgramGenerator.h"
+#include "cvfShaderSourceProvider.h"
+#include "cvfRenderStatePolygonOffset.h"
+#include "cvfRenderStateBlending.h"
+#include "cvfRenderStateCullFace.h"
+#include "cvfRenderStateTextureBindings.h"
+#include "cvfqtUtils.h"
+
+#include <QFile>
+#include <QTextStream>
+
+#include "RIApplication.h"
+#include "RIPreferences.h"
+
+#include <cmath>
+
+// The cell colors are stored row by row. A texture size of 2048 x 2048 is supported by any 
+// hardware running the shaders
+static const cvf::uint CELL_TEXTURE_WIDTH       = 2048;
+static const cvf::uint CELL_TEXTURE_MAX_HEIGHT  = 2048;
+
+
+//--------------------------------------------------------------------------------------------------
+/// Assign a texel to each of the cells that has faces in the geometry. The quads of a cell are 
+/// consecutive, so the texels get the order of the cells in the geometry
+//--------------------------------------------------------------------------------------------------
+RivCellResultTexture::RivCellResultTexture(const cvf::StructGridGeometryGenerator* generator)
+{
+    CVF_ASSERT(generator);
+
+    const std::vector<size_t>& quadToCell = generator->quadToGridCellIndices();
+    size_t quadCount = quadToCell.size();
+
+    cvf::ref<cvf::FloatArray> cellIndices = new cvf::FloatArray;
+    cellIndices->resize(quadCount*4);
+
+    size_t quadIdx;
+    for (quadIdx = 0; quadIdx < quadCount; quadIdx++)
+    {
+        if (m_cells.empty() || m_cells.back() != quadToCell[quadIdx])
+        {
+            m_cells.push_back(quadToCell[quadIdx]);
+        }
+
+        // Texel indices below 2^24 are exact as float
+        float texelIndex = static_cast<float>(m_cells.size() - 1);
+
+        cellIndices->set(quadIdx*4 + 0, texelIndex);
+        cellIndices->set(quadIdx*4 + 1, texelIndex);
+        cellIndices->set(quadIdx*4 + 2, texelIndex);
+        cellIndices->set(quadIdx*4 + 3, texelIndex);
+    }
+
+    if (m_cells.empty()) return;
+
+    cvf::uint width = static_cast<cvf::uint>(CVF_MIN(m_cells.size(), static_cast<size_t>(CELL_TEXTURE_WIDTH)));
+    cvf::uint height = static_cast<cvf::uint>((m_cells.size() + width - 1) / width);
+    if (height > CELL_TEXTURE_MAX_HEIGHT) return;
+
+    m_cellIndexAttribute = new cvf::FloatVertexAttribute("a_cellIndex", cellIndices.p());
+
+    m_image = new cvf::TextureImage;
+    m_image->allocate(width, height);
+
+    m_texture = new cvf::Texture(m_image.p());
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Returns false if the geometry is empty, or has more cells than the texture can hold
+//--------------------------------------------------------------------------------------------------
+bool RivCellResultTexture::isValid() const
+{
+    return m_texture.notNull();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+cvf::VertexAttribute* RivCellResultTexture::cellIndexAttribute()
+{
+    return m_cellIndexAttribute.p();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+cvf::Texture* RivCellResultTexture::texture()
+{
+    return m_texture.p();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Set the texel of each cell to the color the scalar mapper texture would give the cell. 
+/// The texture is uploaded again the next time it is rendered
+//--------------------------------------------------------------------------------------------------
+void RivCellResultTexture::updateColors(const cvf::StructGridScalarDataAccess* dataAccessObject, const cvf::ScalarMapper* mapper, 
+                                        float opacityLevel, const cvf::Color3f& undefinedColor)
+{
+    CVF_ASSERT(isValid());
+    CVF_ASSERT(dataAccessObject && mapper);
+
+    cvf::ref<cvf::TextureImage> legendImage = new cvf::TextureImage;
+    mapper->updateTexture(legendImage.p());
+    
+    int legendWidth = static_cast<int>(legendImage->width());
+    CVF_ASSERT(legendWidth > 0);
+
+    const cvf::Color4ub undefinedTexel(cvf::Color3ub(undefinedColor), 255);
+    const cvf::ubyte alpha = static_cast<cvf::ubyte>(opacityLevel * 255);
+    const cvf::uint width = m_image->width();
+
+#pragma omp parallel for
+    for (int texelIdx = 0; texelIdx < static_cast<int>(m_cells.size()); texelIdx++)
+    {
+        cvf::Color4ub texel = undefinedTexel;
+
+        double cellScalarValue = dataAccessObject->cellScalar(m_cells[texelIdx]);
+        if (cellScalarValue != HUGE_VAL && cellScalarValue == cellScalarValue) // a != a is true for NAN's
+        {
+            // Pick the legend texel like a nearest filtered lookup clamped to the edge
+            float textureCoord = mapper->mapToTextureCoord(cellScalarValue).x();
+            int legendTexelIdx = static_cast<int>(std::floor(textureCoord * legendWidth));
+            legendTexelIdx = cvf::Math::clamp(legendTexelIdx, 0, legendWidth - 1);
+
+            texel = legendImage->pixel(static_cast<cvf::uint>(legendTexelIdx), 0);
+            texel.a() = alpha;
+        }
+
+        m_image->setPixel(texelIdx % width, texelIdx / width, texel);
+    }
+
+    m_texture->setFromImage(m_image.p());
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Result textures need shaders, and are used when enabled in the preferences
+//--------------------------------------------------------------------------------------------------
+bool RivCellResultTexture::isEnabled()
+{
+    if (caf::EffectGenerator::renderingMode() != caf::EffectGenerator::SHADER_BASED) return false;
+
+    return RIApplication::instance()->preferences()->useCellResultTextures;
+}
+
+
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+CellResultTextureEffectGenerator::CellResultTextureEffectGenerator(cvf::Texture* cellColorTexture)
+{
+    CVF_ASSERT(cellColorTexture != NULL);
+
+    m_cellColorTexture = cellColorTexture;
+    m_opacityLevel = 1.0f;
+    m_cullBackfaces = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The texture content changes with the time step, but the effect using it stays the same
+//--------------------------------------------------------------------------------------------------
+bool CellResultTextureEffectGenerator::isEqual(const EffectGenerator* other) const
+{
+    const CellResultTextureEffectGenerator* otherTextureEffect = dynamic_cast<const CellResultTextureEffectGenerator*>(other);
+
+    if (otherTextureEffect
+        && m_cellColorTexture.p() == otherTextureEffect->m_cellColorTexture.p()
+        && m_opacityLevel         == otherTextureEffect->m_opacityLevel
+        && m_cullBackfaces        == otherTextureEffect->m_cullBackfaces)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+caf::EffectGenerator* CellResultTextureEffectGenerator::copy() const
+{
+    CellResultTextureEffectGenerator* newEffect = new CellResultTextureEffectGenerator(m_cellColorTexture.p());
+    newEffect->setOpacityLevel(m_opacityLevel);
+    newEffect->setCullBackfaces(m_cullBackfaces);
+
+    return newEffect;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void CellResultTextureEffectGenerator::updateForShaderBasedRendering(cvf::Effect* effect) const
+{
+    cvf::ref<cvf::Effect> eff = effect;
+
+    // Set up shader program
+
+    cvf::ShaderProgramGenerator shaderGen("CellResultTextureShaderProgramGenerator", cvf::ShaderSourceProvider::instance());
+    {
+        QFile data(":/Shader/vs_CellResult.glsl");
+        if (data.open(QFile::ReadOnly))
+        {
+            QTextStream in(&data);
+
+            QString data = in.readAll();
+            cvf::String cvfString = cvfqt::Utils::fromQString(data);
+
+            shaderGen.addVertexCode(cvfString);
+        }
+    }
+
+    shaderGen.addFragmentCode(cvf::ShaderSourceRepository::src_Texture);
+    shaderGen.addFragmentCode(caf::CommonShaderSources::light_AmbientDiffuse());
+    shaderGen.addFragmentCode(cvf::ShaderSourceRepository::fs_Standard);
+
+    cvf::ref<cvf::ShaderProgram> prog = shaderGen.generate();
+    eff->setShaderProgram(prog.p());
+
+    eff->setUniform(new cvf::UniformFloat("u_cellTextureSize", cvf::Vec2f(static_cast<float>(m_cellColorTexture->width()), static_cast<float>(m_cellColorTexture->height()))));
+
+    // Set up texture
+
+    cvf::ref<cvf::Sampler> sampler = new cvf::Sampler;
+    sampler->setWrapMode(cvf::Sampler::CLAMP_TO_EDGE);
+    sampler->setMinFilter(cvf::Sampler::NEAREST);
+    sampler->setMagFilter(cvf::Sampler::NEAREST);
+
+    cvf::ref<cvf::RenderStateTextureBindings> texBind = new cvf::RenderStateTextureBindings;
+    texBind->addBinding(m_cellColorTexture.p(), sampler.p(), "u_texture2D");
+    eff->setRenderState(texBind.p());
+
+    // Polygon offset
+
+    cvf::ref<cvf::RenderStatePolygonOffset> polyOffset = new cvf::RenderStatePolygonOffset;
+    polyOffset->configurePolygonPositiveOffset();
+    eff->setRenderState(polyOffset.p());
+
+    // Simple transparency
+    if (m_opacityLevel < 1.0f)
+    {
+        cvf::ref<cvf::RenderStateBlending> blender = new cvf::RenderStateBlending;
+        blender->configureTransparencyBlending();
+        eff->setRenderState(blender.p());
+    }
+
+    // Backface culling
+
+    if (m_cullBackfaces)
+    {
+        cvf::ref<cvf::RenderStateCullFace> faceCulling = new cvf::RenderStateCullFace;
+        eff->setRenderState(faceCulling.p());
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Result textures are only used with shader based rendering
+//--------------------------------------------------------------------------------------------------
+void CellResultTextureEffectGenerator::updateForFixedFunctionRendering(cvf::Effect* effect) const
+{
+    caf::SurfaceEffectGenerator surfaceGen(cvf::Color4f(cvf::Color3f::WHITE, m_opacityLevel), true);
+
+    surfaceGen.updateEffect(effect);
+}
@@ -0,0 +1,92 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "cafEffectGenerator.h"
+
+#include "cvfObject.h"
+#include "cvfVertexAttribute.h"
+
+#include <vector>
+
+namespace cvf
+{
+    class StructGridGeometryGenerator;
+    class StructGridScalarDataAccess;
+    class ScalarMapper;
+    class Texture;
+    class TextureImage;
+}
+
+
+//==================================================================================================
+///
+/// Result colors of the cells in a grid geometry, stored as one texel per cell. The vertices of each
+/// quad have the texel index of their cell as a static vertex attribute, so a time step change only 
+/// needs to update the texture
+///
+//==================================================================================================
+class RivCellResultTexture : public cvf::Object
+{
+public:
+    explicit RivCellResultTexture(const cvf::StructGridGeometryGenerator* generator);
+
+    bool                        isValid() const;
+    cvf::VertexAttribute*       cellIndexAttribute();
+    cvf::Texture*               texture();
+
+    void                        updateColors(const cvf::StructGridScalarDataAccess* dataAccessObject, const cvf::ScalarMapper* mapper, 
+                                             float opacityLevel, const cvf::Color3f& undefinedColor);
+
+    static bool                 isEnabled();
+
+private:
+    std::vector<size_t>                 m_cells;                ///< The grid cells with faces in the geometry, in texel order
+    cvf::ref<cvf::FloatVertexAttribute> m_cellIndexAttribute;   ///< Texel index of the cell per vertex
+    cvf::ref<cvf::TextureImage>         m_image;
+    cvf::ref<cvf::Texture>              m_texture;
+};
+
+
+//==================================================================================================
+//
+// Cell Result Texture Effect
+//
+//==================================================================================================
+class CellResultTextureEffectGenerator : public caf::EffectGenerator
+{
+public:
+    CellResultTextureEffectGenerator(cvf::Texture* cellColorTexture);
+
+    void                            setOpacityLevel(float opacity)          { m_opacityLevel = cvf::Math::clamp(opacity, 0.0f , 1.0f ); }
+    void                            setCullBackfaces(bool cullBackFaces)    { m_cullBackfaces = cullBackFaces; }
+
+protected:
+    virtual bool                    isEqual( const EffectGenerator* other ) const;
+    virtual EffectGenerator*        copy() const;
+
+    virtual void                    updateForShaderBasedRendering(cvf::Effect* effect) const;
+    virtual void                    updateForFixedFunctionRendering(cvf::Effect* effect) const;
+
+private:
+    mutable cvf::ref<cvf::Texture>  m_cellColorTexture;
+    float                           m_opacityLevel;
+    bool                            m_cullBackfaces;
+};
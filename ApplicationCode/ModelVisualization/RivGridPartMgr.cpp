@@ -24,6 +24,8 @@
 #include "cvfDrawableGeo.h"
 #include "cvfModelBasicList.h"
 #include "RivCellEdgeEffectGenerator.h"
+#include "RivCellResultTexture.h"
+#include "RivGridSurfaceDrawableGeo.h"
 #include "RimReservoirView.h"
 #include "RimResultSlot.h"
 #include "RimCellEdgeResultSlot.h"
@@ -48,6 +50,14 @@ RivGridPartMgr::RivGridPartMgr(const RigGridBase* grid, size_t gridIdx)
     m_cellVisibility = new cvf::UByteArray;
     m_surfaceFacesTextureCoords = new cvf::Vec2fArray;
     m_faultFacesTextureCoords = new cvf::Vec2fArray;
+
+    m_surfaceFaceFilter.m_showExternalFaces = true;
+    m_surfaceFaceFilter.m_showFaultFaces = false;
+    m_surfaceGenerator.addFaceVisibilityFilter(&m_surfaceFaceFilter);
+
+    m_faultFaceFilter.m_showExternalFaces = false;
+    m_faultFaceFilter.m_showFaultFaces = true;
+    m_faultGenerator.addFaceVisibilityFilter(&m_faultFaceFilter);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -59,24 +69,33 @@ void RivGridPartMgr::setTransform(cvf::Transform* scaleTransform)
 }
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Generate the parts showing the visible cells. The parts are kept if no cell changed visibility,
+/// and otherwise only the K slabs around the changed cells are regenerated. 
+/// Use a new array for each call, as the changes are found by comparing with the previous array
 //--------------------------------------------------------------------------------------------------
 void RivGridPartMgr::setCellVisibility(cvf::UByteArray* cellVisibilities)
 {
     CVF_ASSERT(m_scaleTransform.notNull());
     CVF_ASSERT(cellVisibilities);
+    CVF_ASSERT(cellVisibilities != m_cellVisibility.p());
+
+    bool isUnchanged = cellVisibilities->size() > 0
+                       && cellVisibilities->size() == m_cellVisibility->size()
+                       && memcmp(cellVisibilities->ptr(), m_cellVisibility->ptr(), cellVisibilities->size()*sizeof(cvf::ubyte)) == 0;
 
     m_cellVisibility = cellVisibilities;
 
-    m_surfaceGenerator.setCellVisibility(cellVisibilities);
-    m_surfaceFaceFilter.m_showExternalFaces = true;
-    m_surfaceFaceFilter.m_showFaultFaces = false;
-    m_surfaceGenerator.addFaceVisibilityFilter(&m_surfaceFaceFilter);
+    if (isUnchanged) return;
 
+    m_surfaceGenerator.setCellVisibility(cellVisibilities);
     m_faultGenerator.setCellVisibility(cellVisibilities);
-    m_faultFaceFilter.m_showExternalFaces = false;
-    m_faultFaceFilter.m_showFaultFaces = true;
-    m_faultGenerator.addFaceVisibilityFilter(&m_faultFaceFilter);
+
+    m_surfaceFaces = NULL;
+    m_surfaceGridLines = NULL;
+    m_surfaceResultTexture = NULL;
+    m_faultFaces = NULL;
+    m_faultGridLines = NULL;
+    m_faultResultTexture = NULL;
 
     generatePartGeometry(m_surfaceGenerator, false);
     generatePartGeometry(m_faultGenerator, true);
@@ -87,8 +106,9 @@ void RivGridPartMgr::generatePartGeometry(cvf::StructGridGeometryGenerator& geoB
     bool useBufferObjects = true;
     // Surface geometry
     {
-        cvf::ref<cvf::DrawableGeo> geo = geoBuilder.generateSurface();
-        if (geo.notNull())
+        // Use a drawable with accelerated ray intersection, as picking would otherwise test every triangle
+        cvf::ref<cvf::DrawableGeo> geo = new RivGridSurfaceDrawableGeo;
+        if (geoBuilder.generateSurface(geo.p()))
         {
             geo->computeNormals();
 
@@ -106,6 +126,22 @@ void RivGridPartMgr::generatePartGeometry(cvf::StructGridGeometryGenerator& geoB
             // Set mapping from triangle face index to cell index
             part->setSourceInfo(geoBuilder.triangleToSourceGridCellMap().p());
 
+            // Let the shader find the result color of each cell from a per cell texture, instead of 
+            // setting texture coordinates for all the vertices on each time step change
+            cvf::ref<RivCellResultTexture> resultTexture;
+            if (RivCellResultTexture::isEnabled())
+            {
+                resultTexture = new RivCellResultTexture(&geoBuilder);
+                if (resultTexture->isValid())
+                {
+                    geo->setVertexAttribute(resultTexture->cellIndexAttribute());
+                }
+                else
+                {
+                    resultTexture = NULL;
+                }
+            }
+
             part->updateBoundingBox();
             
             // Set default effect
@@ -117,11 +153,13 @@ void RivGridPartMgr::generatePartGeometry(cvf::StructGridGeometryGenerator& geoB
             {
                 part->setEnableMask(faultBit);
                 m_faultFaces = part;
+                m_faultResultTexture = resultTexture;
             }
             else
             {
                 part->setEnableMask(surfaceBit);
                 m_surfaceFaces = part;
+                m_surfaceResultTexture = resultTexture;
             }
         }
     }
@@ -225,7 +263,18 @@ void RivGridPartMgr::updateCellResultColor(size_t timeStepIndex, RimResultSlot*
     if (dataAccessObject.isNull()) return;
 
     // Outer surface
-    if (m_surfaceFaces.notNull())
+    if (m_surfaceFaces.notNull() && m_surfaceResultTexture.notNull())
+    {
+        m_surfaceResultTexture->updateColors(dataAccessObject.p(), mapper, m_opacityLevel, cvf::Color3::GRAY);
+
+        CellResultTextureEffectGenerator textureEffgen(m_surfaceResultTexture->texture());
+        textureEffgen.setOpacityLevel(m_opacityLevel);
+
+        cvf::ref<cvf::Effect> textureEffect = textureEffgen.generateEffect();
+
+        m_surfaceFaces->setEffect(textureEffect.p());
+    }
+    else if (m_surfaceFaces.notNull())
     {
         m_surfaceGenerator.textureCoordinates(m_surfaceFacesTextureCoords.p(), dataAccessObject.p(), mapper);
 
@@ -251,7 +300,18 @@ void RivGridPartMgr::updateCellResultColor(size_t timeStepIndex, RimResultSlot*
     }
 
     // Faults
-    if (m_faultFaces.notNull())
+    if (m_faultFaces.notNull() && m_faultResultTexture.notNull())
+    {
+        m_faultResultTexture->updateColors(dataAccessObject.p(), mapper, m_opacityLevel, cvf::Color3::GRAY);
+
+        CellResultTextureEffectGenerator textureEffgen(m_faultResultTexture->texture());
+        textureEffgen.setOpacityLevel(m_opacityLevel);
+
+        cvf::ref<cvf::Effect> textureEffect = textureEffgen.generateEffect();
+
+        m_faultFaces->setEffect(textureEffect.p());
+    }
+    else if (m_faultFaces.notNull())
     {
         m_faultGenerator.textureCoordinates(m_faultFacesTextureCoords.p(), dataAccessObject.p(), mapper);
 
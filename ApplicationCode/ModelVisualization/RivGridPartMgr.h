@@ -31,6 +31,7 @@ namespace cvf
 
 class RimResultSlot;
 class RimCellEdgeResultSlot;
+class RivCellResultTexture;
 
 //==================================================================================================
 ///
@@ -80,6 +81,7 @@ private:
     RigGridCellFaceVisibilityFilter             m_surfaceFaceFilter;
     cvf::ref<cvf::Part>                         m_surfaceFaces;
     cvf::ref<cvf::Vec2fArray>                   m_surfaceFacesTextureCoords;
+    cvf::ref<RivCellResultTexture>              m_surfaceResultTexture;
 
     cvf::ref<cvf::Part>                         m_surfaceGridLines;
 
@@ -88,6 +90,7 @@ private:
     RigGridCellFaceVisibilityFilter             m_faultFaceFilter;
     cvf::ref<cvf::Part>                         m_faultFaces;
     cvf::ref<cvf::Vec2fArray>                   m_faultFacesTextureCoords;
+    cvf::ref<RivCellResultTexture>              m_faultResultTexture;
 
     cvf::ref<cvf::Part>                         m_faultGridLines;
 
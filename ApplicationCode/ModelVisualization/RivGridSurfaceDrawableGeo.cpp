@@ -0,0 +1,133 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#include "cvfLibCore.h"
+#include "cvfLibRender.h"
+#include "cvfLibGeometry.h"
+#include "RivGridSurfaceDrawableGeo.h"
+#include "RigBoundingBoxTree.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RivGridSurfaceDrawableGeo::RivGridSurfaceDrawableGeo()
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RivGridSurfaceDrawableGeo::~RivGridSurfaceDrawableGeo()
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Find the closest triangle hit by the ray. Quad n is split into the triangles 2n (vertices 0, 1, 2)
+/// and 2n + 1 (vertices 0, 2, 3) as done by setFromQuadVertexArray()
+//--------------------------------------------------------------------------------------------------
+bool RivGridSurfaceDrawableGeo::rayIntersectCreateDetail(const cvf::Ray& ray, cvf::Vec3d* intersectionPoint, cvf::ref<cvf::HitDetail>* hitDetail) const
+{
+    CVF_ASSERT(intersectionPoint);
+
+    const cvf::Vec3fArray* vertices = vertexArray();
+    if (!vertices) return false;
+
+    if (m_quadSearchTree.isNull())
+    {
+        buildQuadSearchTree();
+    }
+
+    std::vector<size_t> quadIndices;
+    m_quadSearchTree->findIntersectionCandidates(ray, &quadIndices);
+
+    bool anyHits = false;
+    double minDistSquared = 1.0e300;
+    uint faceHit = 0;
+
+    size_t i;
+    for (i = 0; i < quadIndices.size(); i++)
+    {
+        size_t quadIdx = quadIndices[i];
+
+        cvf::Vec3d v0(vertices->get(quadIdx*4));
+        cvf::Vec3d v1(vertices->get(quadIdx*4 + 1));
+        cvf::Vec3d v2(vertices->get(quadIdx*4 + 2));
+        cvf::Vec3d v3(vertices->get(quadIdx*4 + 3));
+
+        // A non-planar quad can be hit in both its triangles. Keep the nearest hit
+        cvf::Vec3d triangleIntersects[2];
+        bool triangleHits[2];
+        triangleHits[0] = ray.triangleIntersect(v0, v1, v2, &triangleIntersects[0]);
+        triangleHits[1] = ray.triangleIntersect(v0, v2, v3, &triangleIntersects[1]);
+
+        uint t;
+        for (t = 0; t < 2; t++)
+        {
+            if (!triangleHits[t]) continue;
+
+            double distSquared = (ray.origin() - triangleIntersects[t]).lengthSquared();
+            if (distSquared < minDistSquared)
+            {
+                *intersectionPoint = triangleIntersects[t];
+                minDistSquared = distSquared;
+                faceHit = static_cast<uint>(quadIdx*2 + t);
+                anyHits = true;
+            }
+        }
+    }
+
+    if (anyHits && hitDetail)
+    {
+        *hitDetail = new cvf::HitDetailDrawableGeo(faceHit);
+    }
+
+    return anyHits;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RivGridSurfaceDrawableGeo::buildQuadSearchTree() const
+{
+    const cvf::Vec3fArray* vertices = vertexArray();
+    CVF_ASSERT(vertices);
+
+    size_t quadCount = vertices->size() / 4;
+
+    std::vector<cvf::BoundingBox> quadBoundingBoxes(quadCount);
+    std::vector<size_t> quadIndices(quadCount);
+
+    int quadCountInt = static_cast<int>(quadCount);
+
+#pragma omp parallel for
+    for (int quadIdx = 0; quadIdx < quadCountInt; quadIdx++)
+    {
+        quadIndices[quadIdx] = quadIdx;
+
+        int cornerIdx;
+        for (cornerIdx = 0; cornerIdx < 4; cornerIdx++)
+        {
+            quadBoundingBoxes[quadIdx].add(cvf::Vec3d(vertices->get(quadIdx*4 + cornerIdx)));
+        }
+    }
+
+    m_quadSearchTree = new RigBoundingBoxTree;
+    m_quadSearchTree->build(quadBoundingBoxes, quadIndices);
+}
@@ -0,0 +1,47 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "cvfDrawableGeo.h"
+
+class RigBoundingBoxTree;
+
+//==================================================================================================
+///
+/// Drawable for the grid surface quads generated by cvf::StructGridGeometryGenerator.
+/// Ray intersection uses a bounding box tree over the quads instead of testing every triangle.
+/// The tree is built on the first pick, so only the grids regenerated after a visibility change
+/// are rebuilt. The reported face indices are the same as the ones from cvf::DrawableGeo.
+///
+//==================================================================================================
+class RivGridSurfaceDrawableGeo : public cvf::DrawableGeo
+{
+public:
+    RivGridSurfaceDrawableGeo();
+    ~RivGridSurfaceDrawableGeo();
+
+    virtual bool    rayIntersectCreateDetail(const cvf::Ray& ray, cvf::Vec3d* intersectionPoint, cvf::ref<cvf::HitDetail>* hitDetail) const;
+
+private:
+    void            buildQuadSearchTree() const;
+
+private:
+    mutable cvf::ref<RigBoundingBoxTree>    m_quadSearchTree;   ///< Bounding boxes of the quads in the vertex array, built on demand
+};
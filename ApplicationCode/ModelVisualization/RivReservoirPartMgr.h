@@ -47,7 +47,7 @@ public:
     void   setTransform(cvf::Transform* scaleTransform);
     void   setCellVisibility(size_t gridIndex, cvf::UByteArray* cellVisibilities );
 
-    //size_t gridCount() { return m_allGrids.size(); }
+    size_t gridCount() const { return m_allGrids.size(); }
     cvf::ref<cvf::UByteArray>  
            cellVisibility(size_t gridIdx);
 
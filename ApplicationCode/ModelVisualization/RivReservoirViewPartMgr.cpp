@@ -37,89 +37,116 @@ m_reservoirView(resv)
 
 
 //--------------------------------------------------------------------------------------------------
-/// Clears the geometry cache for the given, and the dependent geometryTypes (from a visibility standpoint)
+/// Schedules regeneration of the given, and the dependent geometryTypes (from a visibility standpoint).
+/// The geometry is kept until regenerated, so only the grids and K slabs where the cell visibility 
+/// changed are generated again
 //--------------------------------------------------------------------------------------------------
 void RivReservoirViewPartMgr::scheduleGeometryRegen(ReservoirGeometryCacheType geometryType)
 {
     switch (geometryType)
     {
     case INACTIVE:
-        clearGeometryCache(INACTIVE);
-        clearGeometryCache(RANGE_FILTERED_INACTIVE);
+        setGeometryNeedsRegen(INACTIVE);
+        setGeometryNeedsRegen(RANGE_FILTERED_INACTIVE);
         break;  
     case RANGE_FILTERED_INACTIVE:
-        clearGeometryCache(RANGE_FILTERED_INACTIVE);
+        setGeometryNeedsRegen(RANGE_FILTERED_INACTIVE);
         break;
     case ACTIVE:
-        clearGeometryCache(ACTIVE);
-        clearGeometryCache(ALL_WELL_CELLS);
-        clearGeometryCache(VISIBLE_WELL_CELLS);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS);
-        clearGeometryCache(RANGE_FILTERED);
-        clearGeometryCache(RANGE_FILTERED_WELL_CELLS);
-        clearGeometryCache(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(PROPERTY_FILTERED);
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(ACTIVE);
+        setGeometryNeedsRegen(ALL_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS);
+        setGeometryNeedsRegen(RANGE_FILTERED);
+        setGeometryNeedsRegen(RANGE_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(PROPERTY_FILTERED);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     case ALL_WELL_CELLS:
-        clearGeometryCache(ALL_WELL_CELLS);
-        clearGeometryCache(VISIBLE_WELL_CELLS);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS);
-        clearGeometryCache(RANGE_FILTERED);
-        clearGeometryCache(RANGE_FILTERED_WELL_CELLS);
-        clearGeometryCache(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(ALL_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS);
+        setGeometryNeedsRegen(RANGE_FILTERED);
+        setGeometryNeedsRegen(RANGE_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     case VISIBLE_WELL_CELLS:
-        clearGeometryCache(VISIBLE_WELL_CELLS);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS);
-        clearGeometryCache(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(PROPERTY_FILTERED);
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(PROPERTY_FILTERED);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     case VISIBLE_WELL_FENCE_CELLS:
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     case RANGE_FILTERED:
-        clearGeometryCache(RANGE_FILTERED);
-        clearGeometryCache(RANGE_FILTERED_INACTIVE);
-        clearGeometryCache(RANGE_FILTERED_WELL_CELLS);
-        clearGeometryCache(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(PROPERTY_FILTERED);
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(RANGE_FILTERED);
+        setGeometryNeedsRegen(RANGE_FILTERED_INACTIVE);
+        setGeometryNeedsRegen(RANGE_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(PROPERTY_FILTERED);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     case RANGE_FILTERED_WELL_CELLS:
-        clearGeometryCache(RANGE_FILTERED_WELL_CELLS);
-        clearGeometryCache(RANGE_FILTERED);
-        clearGeometryCache(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(RANGE_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(RANGE_FILTERED);
+        setGeometryNeedsRegen(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     case VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER:
-        clearGeometryCache(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     case VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER:
-        clearGeometryCache(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(VISIBLE_WELL_FENCE_CELLS_OUTSIDE_RANGE_FILTER);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     case PROPERTY_FILTERED:
-        clearGeometryCache(PROPERTY_FILTERED);
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(PROPERTY_FILTERED);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     case PROPERTY_FILTERED_WELL_CELLS:
-        clearGeometryCache(PROPERTY_FILTERED_WELL_CELLS);
+        setGeometryNeedsRegen(PROPERTY_FILTERED_WELL_CELLS);
         break;
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RivReservoirViewPartMgr::setGeometryNeedsRegen(ReservoirGeometryCacheType geomType)
+{
+    if (geomType == PROPERTY_FILTERED)
+    {
+        for (size_t i = 0; i < m_propFilteredGeometryFramesNeedsRegen.size(); ++i)
+        {
+            m_propFilteredGeometryFramesNeedsRegen[i] = true;
+        }
+    }
+    else if (geomType == PROPERTY_FILTERED_WELL_CELLS)
+    {
+        for (size_t i = 0; i < m_propFilteredWellGeometryFramesNeedsRegen.size(); ++i)
+        {
+            m_propFilteredWellGeometryFramesNeedsRegen[i] = true;
+        }
+    }
+    else
+    {
+        m_geometriesNeedsRegen[geomType] = true;
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
@@ -225,14 +252,19 @@ void RivReservoirViewPartMgr::appendDynamicGeometryPartsToModel(cvf::ModelBasicL
 void RivReservoirViewPartMgr::createGeometry(ReservoirGeometryCacheType geometryType)
 {
     RigReservoir* res = m_reservoirView->eclipseCase()->reservoirData();
-    m_geometries[geometryType].clearAndSetReservoir(res);
-    m_geometries[geometryType].setTransform(m_scaleTransform.p());
     std::vector<RigGridBase*> grids;
     res->allGrids(&grids);
 
+    if (m_geometries[geometryType].gridCount() != grids.size())
+    {
+        m_geometries[geometryType].clearAndSetReservoir(res);
+        m_geometries[geometryType].setTransform(m_scaleTransform.p());
+    }
+
     for (size_t i = 0; i < grids.size(); ++i)
     {
-        cvf::ref<cvf::UByteArray> cellVisibility = m_geometries[geometryType].cellVisibility(i); 
+        // Compute into a new array, letting the grid compare with the previous visibility
+        cvf::ref<cvf::UByteArray> cellVisibility = new cvf::UByteArray; 
         computeVisibility(cellVisibility.p(), geometryType, grids[i], i);
 
         m_geometries[geometryType].setCellVisibility(i, cellVisibility.p());
@@ -374,17 +406,22 @@ void RivReservoirViewPartMgr::createPropertyFilteredGeometry(size_t frameIndex)
         m_propFilteredGeometryFrames.resize(frameIndex + 1);
         m_propFilteredGeometryFramesNeedsRegen.resize(frameIndex + 1, true);
     }
-    if ( m_propFilteredGeometryFrames[frameIndex].isNull())  m_propFilteredGeometryFrames[frameIndex] = new RivReservoirPartMgr;
-    m_propFilteredGeometryFrames[frameIndex]->clearAndSetReservoir(res);
-    m_propFilteredGeometryFrames[frameIndex]->setTransform(m_scaleTransform.p());
+
     std::vector<RigGridBase*> grids;
     res->allGrids(&grids);
 
+    if ( m_propFilteredGeometryFrames[frameIndex].isNull())  m_propFilteredGeometryFrames[frameIndex] = new RivReservoirPartMgr;
+    if ( m_propFilteredGeometryFrames[frameIndex]->gridCount() != grids.size())
+    {
+        m_propFilteredGeometryFrames[frameIndex]->clearAndSetReservoir(res);
+        m_propFilteredGeometryFrames[frameIndex]->setTransform(m_scaleTransform.p());
+    }
+
     bool hasActiveRangeFilters  = m_reservoirView->rangeFilterCollection()->hasActiveFilters() || m_reservoirView->wellCollection()->hasVisibleWellCells();
 
     for (size_t i = 0; i < grids.size(); ++i)
     {
-        cvf::ref<cvf::UByteArray> cellVisibility = m_propFilteredGeometryFrames[frameIndex]->cellVisibility(i); 
+        cvf::ref<cvf::UByteArray> cellVisibility = new cvf::UByteArray; 
         cvf::ref<cvf::UByteArray> rangeVisibility; 
         cvf::ref<cvf::UByteArray> fenceVisibility; 
 
@@ -422,19 +459,21 @@ void RivReservoirViewPartMgr::createPropertyFilteredWellGeometry(size_t frameInd
         m_propFilteredWellGeometryFramesNeedsRegen.resize(frameIndex + 1, true);
     }
 
-    if ( m_propFilteredWellGeometryFrames[frameIndex].isNull())  m_propFilteredWellGeometryFrames[frameIndex] = new RivReservoirPartMgr;
-
-    m_propFilteredWellGeometryFrames[frameIndex]->clearAndSetReservoir(res);
-    m_propFilteredWellGeometryFrames[frameIndex]->setTransform(m_scaleTransform.p());
-
     std::vector<RigGridBase*> grids;
     res->allGrids(&grids);
 
+    if ( m_propFilteredWellGeometryFrames[frameIndex].isNull())  m_propFilteredWellGeometryFrames[frameIndex] = new RivReservoirPartMgr;
+    if ( m_propFilteredWellGeometryFrames[frameIndex]->gridCount() != grids.size())
+    {
+        m_propFilteredWellGeometryFrames[frameIndex]->clearAndSetReservoir(res);
+        m_propFilteredWellGeometryFrames[frameIndex]->setTransform(m_scaleTransform.p());
+    }
+
     bool hasActiveRangeFilters  = m_reservoirView->rangeFilterCollection()->hasActiveFilters() || m_reservoirView->wellCollection()->hasVisibleWellCells();
 
     for (size_t i = 0; i < grids.size(); ++i)
     {
-        cvf::ref<cvf::UByteArray> cellVisibility = m_propFilteredWellGeometryFrames[frameIndex]->cellVisibility(i); 
+        cvf::ref<cvf::UByteArray> cellVisibility = new cvf::UByteArray; 
         cvf::ref<cvf::UByteArray> rangeVisibility; 
         cvf::ref<cvf::UByteArray> wellCellsOutsideVisibility; 
 
@@ -74,6 +74,7 @@ private:
     void createPropertyFilteredGeometry(size_t frameIndex);
     void createPropertyFilteredWellGeometry(size_t frameIndex);
 
+    void setGeometryNeedsRegen(ReservoirGeometryCacheType geomType);
     void clearGeometryCache(ReservoirGeometryCacheType geomType);
 
 
@@ -36,6 +36,7 @@
 
 #include "RIApplication.h"
 #include "RIPreferences.h"
+#include "RIMainWindow.h"
 
 
 CAF_PDM_SOURCE_INIT(RimInputReservoir, "RimInputReservoir");
@@ -114,11 +115,23 @@ void RimInputReservoir::openDataFileSet(const QStringList& filenames)
              {
                  m_gridFileName = filenames[i];
 
+                 if (RIApplication::instance()->preferences()->shareCoincidentGridNodes)
+                 {
+                     m_rigReservoir->mainGrid()->weldCoincidentNodes();
+                 }
+
                  m_rigReservoir->computeFaults();
                  m_rigReservoir->mainGrid()->computeCachedData();
 
                  break;
              }
+             else if (this->reservoirData()->mainGrid()->gridPointDimensions() != cvf::Vec3st(0,0,0))
+             {
+                 // The grid keywords were found, but the grid could not be transferred. Discard the partial grid
+                 m_rigReservoir = new RigReservoir;
+
+                 QMessageBox::warning(RIMainWindow::instance(), "Error when opening case", "Could not read the grid in the Eclipse Input file: \n" + filenames[i]);
+             }
          }
     }
 
@@ -195,6 +208,11 @@ bool RimInputReservoir::openEclipseGridFile()
                 return false;
             }
 
+            if (RIApplication::instance()->preferences()->shareCoincidentGridNodes)
+            {
+                reservoir->mainGrid()->weldCoincidentNodes();
+            }
+
             m_rigReservoir = reservoir;
             loadAndSyncronizeInputProperties();
         }
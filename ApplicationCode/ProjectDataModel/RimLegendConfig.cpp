@@ -33,6 +33,8 @@ namespace caf {
     {
         addItem(RimLegendConfig::AUTOMATIC_ALLTIMESTEPS,    "AUTOMATIC_ALLTIMESTEPS",       "Global range");
         addItem(RimLegendConfig::AUTOMATIC_CURRENT_TIMESTEP,"AUTOMATIC_CURRENT_TIMESTEP",   "Local range");
+        addItem(RimLegendConfig::AUTOMATIC_P10_P90_ALLTIMESTEPS,    "AUTOMATIC_P10_P90_ALLTIMESTEPS",       "Global P10 - P90 range");
+        addItem(RimLegendConfig::AUTOMATIC_P10_P90_CURRENT_TIMESTEP,"AUTOMATIC_P10_P90_CURRENT_TIMESTEP",   "Local P10 - P90 range");
         addItem(RimLegendConfig::USER_DEFINED,              "USER_DEFINED_MAX_MIN",         "User defined range");
         setDefault(RimLegendConfig::AUTOMATIC_ALLTIMESTEPS);
     }
@@ -72,7 +74,11 @@ RimLegendConfig::RimLegendConfig()
     :   m_globalAutoMax(cvf::UNDEFINED_DOUBLE),
         m_globalAutoMin(cvf::UNDEFINED_DOUBLE),
         m_localAutoMax(cvf::UNDEFINED_DOUBLE),
-        m_localAutoMin(cvf::UNDEFINED_DOUBLE)
+        m_localAutoMin(cvf::UNDEFINED_DOUBLE),
+        m_globalAutoP10(cvf::UNDEFINED_DOUBLE),
+        m_globalAutoP90(cvf::UNDEFINED_DOUBLE),
+        m_localAutoP10(cvf::UNDEFINED_DOUBLE),
+        m_localAutoP90(cvf::UNDEFINED_DOUBLE)
 {
     CAF_PDM_InitObject("Legend Definition", ":/Legend.png", "", "");
     CAF_PDM_InitField(&m_numLevels, "NumberOfLevels", 8, "Number of levels", "", "","");
@@ -159,6 +165,16 @@ void RimLegendConfig::updateLegend()
        adjustedMin = adjust(m_localAutoMin, m_precision);
        adjustedMax = adjust(m_localAutoMax, m_precision);
    }
+   else if (m_rangeMode == AUTOMATIC_P10_P90_ALLTIMESTEPS)
+   {
+       adjustedMin = adjust(m_globalAutoP10, m_precision);
+       adjustedMax = adjust(m_globalAutoP90, m_precision);
+   }
+   else if (m_rangeMode == AUTOMATIC_P10_P90_CURRENT_TIMESTEP)
+   {
+       adjustedMin = adjust(m_localAutoP10, m_precision);
+       adjustedMax = adjust(m_localAutoP90, m_precision);
+   }
    else
    {
        adjustedMin = adjust(m_userDefinedMinValue, m_precision);
@@ -295,6 +311,24 @@ void RimLegendConfig::setAutomaticRanges(double globalMin, double globalMax, dou
     updateLegend();
 }
 
+//--------------------------------------------------------------------------------------------------
+/// Set the P10 and P90 values used by the percentile range modes.
+/// Falls back to the min max ranges if the percentiles are undefined
+//--------------------------------------------------------------------------------------------------
+void RimLegendConfig::setAutomaticPercentileRanges(double globalP10, double globalP90, double localP10, double localP90)
+{
+    bool isGlobalDefined = globalP10 != cvf::UNDEFINED_DOUBLE && globalP10 != HUGE_VAL && globalP90 != cvf::UNDEFINED_DOUBLE && globalP90 != HUGE_VAL;
+    bool isLocalDefined  = localP10  != cvf::UNDEFINED_DOUBLE && localP10  != HUGE_VAL && localP90  != cvf::UNDEFINED_DOUBLE && localP90  != HUGE_VAL;
+
+    m_globalAutoP10 = isGlobalDefined ? adjust(globalP10, m_precision) : m_globalAutoMin;
+    m_globalAutoP90 = isGlobalDefined ? adjust(globalP90, m_precision) : m_globalAutoMax;
+
+    m_localAutoP10 = isLocalDefined ? adjust(localP10, m_precision) : m_localAutoMin;
+    m_localAutoP90 = isLocalDefined ? adjust(localP90, m_precision) : m_localAutoMax;
+
+    updateLegend();
+}
+
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
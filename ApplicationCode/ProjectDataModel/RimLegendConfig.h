@@ -47,6 +47,8 @@ public:
     {
         AUTOMATIC_ALLTIMESTEPS,
         AUTOMATIC_CURRENT_TIMESTEP,
+        AUTOMATIC_P10_P90_ALLTIMESTEPS,
+        AUTOMATIC_P10_P90_CURRENT_TIMESTEP,
         USER_DEFINED
     };
 
@@ -74,6 +76,7 @@ public:
     void                                        recreateLegend();
     void                                        setColorRangeMode(ColorRangesType colorMode);
     void                                        setAutomaticRanges(double globalMin, double globalMax, double localMin, double localMax);
+    void                                        setAutomaticPercentileRanges(double globalP10, double globalP90, double localP10, double localP90);
     void                                        setPosition(cvf::Vec2ui position);
 
     cvf::ScalarMapper*                          scalarMapper() { return m_currentScalarMapper.p(); }
@@ -103,6 +106,10 @@ private:
     double                                      m_globalAutoMin;
     double                                      m_localAutoMax;
     double                                      m_localAutoMin;
+    double                                      m_globalAutoP10;
+    double                                      m_globalAutoP90;
+    double                                      m_localAutoP10;
+    double                                      m_localAutoP90;
 
     cvf::Vec2ui                                 m_position;
 
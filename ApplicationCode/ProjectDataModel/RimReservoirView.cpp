@@ -1041,21 +1041,17 @@ void RimReservoirView::updateLegends()
 
     if (this->cellResult()->hasResult())
     {
-        double globalMin, globalMax;
-        results->minMaxCellScalarValues(this->cellResult()->gridScalarIndex(), globalMin, globalMax);
+        size_t timeStepIndex = this->cellResult()->hasDynamicResult() ? m_currentTimeStep : 0;
 
-        double localMin, localMax;
-        if (this->cellResult()->hasDynamicResult())
-        {
-            results->minMaxCellScalarValues(this->cellResult()->gridScalarIndex(), m_currentTimeStep, localMin, localMax);
-        }
-        else
-        {
-             localMin = globalMin;
-             localMax = globalMax;
-        }
+        // The range of all the timesteps is taken from the timesteps visited so far, as reading all the 
+        // timesteps to compute it would delay the first frame. It widens as more timesteps are shown
+        RigStatistics globalStatistics = results->visitedTimeStepsStatistics(this->cellResult()->gridScalarIndex(), timeStepIndex);
+        const RigStatistics& localStatistics = results->statistics(this->cellResult()->gridScalarIndex(), timeStepIndex);
+
+        this->cellResult()->legendConfig->setAutomaticRanges(globalStatistics.m_min, globalStatistics.m_max, localStatistics.m_min, localStatistics.m_max);
 
-        this->cellResult()->legendConfig->setAutomaticRanges(globalMin, globalMax, localMin, localMax);
+        this->cellResult()->legendConfig->setAutomaticPercentileRanges(globalStatistics.m_quantiles.quantile(0.1), globalStatistics.m_quantiles.quantile(0.9), 
+                                                                       localStatistics.m_quantiles.quantile(0.1), localStatistics.m_quantiles.quantile(0.9));
 
         m_viewer->setColorLegend1(this->cellResult()->legendConfig->legend());
         this->cellResult()->legendConfig->legend()->setTitle(cvfqt::Utils::fromQString(QString("Cell Results: \n") + this->cellResult()->resultVariable));
@@ -1063,6 +1059,7 @@ void RimReservoirView::updateLegends()
     else
     {
         this->cellResult()->legendConfig->setAutomaticRanges(cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE);
+        this->cellResult()->legendConfig->setAutomaticPercentileRanges(cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE);
         m_viewer->setColorLegend1(NULL);
     }
 
@@ -1071,6 +1068,7 @@ void RimReservoirView::updateLegends()
         double globalMin, globalMax;
         this->cellEdgeResult()->minMaxCellEdgeValues(globalMin, globalMax);
         this->cellEdgeResult()->legendConfig->setAutomaticRanges(globalMin, globalMax, globalMin, globalMax);
+        this->cellEdgeResult()->legendConfig->setAutomaticPercentileRanges(cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE);
         m_viewer->setColorLegend2(this->cellEdgeResult()->legendConfig->legend());
         this->cellEdgeResult()->legendConfig->legend()->setTitle(cvfqt::Utils::fromQString(QString("Edge Results: \n") + this->cellEdgeResult()->resultVariable));
 
@@ -1079,6 +1077,7 @@ void RimReservoirView::updateLegends()
     {
         m_viewer->setColorLegend2(NULL);
         this->cellEdgeResult()->legendConfig->setAutomaticRanges(cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE);
+        this->cellEdgeResult()->legendConfig->setAutomaticPercentileRanges(cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE, cvf::UNDEFINED_DOUBLE);
     }
 }
 
@@ -24,8 +24,11 @@
 #include "RimReservoirView.h"
 #include "RifReaderMockModel.h"
 #include "RifReaderEclipseInput.h"
+#include "RifEclipseCaseLoader.h"
 #include "cafProgressInfo.h"
 #include "RimProject.h"
+#include "RIApplication.h"
+#include "RIPreferences.h"
 
 
 CAF_PDM_SOURCE_INIT(RimResultReservoir, "EclipseCase");
@@ -90,13 +93,21 @@ bool RimResultReservoir::openEclipseGridFile()
         }
 
         RigReservoir* reservoir = new RigReservoir;
-        readerInterface = new RifReaderEclipseOutput;
+        cvf::ref<RifReaderEclipseOutput> eclipseReader = new RifReaderEclipseOutput;
+        eclipseReader->setResultCacheFileEnabled(RIApplication::instance()->preferences()->useResultCacheFile);
+
+        readerInterface = eclipseReader;
         if (!readerInterface->open(fname, reservoir))
         {
             delete reservoir;
             return false;
         }
 
+        if (RIApplication::instance()->preferences()->shareCoincidentGridNodes)
+        {
+            reservoir->mainGrid()->weldCoincidentNodes();
+        }
+
         m_rigReservoir = reservoir;
     }
 
@@ -105,6 +116,8 @@ bool RimResultReservoir::openEclipseGridFile()
     CVF_ASSERT(m_rigReservoir.notNull());
     CVF_ASSERT(readerInterface.notNull());
 
+    applyResultMemoryBudget();
+
     progInfo.setProgressDescription("Computing Faults");
     m_rigReservoir->computeFaults();
 
@@ -116,6 +129,50 @@ bool RimResultReservoir::openEclipseGridFile()
  }
 
 
+//--------------------------------------------------------------------------------------------------
+/// Use the grid of a case loaded in the background. Until the results are attached, the case has
+/// no results, and openEclipseGridFile() will use the grid as it is
+//--------------------------------------------------------------------------------------------------
+void RimResultReservoir::attachLoadedGeometry(RifEclipseCaseLoader* loader)
+{
+    CVF_ASSERT(loader && loader->reservoir());
+
+    m_rigReservoir = loader->reservoir();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Attach the results and wells read by a completed background loader to the grid attached by 
+/// attachLoadedGeometry()
+//--------------------------------------------------------------------------------------------------
+void RimResultReservoir::attachLoadedResults(RifEclipseCaseLoader* loader)
+{
+    CVF_ASSERT(loader && loader->isCompleted());
+    CVF_ASSERT(m_rigReservoir.notNull() && m_rigReservoir.p() == loader->reservoir());
+
+    RigMainGrid* mainGrid = m_rigReservoir->mainGrid();
+
+    mainGrid->setResults(RifReaderInterface::MATRIX_RESULTS, loader->results(RifReaderInterface::MATRIX_RESULTS));
+    mainGrid->setResults(RifReaderInterface::FRACTURE_RESULTS, loader->results(RifReaderInterface::FRACTURE_RESULTS));
+
+    mainGrid->results(RifReaderInterface::MATRIX_RESULTS)->setReaderInterface(loader->reader());
+    mainGrid->results(RifReaderInterface::FRACTURE_RESULTS)->setReaderInterface(loader->reader());
+
+    m_rigReservoir->setWellResults(loader->wellResults());
+
+    applyResultMemoryBudget();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RimResultReservoir::applyResultMemoryBudget()
+{
+    int memoryBudgetMb = RIApplication::instance()->preferences()->resultTimeStepMemoryBudget;
+    size_t memoryBudget = static_cast<size_t>(qMax(0, memoryBudgetMb)) * 1024 * 1024;
+    m_rigReservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS)->setFrameMemoryBudget(memoryBudget);
+    m_rigReservoir->mainGrid()->results(RifReaderInterface::FRACTURE_RESULTS)->setFrameMemoryBudget(memoryBudget);
+}
+
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
@@ -25,6 +25,7 @@
 #include "RimReservoir.h"
 
  class RifReaderInterface;
+ class RifEclipseCaseLoader;
 
 //==================================================================================================
 //
@@ -46,6 +47,9 @@ public:
 
     virtual bool                openEclipseGridFile();
 
+    void                        attachLoadedGeometry(RifEclipseCaseLoader* loader);
+    void                        attachLoadedResults(RifEclipseCaseLoader* loader);
+
     //virtual caf::PdmFieldHandle*    userDescriptionField()  { return &caseName;}
 
     virtual QString locationOnDisc() const;
@@ -55,4 +59,6 @@ private:
 
     QString createAbsoluteFilenameFromCase(const QString& caseName);
 
+    void    applyResultMemoryBudget();
+
 };
@@ -0,0 +1,411 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include "RIStdInclude.h"
+#include "gtest/gtest.h"
+
+#include "RigReservoir.h"
+#include "RigReservoirBuilderMock.h"
+#include "cvfStructGridGeometryGenerator.h"
+#include "cvfDrawableGeo.h"
+
+
+
+//--------------------------------------------------------------------------------------------------
+/// Mock reservoir spanning (10, 10, 10) to worldMax. Optionally with a 2 x 2 x 2 refinement of cell (1, 1, 1)
+//--------------------------------------------------------------------------------------------------
+static cvf::ref<RigReservoir> createMockReservoir(const cvf::Vec3d& worldMax, const cvf::Vec3st& gridPointDimensions, bool addLocalGridRefinement = false)
+{
+    cvf::ref<RigReservoir> reservoir = new RigReservoir;
+
+    RigReservoirBuilderMock mockBuilder;
+    mockBuilder.setWorldCoordinates(cvf::Vec3d(10, 10, 10), worldMax);
+    mockBuilder.setGridPointDimensions(gridPointDimensions);
+    if (addLocalGridRefinement)
+    {
+        mockBuilder.addLocalGridRefinement(cvf::Vec3st(1, 1, 1), cvf::Vec3st(1, 1, 1), cvf::Vec3st(2, 2, 2));
+    }
+    mockBuilder.populateReservoir(reservoir.p());
+
+    return reservoir;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigMainGridTest, WeldCoincidentNodes)
+{
+    cvf::ref<RigReservoir> reservoir = createMockReservoir(cvf::Vec3d(20, 20, 20), cvf::Vec3st(5, 4, 3));
+
+    RigMainGrid* mainGrid = reservoir->mainGrid();
+    ASSERT_EQ(24u * 8u, mainGrid->nodes().size());
+
+    // Make a fault by moving the upper corners of the last cell
+    RigCell& faultCell = mainGrid->cell(mainGrid->cellCount() - 1);
+    size_t cIdx;
+    for (cIdx = 4; cIdx < 8; ++cIdx)
+    {
+        mainGrid->nodes()[faultCell.cornerIndices()[cIdx]].z() += 1.0;
+    }
+
+    std::vector<cvf::Vec3d> originalCorners;
+    size_t cellIdx;
+    for (cellIdx = 0; cellIdx < mainGrid->cells().size(); ++cellIdx)
+    {
+        for (cIdx = 0; cIdx < 8; ++cIdx)
+        {
+            originalCorners.push_back(mainGrid->nodes()[mainGrid->cells()[cellIdx].cornerIndices()[cIdx]]);
+        }
+    }
+
+    mainGrid->weldCoincidentNodes();
+
+    // One node per grid point, plus the displaced corners of the fault cell that are shared with other cells
+    EXPECT_EQ(5u * 4u * 3u + 3u, mainGrid->nodes().size());
+
+    for (cellIdx = 0; cellIdx < mainGrid->cells().size(); ++cellIdx)
+    {
+        for (cIdx = 0; cIdx < 8; ++cIdx)
+        {
+            const cvf::Vec3d& corner = mainGrid->nodes()[mainGrid->cells()[cellIdx].cornerIndices()[cIdx]];
+            EXPECT_TRUE(corner == originalCorners[cellIdx*8 + cIdx]);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+static void checkFaultFaces(bool weldNodes)
+{
+    cvf::ref<RigReservoir> reservoir = createMockReservoir(cvf::Vec3d(20, 20, 20), cvf::Vec3st(5, 4, 3));
+
+    RigMainGrid* mainGrid = reservoir->mainGrid();
+
+    // Make a fault by moving the upper corners of the last cell
+    RigCell& faultCell = mainGrid->cell(mainGrid->cellIndexFromIJK(3, 2, 1));
+    size_t cIdx;
+    for (cIdx = 4; cIdx < 8; ++cIdx)
+    {
+        mainGrid->nodes()[faultCell.cornerIndices()[cIdx]].z() += 1.0;
+    }
+
+    if (weldNodes)
+    {
+        mainGrid->weldCoincidentNodes();
+    }
+
+    reservoir->computeFaults();
+
+    size_t faultFaceCount = 0;
+    size_t cellIdx;
+    for (cellIdx = 0; cellIdx < mainGrid->cellCount(); ++cellIdx)
+    {
+        int face;
+        for (face = 0; face < 6; ++face)
+        {
+            if (mainGrid->cell(cellIdx).isCellFaceFault(static_cast<cvf::StructGridInterface::FaceType>(face))) faultFaceCount++;
+        }
+    }
+
+    // The moved corners are on the NEG_I and NEG_J faces, the POS_I, POS_J and POS_K faces are at the grid boundary
+    EXPECT_EQ(4u, faultFaceCount);
+    EXPECT_TRUE(faultCell.isCellFaceFault(cvf::StructGridInterface::NEG_I));
+    EXPECT_TRUE(faultCell.isCellFaceFault(cvf::StructGridInterface::NEG_J));
+    EXPECT_TRUE(mainGrid->cell(mainGrid->cellIndexFromIJK(2, 2, 1)).isCellFaceFault(cvf::StructGridInterface::POS_I));
+    EXPECT_TRUE(mainGrid->cell(mainGrid->cellIndexFromIJK(3, 1, 1)).isCellFaceFault(cvf::StructGridInterface::POS_J));
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigMainGridTest, ComputeFaults)
+{
+    checkFaultFaces(false);
+    checkFaultFaces(true);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigMainGridTest, CellFromCoordinate)
+{
+    // Cells of size 2 x 2 x 2
+    cvf::ref<RigReservoir> reservoir = createMockReservoir(cvf::Vec3d(20, 18, 16), cvf::Vec3st(6, 5, 4), true);
+
+    RigMainGrid* mainGrid = reservoir->mainGrid();
+    mainGrid->computeCachedData();
+
+    EXPECT_TRUE(mainGrid->minCoordinate() == cvf::Vec3d(10, 10, 10));
+    EXPECT_TRUE(mainGrid->maxCoordinate() == cvf::Vec3d(20, 18, 16));
+
+    size_t i, j, k;
+    ASSERT_TRUE(mainGrid->cellIJKFromCoordinate(cvf::Vec3d(17.5, 11.0, 15.0), &i, &j, &k));
+    EXPECT_EQ(3u, i);
+    EXPECT_EQ(0u, j);
+    EXPECT_EQ(2u, k);
+
+    EXPECT_FALSE(mainGrid->cellIJKFromCoordinate(cvf::Vec3d(21.0, 11.0, 15.0), &i, &j, &k));
+
+    cvf::Vec3d cellMin, cellMax;
+    mainGrid->cellMinMaxCordinates(mainGrid->cellIndexFromIJK(3, 0, 2), &cellMin, &cellMax);
+    EXPECT_TRUE(cellMin == cvf::Vec3d(16, 10, 14));
+    EXPECT_TRUE(cellMax == cvf::Vec3d(18, 12, 16));
+    EXPECT_TRUE(mainGrid->cellCentroid(mainGrid->cellIndexFromIJK(3, 0, 2)) == cvf::Vec3d(17, 11, 15));
+
+    // A coordinate in the refined cell is found in the local grid
+    cvf::Vec3d refinedCoord(12.5, 12.5, 12.5);
+    size_t globalCellIndex = mainGrid->findCellFromCoordinate(refinedCoord);
+    ASSERT_NE(cvf::UNDEFINED_SIZE_T, globalCellIndex);
+
+    const RigCell& refinedCell = mainGrid->cells()[globalCellIndex];
+    EXPECT_FALSE(refinedCell.hostGrid()->isMainGrid());
+    EXPECT_TRUE(refinedCell.containsPoint(refinedCoord));
+
+    ASSERT_TRUE(refinedCell.hostGrid()->cellIJKFromCoordinate(refinedCoord, &i, &j, &k));
+    EXPECT_EQ(0u, i);
+    EXPECT_EQ(0u, j);
+    EXPECT_EQ(0u, k);
+
+    // The main grid still reports the host cell
+    ASSERT_TRUE(mainGrid->cellIJKFromCoordinate(refinedCoord, &i, &j, &k));
+    EXPECT_EQ(1u, i);
+    EXPECT_EQ(1u, j);
+    EXPECT_EQ(1u, k);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigMainGridTest, ActiveCellIndicesInBox)
+{
+    cvf::ref<RigReservoir> reservoir = createMockReservoir(cvf::Vec3d(20, 18, 16), cvf::Vec3st(6, 5, 4));
+
+    RigMainGrid* mainGrid = reservoir->mainGrid();
+    mainGrid->computeCachedData();
+
+    cvf::Vec3st min(1, 0, 1);
+    cvf::Vec3st max(3, 2, 2);
+
+    std::vector<size_t> expected;
+    for (size_t cIdx = 0; cIdx < mainGrid->cells().size(); ++cIdx)
+    {
+        const RigCell& cell = mainGrid->cells()[cIdx];
+        if (!cell.isActiveInMatrixModel()) continue;
+
+        size_t i, j, k;
+        mainGrid->ijkFromCellIndex(cell.mainGridCellIndex(), &i, &j, &k);
+        if (i >= 1 && i <= 3 && j <= 2 && k >= 1 && k <= 2)
+        {
+            expected.push_back(cell.activeIndexInMatrixModel());
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<size_t> activeCellIndices;
+    mainGrid->matrixModelActiveCellIndicesInBox(min, max, &activeCellIndices);
+
+    EXPECT_FALSE(activeCellIndices.empty());
+    EXPECT_TRUE(activeCellIndices == expected);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigMainGridTest, ActiveCellGeometry)
+{
+    cvf::ref<RigReservoir> reservoir = createMockReservoir(cvf::Vec3d(20, 18, 16), cvf::Vec3st(6, 5, 4));
+
+    RigMainGrid* mainGrid = reservoir->mainGrid();
+
+    size_t activeCellCount = 0;
+    size_t cIdx;
+    for (cIdx = 0; cIdx < mainGrid->cells().size(); ++cIdx)
+    {
+        if (mainGrid->cells()[cIdx].isActiveInMatrixModel()) activeCellCount++;
+    }
+    mainGrid->setGlobalMatrixModelActiveCellCount(activeCellCount);
+    mainGrid->computeCachedData();
+
+    const std::vector< std::vector<qint32> >& cellInfo = mainGrid->matrixModelActiveCellInfo();
+    ASSERT_EQ(8u, cellInfo.size());
+    ASSERT_EQ(activeCellCount, cellInfo[0].size());
+
+    std::vector<double> centers;
+    mainGrid->matrixModelActiveCellCenters(&centers);
+    ASSERT_EQ(3 * activeCellCount, centers.size());
+
+    std::vector<double> corners;
+    mainGrid->matrixModelActiveCellCorners(&corners);
+    ASSERT_EQ(24 * activeCellCount, corners.size());
+
+    for (cIdx = 0; cIdx < mainGrid->cells().size(); ++cIdx)
+    {
+        const RigCell& cell = mainGrid->cells()[cIdx];
+        if (!cell.isActiveInMatrixModel()) continue;
+
+        size_t activeIndex = cell.activeIndexInMatrixModel();
+
+        size_t i, j, k;
+        mainGrid->ijkFromCellIndex(cell.cellIndex(), &i, &j, &k);
+        EXPECT_EQ(0, cellInfo[0][activeIndex]);
+        EXPECT_EQ(static_cast<qint32>(i), cellInfo[1][activeIndex]);
+        EXPECT_EQ(static_cast<qint32>(j), cellInfo[2][activeIndex]);
+        EXPECT_EQ(static_cast<qint32>(k), cellInfo[3][activeIndex]);
+        EXPECT_EQ(static_cast<qint32>(i), cellInfo[5][activeIndex]);
+
+        cvf::Vec3d center = cell.center();
+        size_t coordIdx;
+        for (coordIdx = 0; coordIdx < 3; ++coordIdx)
+        {
+            EXPECT_DOUBLE_EQ(center[coordIdx], centers[coordIdx * activeCellCount + activeIndex]);
+        }
+
+        const cvf::Vec3d& lastCorner = mainGrid->nodes()[cell.cornerIndices()[7]];
+        for (coordIdx = 0; coordIdx < 3; ++coordIdx)
+        {
+            EXPECT_DOUBLE_EQ(lastCorner[coordIdx], corners[(coordIdx * 8 + 7) * activeCellCount + activeIndex]);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigMainGridTest, VisibleFaceMask)
+{
+    cvf::ref<RigReservoir> reservoir = createMockReservoir(cvf::Vec3d(20, 18, 16), cvf::Vec3st(6, 5, 4), true);
+
+    RigMainGrid* mainGrid = reservoir->mainGrid();
+    mainGrid->computeCachedData();
+
+    // Hide every third cell
+    cvf::ref<cvf::UByteArray> cellVisibility = new cvf::UByteArray(mainGrid->cellCount());
+    size_t cIdx;
+    for (cIdx = 0; cIdx < mainGrid->cellCount(); ++cIdx)
+    {
+        cellVisibility->set(cIdx, cIdx % 3 != 0);
+    }
+
+    RigGridCellFaceVisibilityFilter filter(mainGrid);
+    filter.m_showFaultFaces = false;
+    filter.m_showExternalFaces = true;
+
+    for (cIdx = 0; cIdx < mainGrid->cellCount(); ++cIdx)
+    {
+        size_t i, j, k;
+        mainGrid->ijkFromCellIndex(cIdx, &i, &j, &k);
+
+        cvf::ubyte faceMask = filter.visibleFaceMask(i, j, k, cellVisibility.p());
+
+        int face;
+        for (face = 0; face < 6; face++)
+        {
+            cvf::StructGridInterface::FaceType faceType = static_cast<cvf::StructGridInterface::FaceType>(face);
+
+            size_t ni, nj, nk;
+            cvf::StructGridInterface::neighborIJKAtCellFace(i, j, k, faceType, &ni, &nj, &nk);
+
+            bool expectVisible = false;
+            if (ni >= mainGrid->cellCountI() || nj >= mainGrid->cellCountJ() || nk >= mainGrid->cellCountK())
+            {
+                expectVisible = true;
+            }
+            else
+            {
+                size_t neighborCellIndex = mainGrid->cellIndexFromIJK(ni, nj, nk);
+                expectVisible = !mainGrid->cell(neighborCellIndex).subGrid() && !(*cellVisibility)[neighborCellIndex];
+            }
+
+            EXPECT_EQ(expectVisible, (faceMask & (1 << face)) != 0);
+        }
+    }
+
+    // The faces toward the refined cell are left to the LGR
+    size_t hostCellIndex = mainGrid->cellIndexFromIJK(1, 1, 1);
+    EXPECT_TRUE(mainGrid->subGridFaceMask(mainGrid->cellIndexFromIJK(0, 1, 1)) & (1 << cvf::StructGridInterface::POS_I));
+    EXPECT_TRUE(mainGrid->subGridFaceMask(mainGrid->cellIndexFromIJK(1, 1, 2)) & (1 << cvf::StructGridInterface::NEG_K));
+    EXPECT_EQ(0, mainGrid->subGridFaceMask(hostCellIndex));
+
+    EXPECT_EQ((1 << cvf::StructGridInterface::NEG_I) | (1 << cvf::StructGridInterface::NEG_J) | (1 << cvf::StructGridInterface::NEG_K), 
+              mainGrid->gridEdgeFaceMask(0));
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigMainGridTest, RegenerateChangedSlabs)
+{
+    cvf::ref<RigReservoir> reservoir = createMockReservoir(cvf::Vec3d(20, 18, 16), cvf::Vec3st(6, 5, 7));
+
+    RigMainGrid* mainGrid = reservoir->mainGrid();
+    mainGrid->computeCachedData();
+
+    RigGridCellFaceVisibilityFilter filter(mainGrid);
+    filter.m_showFaultFaces = false;
+    filter.m_showExternalFaces = true;
+
+    cvf::ref<cvf::UByteArray> allVisible = new cvf::UByteArray(mainGrid->cellCount());
+    allVisible->setAll(true);
+
+    // Hide a range filter like box of cells in K = 2 and K = 3
+    cvf::ref<cvf::UByteArray> boxHidden = new cvf::UByteArray(*allVisible);
+    size_t cIdx;
+    for (cIdx = 0; cIdx < mainGrid->cellCount(); ++cIdx)
+    {
+        size_t i, j, k;
+        mainGrid->ijkFromCellIndex(cIdx, &i, &j, &k);
+        if (i >= 1 && i <= 3 && j <= 2 && (k == 2 || k == 3)) boxHidden->set(cIdx, false);
+    }
+
+    cvf::StructGridGeometryGenerator incrementalGenerator(mainGrid);
+    incrementalGenerator.addFaceVisibilityFilter(&filter);
+    incrementalGenerator.setCellVisibility(allVisible.p());
+    cvf::ref<cvf::DrawableGeo> allVisibleGeo = incrementalGenerator.generateSurface();
+    ASSERT_TRUE(allVisibleGeo.notNull());
+
+    incrementalGenerator.setCellVisibility(boxHidden.p());
+    cvf::ref<cvf::DrawableGeo> incrementalGeo = incrementalGenerator.generateSurface();
+
+    cvf::StructGridGeometryGenerator generator(mainGrid);
+    generator.addFaceVisibilityFilter(&filter);
+    generator.setCellVisibility(boxHidden.p());
+    cvf::ref<cvf::DrawableGeo> geo = generator.generateSurface();
+
+    ASSERT_TRUE(incrementalGeo.notNull() && geo.notNull());
+    EXPECT_TRUE(incrementalGenerator.quadToGridCellIndices() == generator.quadToGridCellIndices());
+    EXPECT_TRUE(incrementalGenerator.quadToFace() == generator.quadToFace());
+
+    const cvf::Vec3fArray* incrementalVertices = incrementalGeo->vertexArray();
+    const cvf::Vec3fArray* vertices = geo->vertexArray();
+    ASSERT_EQ(vertices->size(), incrementalVertices->size());
+
+    size_t vIdx;
+    for (vIdx = 0; vIdx < vertices->size(); ++vIdx)
+    {
+        EXPECT_TRUE(vertices->get(vIdx) == incrementalVertices->get(vIdx));
+    }
+
+    // Showing all cells again gives the original geometry
+    cvf::ref<cvf::UByteArray> allVisibleAgain = new cvf::UByteArray(*allVisible);
+    incrementalGenerator.setCellVisibility(allVisibleAgain.p());
+    incrementalGeo = incrementalGenerator.generateSurface();
+
+    ASSERT_EQ(allVisibleGeo->vertexArray()->size(), incrementalGeo->vertexArray()->size());
+    EXPECT_EQ(allVisibleGeo->faceCount(), incrementalGeo->faceCount());
+}
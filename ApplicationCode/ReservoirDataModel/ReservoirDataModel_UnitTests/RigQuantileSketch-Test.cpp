@@ -0,0 +1,97 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#include "RIStdInclude.h"
+#include "gtest/gtest.h"
+
+#include "RigQuantileSketch.h"
+
+#include <algorithm>
+
+
+//--------------------------------------------------------------------------------------------------
+/// Returns the fraction of the sorted values that are below \a value
+//--------------------------------------------------------------------------------------------------
+static double rankOf(const std::vector<double>& sortedValues, double value)
+{
+    return static_cast<double>(std::lower_bound(sortedValues.begin(), sortedValues.end(), value) - sortedValues.begin()) / sortedValues.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigQuantileSketchTest, SkewedValues)
+{
+    // Log-normal like permeability values, added in a scrambled order
+    std::vector<double> values;
+    const size_t valueCount = 200000;
+    for (size_t i = 0; i < valueCount; i++)
+    {
+        size_t scrambled = (i * 7919) % valueCount;
+        values.push_back(std::exp(12.0 * scrambled / valueCount));
+    }
+
+    RigQuantileSketch sketch;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        sketch.add(values[i]);
+    }
+
+    EXPECT_EQ(valueCount, sketch.valueCount());
+
+    std::sort(values.begin(), values.end());
+
+    EXPECT_NEAR(0.1, rankOf(values, sketch.quantile(0.1)), 0.02);
+    EXPECT_NEAR(0.5, rankOf(values, sketch.quantile(0.5)), 0.02);
+    EXPECT_NEAR(0.9, rankOf(values, sketch.quantile(0.9)), 0.02);
+
+    EXPECT_EQ(values.front(), sketch.quantile(0.0));
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigQuantileSketchTest, Merge)
+{
+    RigQuantileSketch emptySketch;
+    EXPECT_EQ(HUGE_VAL, emptySketch.quantile(0.5));
+
+    // Ten "time steps" with increasing values, merged into one sketch
+    std::vector<double> allValues;
+    RigQuantileSketch mergedSketch;
+    for (int ts = 0; ts < 10; ts++)
+    {
+        RigQuantileSketch timeStepSketch;
+        for (int i = 0; i < 10000; i++)
+        {
+            double value = ts * 1000.0 + (i * 37) % 10000;
+            timeStepSketch.add(value);
+            allValues.push_back(value);
+        }
+
+        mergedSketch.merge(timeStepSketch);
+    }
+
+    EXPECT_EQ(allValues.size(), mergedSketch.valueCount());
+
+    std::sort(allValues.begin(), allValues.end());
+
+    EXPECT_NEAR(0.1, rankOf(allValues, mergedSketch.quantile(0.1)), 0.02);
+    EXPECT_NEAR(0.9, rankOf(allValues, mergedSketch.quantile(0.9)), 0.02);
+}
@@ -0,0 +1,430 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include "RIStdInclude.h"
+#include "gtest/gtest.h"
+
+#include "RigReservoir.h"
+#include "RigReservoirCellResults.h"
+
+
+//==================================================================================================
+/// Reader returning the time step index as value for all cells, and counting the number of reads
+//==================================================================================================
+class RigTimeStepCountingReader : public RifReaderInterface
+{
+public:
+    RigTimeStepCountingReader(size_t valueCount) : m_valueCount(valueCount), m_readCount(0), m_valueScale(1.0) {}
+
+    virtual bool open(const QString& fileName, RigReservoir* reservoir)    { return true; }
+    virtual void close()                                                    {}
+    virtual bool staticResult(const QString& result, PorosityModelResultType matrixOrFracture, std::vector<double>* values) { return false; }
+
+    virtual bool dynamicResult(const QString& result, PorosityModelResultType matrixOrFracture, size_t stepIndex, std::vector<double>* values)
+    {
+        m_readCount++;
+        values->resize(m_valueCount, m_valueScale * static_cast<double>(stepIndex));
+        return true;
+    }
+
+    size_t m_valueCount;
+    size_t m_readCount;
+    double m_valueScale;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigReservoirCellResultsTest, LoadTimeStepsOnDemand)
+{
+    const size_t valueCount = 100;
+    const int timeStepCount = 10;
+
+    cvf::ref<RigReservoir> reservoir = new RigReservoir;
+    reservoir->mainGrid()->setGlobalMatrixModelActiveCellCount(valueCount);
+
+    cvf::ref<RigTimeStepCountingReader> reader = new RigTimeStepCountingReader(valueCount);
+
+    RigReservoirCellResults* results = reservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+    results->setReaderInterface(reader.p());
+
+    QList<QDateTime> dates;
+    for (int i = 0; i < timeStepCount; i++)
+    {
+        dates.push_back(QDateTime::currentDateTime().addDays(i));
+    }
+
+    size_t resultIndex = results->addEmptyScalarResult(RimDefines::DYNAMIC_NATIVE, "SWAT");
+    results->setTimeStepDates(resultIndex, dates);
+
+    // Room for three time steps
+    results->setFrameMemoryBudget(3 * valueCount * sizeof(double));
+
+    EXPECT_EQ(resultIndex, results->findOrLoadScalarResult(RimDefines::DYNAMIC_NATIVE, "SWAT"));
+    EXPECT_EQ(static_cast<size_t>(timeStepCount), results->timeStepCount(resultIndex));
+    EXPECT_EQ(1u, reader->m_readCount);
+
+    // Cell values are only available from loaded time steps
+    EXPECT_EQ(HUGE_VAL, results->cellScalarResult(5, resultIndex, 10));
+    EXPECT_EQ(1u, reader->m_readCount);
+
+    results->loadTimeStep(resultIndex, 5);
+    EXPECT_EQ(5.0, results->cellScalarResult(5, resultIndex, 10));
+    EXPECT_EQ(2u, reader->m_readCount);
+
+    for (int i = 0; i < timeStepCount; i++)
+    {
+        const std::vector<double>& values = results->cellScalarResults(resultIndex, i);
+        ASSERT_EQ(valueCount, values.size());
+        EXPECT_EQ(static_cast<double>(i), values[0]);
+    }
+
+    // Time step 5 was still loaded when iterating
+    EXPECT_EQ(static_cast<size_t>(timeStepCount) + 1, reader->m_readCount);
+
+    // The most recent time steps are kept, the old ones are read again
+    results->cellScalarResults(resultIndex, 9);
+    results->cellScalarResults(resultIndex, 8);
+    EXPECT_EQ(static_cast<size_t>(timeStepCount) + 1, reader->m_readCount);
+
+    results->cellScalarResults(resultIndex, 0);
+    EXPECT_EQ(static_cast<size_t>(timeStepCount) + 2, reader->m_readCount);
+
+    // Statistics sweep all the time steps within the budget
+    double min, max;
+    results->minMaxCellScalarValues(resultIndex, min, max);
+    EXPECT_EQ(0.0, min);
+    EXPECT_EQ(9.0, max);
+
+    // Full access loads the rest, and keeps all time steps in memory
+    std::vector< std::vector<double> >& frames = results->cellScalarResults(resultIndex);
+    for (int i = 0; i < timeStepCount; i++)
+    {
+        EXPECT_EQ(valueCount, frames[i].size());
+    }
+
+    size_t readCount = reader->m_readCount;
+    results->cellScalarResults(resultIndex, 1);
+    EXPECT_EQ(readCount, reader->m_readCount);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigReservoirCellResultsTest, ComputeSOILOnDemand)
+{
+    const size_t valueCount = 100;
+    const int timeStepCount = 10;
+
+    cvf::ref<RigReservoir> reservoir = new RigReservoir;
+    reservoir->mainGrid()->setGlobalMatrixModelActiveCellCount(valueCount);
+
+    // SWAT and SGAS are both 0.1 * time step index
+    cvf::ref<RigTimeStepCountingReader> reader = new RigTimeStepCountingReader(valueCount);
+    reader->m_valueScale = 0.1;
+
+    RigReservoirCellResults* results = reservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+    results->setReaderInterface(reader.p());
+
+    QList<QDateTime> dates;
+    for (int i = 0; i < timeStepCount; i++)
+    {
+        dates.push_back(QDateTime::currentDateTime().addDays(i));
+    }
+
+    results->setTimeStepDates(results->addEmptyScalarResult(RimDefines::DYNAMIC_NATIVE, "SWAT"), dates);
+    results->setTimeStepDates(results->addEmptyScalarResult(RimDefines::DYNAMIC_NATIVE, "SGAS"), dates);
+
+    // Room for three time steps
+    results->setFrameMemoryBudget(3 * valueCount * sizeof(double));
+
+    // Only the first time step of SWAT and SGAS is read when SOIL is added
+    results->loadOrComputeSOIL();
+    EXPECT_EQ(2u, reader->m_readCount);
+
+    size_t soilIndex = results->findScalarResultIndex(RimDefines::DYNAMIC_NATIVE, "SOIL");
+    ASSERT_NE(cvf::UNDEFINED_SIZE_T, soilIndex);
+    EXPECT_EQ(static_cast<size_t>(timeStepCount), results->timeStepCount(soilIndex));
+
+    const std::vector<double>& soilValues = results->cellScalarResults(soilIndex, 3);
+    ASSERT_EQ(valueCount, soilValues.size());
+    EXPECT_DOUBLE_EQ(0.4, soilValues[0]);
+    EXPECT_EQ(4u, reader->m_readCount);
+
+    // The range of all the time steps is taken from the time steps visited so far
+    RigStatistics visitedStatistics = results->visitedTimeStepsStatistics(soilIndex, 3);
+    EXPECT_DOUBLE_EQ(0.4, visitedStatistics.m_min);
+    EXPECT_DOUBLE_EQ(0.4, visitedStatistics.m_max);
+
+    visitedStatistics = results->visitedTimeStepsStatistics(soilIndex, 0);
+    EXPECT_DOUBLE_EQ(0.4, visitedStatistics.m_min);
+    EXPECT_DOUBLE_EQ(1.0, visitedStatistics.m_max);
+
+    // SOIL time steps are unloaded and computed again like any time step read on demand
+    for (int i = 0; i < timeStepCount; i++)
+    {
+        results->loadTimeStep(soilIndex, i);
+        EXPECT_DOUBLE_EQ(1.0 - 0.2 * i, results->cellScalarResult(i, soilIndex, 0));
+    }
+
+    double min, max;
+    results->minMaxCellScalarValues(soilIndex, min, max);
+    EXPECT_NEAR(-0.8, min, 1e-12);
+    EXPECT_DOUBLE_EQ(1.0, max);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigReservoirCellResultsTest, StatisticsIgnoreUndefinedValues)
+{
+    std::vector<double> values;
+    for (int i = 0; i < 10000; i++)
+    {
+        values.push_back(i % 2 ? HUGE_VAL : static_cast<double>(i % 100));
+    }
+
+    RigStatistics stats;
+    stats.addData(values);
+
+    EXPECT_EQ(5000u, stats.m_valueCount);
+    EXPECT_EQ(0.0, stats.m_min);
+    EXPECT_EQ(98.0, stats.m_max);
+    EXPECT_DOUBLE_EQ(49.0, stats.mean());
+
+    RigStatistics merged;
+    merged.add(stats);
+    merged.add(stats);
+    EXPECT_EQ(10000u, merged.m_valueCount);
+    EXPECT_DOUBLE_EQ(49.0, merged.mean());
+
+    std::vector<size_t> histogram;
+    RigHistogramCalculator histCalc(stats.m_min, stats.m_max, 50, &histogram);
+    histCalc.addData(values);
+
+    size_t observationCount = 0;
+    for (size_t i = 0; i < histogram.size(); i++)
+    {
+        EXPECT_EQ(100u, histogram[i]);
+        observationCount += histogram[i];
+    }
+    EXPECT_EQ(5000u, observationCount);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigReservoirCellResultsTest, SinglePrecisionStorage)
+{
+    const size_t valueCount = 100;
+    const int timeStepCount = 10;
+
+    cvf::ref<RigReservoir> reservoir = new RigReservoir;
+    reservoir->mainGrid()->setGlobalMatrixModelActiveCellCount(valueCount);
+
+    cvf::ref<RigTimeStepCountingReader> reader = new RigTimeStepCountingReader(valueCount);
+    reader->m_valueScale = 0.5;
+
+    RigReservoirCellResults* results = reservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+    results->setReaderInterface(reader.p());
+
+    QList<QDateTime> dates;
+    for (int i = 0; i < timeStepCount; i++)
+    {
+        dates.push_back(QDateTime::currentDateTime().addDays(i));
+    }
+
+    size_t resultIndex = results->addEmptyScalarResult(RimDefines::DYNAMIC_NATIVE, "SWAT");
+    results->setTimeStepDates(resultIndex, dates);
+
+    // Room for three double precision time steps, or six single precision ones
+    results->setFrameMemoryBudget(3 * valueCount * sizeof(double));
+
+    EXPECT_EQ(resultIndex, results->findOrLoadScalarResult(RimDefines::DYNAMIC_NATIVE, "SWAT"));
+    EXPECT_TRUE(results->isSinglePrecision(resultIndex, 0));
+
+    for (int i = 0; i < 6; i++)
+    {
+        results->loadTimeStep(resultIndex, i);
+        EXPECT_EQ(0.5 * i, results->cellScalarResult(i, resultIndex, 10));
+    }
+    EXPECT_EQ(6u, reader->m_readCount);
+
+    results->loadTimeStep(resultIndex, 0);
+    EXPECT_EQ(6u, reader->m_readCount);
+
+    double min, max;
+    results->minMaxCellScalarValues(resultIndex, min, max);
+    EXPECT_EQ(0.0, min);
+    EXPECT_EQ(4.5, max);
+    EXPECT_TRUE(results->isSinglePrecision(resultIndex, 3));
+
+    // Access as doubles converts only that time step
+    const std::vector<double>& values = results->cellScalarResults(resultIndex, 3);
+    EXPECT_FALSE(results->isSinglePrecision(resultIndex, 3));
+    EXPECT_TRUE(results->isSinglePrecision(resultIndex, 0));
+    ASSERT_EQ(valueCount, values.size());
+    EXPECT_EQ(1.5, values[0]);
+
+    // The single precision values of a pinned time step stay valid when it is converted
+    results->loadTimeStep(resultIndex, 0);
+    results->pinFrame(resultIndex, 0);
+    const std::vector<float>& singlePrecisionValues = results->singlePrecisionCellScalarResults(resultIndex, 0);
+    results->cellScalarResults(resultIndex, 0);
+    EXPECT_FALSE(results->isSinglePrecision(resultIndex, 0));
+    ASSERT_EQ(valueCount, singlePrecisionValues.size());
+    EXPECT_EQ(0.0f, singlePrecisionValues[10]);
+    results->unpinFrame(resultIndex, 0);
+    EXPECT_TRUE(singlePrecisionValues.empty());
+
+    // Values not representable as float are kept in double precision
+    reader->m_valueScale = 0.1;
+    size_t preciseResultIndex = results->addEmptyScalarResult(RimDefines::DYNAMIC_NATIVE, "SGAS");
+    results->setTimeStepDates(preciseResultIndex, dates);
+    results->findOrLoadScalarResult(RimDefines::DYNAMIC_NATIVE, "SGAS");
+
+    results->loadTimeStep(preciseResultIndex, 0);
+    EXPECT_EQ(0.0, results->cellScalarResult(0, preciseResultIndex, 0));
+    EXPECT_TRUE(results->isSinglePrecision(preciseResultIndex, 0));
+
+    results->loadTimeStep(preciseResultIndex, 1);
+    EXPECT_EQ(0.1, results->cellScalarResult(1, preciseResultIndex, 0));
+    EXPECT_FALSE(results->isSinglePrecision(preciseResultIndex, 1));
+    EXPECT_TRUE(results->isSinglePrecision(preciseResultIndex, 0));
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigReservoirCellResultsTest, ReplaceResults)
+{
+    const size_t valueCount = 100;
+    const int timeStepCount = 10;
+
+    cvf::ref<RigReservoir> reservoir = new RigReservoir;
+    reservoir->mainGrid()->setGlobalMatrixModelActiveCellCount(valueCount);
+
+    cvf::ref<RigTimeStepCountingReader> reader = new RigTimeStepCountingReader(valueCount);
+
+    RigReservoirCellResults* results = reservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+    results->setReaderInterface(reader.p());
+
+    QList<QDateTime> dates;
+    for (int i = 0; i < timeStepCount; i++)
+    {
+        dates.push_back(QDateTime::currentDateTime().addDays(i));
+    }
+
+    size_t resultIndex = results->addEmptyScalarResult(RimDefines::DYNAMIC_NATIVE, "SWAT");
+    results->setTimeStepDates(resultIndex, dates);
+    results->findOrLoadScalarResult(RimDefines::DYNAMIC_NATIVE, "SWAT");
+
+    double min, max;
+    results->minMaxCellScalarValues(resultIndex, min, max);
+    EXPECT_EQ(9.0, max);
+
+    // A data access object referencing the single precision values of timestep 3
+    results->loadTimeStep(resultIndex, 3);
+    ASSERT_TRUE(results->isSinglePrecision(resultIndex, 3));
+    results->pinFrame(resultIndex, 3);
+    const std::vector<float>& pinnedValues = results->singlePrecisionCellScalarResults(resultIndex, 3);
+
+    size_t readCount = reader->m_readCount;
+
+    std::vector< std::vector<double> > values(2, std::vector<double>(valueCount, 20.0));
+    results->replaceCellScalarResults(resultIndex, &values);
+
+    // The timesteps read from file are released, not read again
+    EXPECT_EQ(readCount, reader->m_readCount);
+    EXPECT_FALSE(results->isSinglePrecision(resultIndex, 0));
+    EXPECT_EQ(2u, results->timeStepCount(resultIndex));
+    EXPECT_EQ(20.0, results->cellScalarResults(resultIndex, 1)[0]);
+
+    // The pinned values are kept until unpinned
+    ASSERT_EQ(valueCount, pinnedValues.size());
+    EXPECT_EQ(3.0f, pinnedValues[0]);
+
+    results->unpinFrame(resultIndex, 3);
+    EXPECT_TRUE(pinnedValues.empty());
+
+    results->minMaxCellScalarValues(resultIndex, min, max);
+    EXPECT_EQ(20.0, min);
+    EXPECT_EQ(20.0, max);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigReservoirCellResultsTest, PinnedTimeStepsAreKept)
+{
+    const size_t valueCount = 100;
+    const int timeStepCount = 10;
+
+    cvf::ref<RigReservoir> reservoir = new RigReservoir;
+    reservoir->mainGrid()->setGlobalMatrixModelActiveCellCount(valueCount);
+
+    cvf::ref<RigTimeStepCountingReader> reader = new RigTimeStepCountingReader(valueCount);
+
+    RigReservoirCellResults* results = reservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+    results->setReaderInterface(reader.p());
+
+    QList<QDateTime> dates;
+    for (int i = 0; i < timeStepCount; i++)
+    {
+        dates.push_back(QDateTime::currentDateTime().addDays(i));
+    }
+
+    size_t resultIndex = results->addEmptyScalarResult(RimDefines::DYNAMIC_NATIVE, "SWAT");
+    results->setTimeStepDates(resultIndex, dates);
+
+    // Room for two time steps. The values are stored in single precision
+    results->setFrameMemoryBudget(2 * valueCount * sizeof(float));
+    results->findOrLoadScalarResult(RimDefines::DYNAMIC_NATIVE, "SWAT");
+
+    results->loadTimeStep(resultIndex, 0);
+    results->pinFrame(resultIndex, 0);
+
+    int i;
+    for (i = 1; i < timeStepCount; i++)
+    {
+        results->loadTimeStep(resultIndex, i);
+    }
+
+    // The pinned time step is still there
+    EXPECT_EQ(0.0, results->cellScalarResult(0, resultIndex, 10));
+    EXPECT_EQ(HUGE_VAL, results->cellScalarResult(1, resultIndex, 10));
+
+    size_t readCount = reader->m_readCount;
+    results->loadTimeStep(resultIndex, 0);
+    EXPECT_EQ(readCount, reader->m_readCount);
+
+    // Unpinning enforces the budget again, keeping the most recently used time steps
+    results->loadTimeStep(resultIndex, 9);
+    results->unpinFrame(resultIndex, 0);
+    results->loadTimeStep(resultIndex, 8);
+    EXPECT_EQ(HUGE_VAL, results->cellScalarResult(0, resultIndex, 10));
+
+    // Explicit unloading keeps pinned time steps
+    results->pinFrame(resultIndex, 8);
+    results->unloadTimeStep(resultIndex, 8);
+    results->unloadTimeStep(resultIndex, 9);
+    EXPECT_TRUE(results->isTimeStepLoaded(resultIndex, 8));
+    EXPECT_FALSE(results->isTimeStepLoaded(resultIndex, 9));
+    results->unpinFrame(resultIndex, 8);
+}
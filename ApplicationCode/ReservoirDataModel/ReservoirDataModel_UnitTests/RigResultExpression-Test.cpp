@@ -0,0 +1,126 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include "RIStdInclude.h"
+#include "gtest/gtest.h"
+
+#include "RigReservoir.h"
+#include "RigReservoirCellResults.h"
+#include "RigResultExpression.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/// Add a generated result with the given values for each timestep
+//--------------------------------------------------------------------------------------------------
+static size_t addTestResult(RigReservoirCellResults* results, const QString& name, const std::vector< std::vector<double> >& values)
+{
+    size_t resultIndex = results->addEmptyScalarResult(RimDefines::GENERATED, name);
+    results->cellScalarResults(resultIndex) = values;
+
+    QList<QDateTime> dates;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        dates.push_back(QDateTime::currentDateTime().addDays(static_cast<int>(i)));
+    }
+    results->setTimeStepDates(resultIndex, dates);
+
+    return resultIndex;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigResultExpressionTest, ParseErrors)
+{
+    RigResultExpression expression;
+
+    EXPECT_TRUE(expression.parse("SOIL*PORV + 2^-1"));
+    EXPECT_TRUE(expression.parse("if(SWAT >= 0.5, tmax(SWAT), SWAT[-1])"));
+
+    EXPECT_FALSE(expression.parse("SOIL*"));
+    EXPECT_FALSE(expression.errorMessage().isEmpty());
+
+    EXPECT_FALSE(expression.parse("(SOIL"));
+    EXPECT_FALSE(expression.parse("SOIL[x]"));
+    EXPECT_FALSE(expression.parse("unknown(SOIL)"));
+    EXPECT_FALSE(expression.parse("if(SOIL, 1)"));
+    EXPECT_FALSE(expression.parse("SOIL SWAT"));
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+TEST(RigResultExpressionTest, ComputeResult)
+{
+    cvf::ref<RigReservoir> reservoir = new RigReservoir;
+    RigReservoirCellResults* results = reservoir->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+
+    // Three cells, three timesteps
+    std::vector< std::vector<double> > swat(3);
+    swat[0].push_back(0.1); swat[0].push_back(0.2); swat[0].push_back(HUGE_VAL);
+    swat[1].push_back(0.3); swat[1].push_back(0.6); swat[1].push_back(HUGE_VAL);
+    swat[2].push_back(0.5); swat[2].push_back(0.4); swat[2].push_back(0.9);
+    addTestResult(results, "SWAT", swat);
+
+    std::vector< std::vector<double> > poro(1);
+    poro[0].push_back(0.2); poro[0].push_back(0.25); poro[0].push_back(0.3);
+    addTestResult(results, "PORO", poro);
+
+    RigResultExpression expression;
+
+    // Static results are used at all timesteps, and undefined values stay undefined
+    ASSERT_TRUE(expression.parse("(1 - SWAT)*PORO*2"));
+    size_t resultIndex = expression.computeResult(results, "HCPV");
+    ASSERT_NE(cvf::UNDEFINED_SIZE_T, resultIndex);
+    ASSERT_EQ(3u, results->timeStepCount(resultIndex));
+    EXPECT_DOUBLE_EQ(0.9*0.2*2, results->cellScalarResults(resultIndex, 0)[0]);
+    EXPECT_DOUBLE_EQ(0.4*0.25*2, results->cellScalarResults(resultIndex, 1)[1]);
+    EXPECT_EQ(HUGE_VAL, results->cellScalarResults(resultIndex, 1)[2]);
+    EXPECT_DOUBLE_EQ(0.1*0.3*2, results->cellScalarResults(resultIndex, 2)[2]);
+
+    // Timestep offsets are undefined outside the timesteps
+    ASSERT_TRUE(expression.parse("SWAT - SWAT[-1]"));
+    resultIndex = expression.computeResult(results, "DSWAT");
+    ASSERT_NE(cvf::UNDEFINED_SIZE_T, resultIndex);
+    EXPECT_EQ(HUGE_VAL, results->cellScalarResults(resultIndex, 0)[0]);
+    EXPECT_DOUBLE_EQ(0.2, results->cellScalarResults(resultIndex, 1)[0]);
+    EXPECT_DOUBLE_EQ(-0.2, results->cellScalarResults(resultIndex, 2)[1]);
+
+    // Reductions ignore undefined values
+    ASSERT_TRUE(expression.parse("tmax(SWAT) + max(SWAT)"));
+    resultIndex = expression.computeResult(results, "SWAT_MAX");
+    ASSERT_NE(cvf::UNDEFINED_SIZE_T, resultIndex);
+    EXPECT_DOUBLE_EQ(0.5 + 0.2, results->cellScalarResults(resultIndex, 0)[0]);
+    EXPECT_DOUBLE_EQ(0.9 + 0.6, results->cellScalarResults(resultIndex, 1)[2]);
+    EXPECT_DOUBLE_EQ(0.6 + 0.9, results->cellScalarResults(resultIndex, 2)[1]);
+
+    ASSERT_TRUE(expression.parse("if(SWAT > 0.35, 1, 0) + -2^2"));
+    resultIndex = expression.computeResult(results, "SWAT_MAX");
+    ASSERT_NE(cvf::UNDEFINED_SIZE_T, resultIndex);
+    EXPECT_DOUBLE_EQ(-4.0, results->cellScalarResults(resultIndex, 1)[0]);
+    EXPECT_DOUBLE_EQ(-3.0, results->cellScalarResults(resultIndex, 1)[1]);
+    EXPECT_EQ(HUGE_VAL, results->cellScalarResults(resultIndex, 1)[2]);
+
+    // Results that are not found, or expressions without results, can not be computed
+    ASSERT_TRUE(expression.parse("SGAS + 1"));
+    EXPECT_EQ(cvf::UNDEFINED_SIZE_T, expression.computeResult(results, "X"));
+    EXPECT_FALSE(expression.errorMessage().isEmpty());
+
+    ASSERT_TRUE(expression.parse("2*3"));
+    EXPECT_EQ(cvf::UNDEFINED_SIZE_T, expression.computeResult(results, "X"));
+}
@@ -0,0 +1,226 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include "RigBoundingBoxTree.h"
+
+#include <algorithm>
+
+namespace
+{
+    const size_t maxLeafBoxCount = 16;
+
+    //--------------------------------------------------------------------------------------------------
+    /// Orders box indices by the coordinate of the box centers along one axis
+    //--------------------------------------------------------------------------------------------------
+    class CenterCoordinateLess
+    {
+    public:
+        CenterCoordinateLess(const std::vector<cvf::Vec3d>& centers, int axis) : m_centers(&centers), m_axis(axis) {}
+
+        bool operator()(size_t a, size_t b) const
+        {
+            return (*m_centers)[a][m_axis] < (*m_centers)[b][m_axis];
+        }
+
+    private:
+        const std::vector<cvf::Vec3d>*  m_centers;
+        int                             m_axis;
+    };
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RigBoundingBoxTree::RigBoundingBoxTree()
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Build the tree from the boxes and the corresponding ids. Invalid boxes are skipped.
+/// The boxes are split at the median of the box centers along the longest axis, until the
+/// leaves contain at most a few boxes.
+//--------------------------------------------------------------------------------------------------
+void RigBoundingBoxTree::build(const std::vector<cvf::BoundingBox>& boxes, const std::vector<size_t>& ids)
+{
+    CVF_ASSERT(boxes.size() == ids.size());
+
+    clear();
+
+    std::vector<size_t> boxIndices;
+    boxIndices.reserve(boxes.size());
+
+    std::vector<cvf::Vec3d> centers(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        if (!boxes[i].isValid()) continue;
+
+        centers[i] = boxes[i].center();
+        boxIndices.push_back(i);
+    }
+
+    if (boxIndices.empty()) return;
+
+    m_nodes.reserve(2 * (boxIndices.size() / maxLeafBoxCount + 1));
+    m_nodes.push_back(Node());
+
+    buildNode(0, 0, boxIndices.size(), boxes, centers, &boxIndices);
+
+    m_ids.resize(boxIndices.size());
+    for (size_t i = 0; i < boxIndices.size(); ++i)
+    {
+        m_ids[i] = ids[boxIndices[i]];
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigBoundingBoxTree::buildNode(size_t nodeIndex, size_t begin, size_t end, const std::vector<cvf::BoundingBox>& boxes, const std::vector<cvf::Vec3d>& centers, std::vector<size_t>* boxIndices)
+{
+    cvf::BoundingBox nodeBoundingBox;
+    cvf::BoundingBox centerBoundingBox;
+    for (size_t i = begin; i < end; ++i)
+    {
+        nodeBoundingBox.add(boxes[(*boxIndices)[i]]);
+        centerBoundingBox.add(centers[(*boxIndices)[i]]);
+    }
+
+    // Nodes are referenced by index, as adding children might reallocate the node array
+    m_nodes[nodeIndex].m_boundingBox = nodeBoundingBox;
+
+    cvf::Vec3d extent = centerBoundingBox.extent();
+    int splitAxis = 0;
+    if (extent.y() > extent[splitAxis]) splitAxis = 1;
+    if (extent.z() > extent[splitAxis]) splitAxis = 2;
+
+    if (end - begin <= maxLeafBoxCount)
+    {
+        m_nodes[nodeIndex].m_first = begin;
+        m_nodes[nodeIndex].m_count = end - begin;
+        return;
+    }
+
+    // Split at the median center along the longest axis. When all the centers coincide there is no
+    // axis to split along, and the boxes are split by count in their current order
+    size_t middle = begin + (end - begin) / 2;
+    if (extent[splitAxis] > 0.0)
+    {
+        std::nth_element(boxIndices->begin() + begin, boxIndices->begin() + middle, boxIndices->begin() + end, CenterCoordinateLess(centers, splitAxis));
+    }
+
+    size_t firstChild = m_nodes.size();
+    m_nodes.push_back(Node());
+    m_nodes.push_back(Node());
+
+    m_nodes[nodeIndex].m_first = firstChild;
+    m_nodes[nodeIndex].m_count = 0;
+
+    buildNode(firstChild, begin, middle, boxes, centers, boxIndices);
+    buildNode(firstChild + 1, middle, end, boxes, centers, boxIndices);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigBoundingBoxTree::clear()
+{
+    m_nodes.clear();
+    m_ids.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Bounding box of all the boxes in the tree
+//--------------------------------------------------------------------------------------------------
+cvf::BoundingBox RigBoundingBoxTree::boundingBox() const
+{
+    if (m_nodes.empty()) return cvf::BoundingBox();
+
+    return m_nodes[0].m_boundingBox;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Append the ids of the leaves intersecting the given box
+//--------------------------------------------------------------------------------------------------
+void RigBoundingBoxTree::findIntersectionCandidates(const cvf::BoundingBox& box, std::vector<size_t>* ids) const
+{
+    CVF_ASSERT(ids);
+
+    if (m_nodes.empty() || !box.isValid()) return;
+
+    std::vector<size_t> nodeStack;
+    nodeStack.push_back(0);
+
+    while (!nodeStack.empty())
+    {
+        const Node& node = m_nodes[nodeStack.back()];
+        nodeStack.pop_back();
+
+        if (!node.m_boundingBox.intersects(box)) continue;
+
+        if (node.m_count > 0)
+        {
+            ids->insert(ids->end(), m_ids.begin() + node.m_first, m_ids.begin() + node.m_first + node.m_count);
+        }
+        else
+        {
+            nodeStack.push_back(node.m_first);
+            nodeStack.push_back(node.m_first + 1);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Append the ids of the leaves containing the given point
+//--------------------------------------------------------------------------------------------------
+void RigBoundingBoxTree::findIntersectionCandidates(const cvf::Vec3d& point, std::vector<size_t>* ids) const
+{
+    cvf::BoundingBox pointBox(point, point);
+
+    findIntersectionCandidates(pointBox, ids);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Append the ids of the leaves hit by the given ray
+//--------------------------------------------------------------------------------------------------
+void RigBoundingBoxTree::findIntersectionCandidates(const cvf::Ray& ray, std::vector<size_t>* ids) const
+{
+    CVF_ASSERT(ids);
+
+    if (m_nodes.empty()) return;
+
+    std::vector<size_t> nodeStack;
+    nodeStack.push_back(0);
+
+    while (!nodeStack.empty())
+    {
+        const Node& node = m_nodes[nodeStack.back()];
+        nodeStack.pop_back();
+
+        if (!ray.boxIntersect(node.m_boundingBox)) continue;
+
+        if (node.m_count > 0)
+        {
+            ids->insert(ids->end(), m_ids.begin() + node.m_first, m_ids.begin() + node.m_first + node.m_count);
+        }
+        else
+        {
+            nodeStack.push_back(node.m_first);
+            nodeStack.push_back(node.m_first + 1);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "cvfBase.h"
+#include "cvfObject.h"
+#include "cvfBoundingBox.h"
+#include "cvfRay.h"
+
+#include <vector>
+
+//==================================================================================================
+/// Bounding volume hierarchy over a set of axis aligned bounding boxes, each with an id.
+/// Searches for the boxes intersecting a box or containing a point visit O(log n) nodes for 
+/// well distributed boxes, and searches along a ray only visit the nodes the ray passes through.
+/// The individual boxes are not stored, so the searches report all the ids in each intersecting 
+/// leaf, and the caller must do the exact test.
+//==================================================================================================
+class RigBoundingBoxTree : public cvf::Object
+{
+public:
+    RigBoundingBoxTree();
+
+    void                build(const std::vector<cvf::BoundingBox>& boxes, const std::vector<size_t>& ids);
+    void                clear();
+
+    size_t              boxCount() const    { return m_ids.size(); }
+    cvf::BoundingBox    boundingBox() const;
+
+    void                findIntersectionCandidates(const cvf::BoundingBox& box, std::vector<size_t>* ids) const;
+    void                findIntersectionCandidates(const cvf::Vec3d& point, std::vector<size_t>* ids) const;
+    void                findIntersectionCandidates(const cvf::Ray& ray, std::vector<size_t>* ids) const;
+
+private:
+    void                buildNode(size_t nodeIndex, size_t begin, size_t end, const std::vector<cvf::BoundingBox>& boxes, const std::vector<cvf::Vec3d>& centers, std::vector<size_t>* boxIndices);
+
+private:
+    struct Node
+    {
+        Node() : m_first(0), m_count(0) {}
+
+        cvf::BoundingBox    m_boundingBox;
+        size_t              m_first;        ///< First position in m_ids for leaf nodes, index of the first of two children otherwise
+        size_t              m_count;        ///< Number of ids in leaf nodes. Zero for inner nodes
+    };
+
+    std::vector<Node>       m_nodes;        ///< Node 0 is the root
+    std::vector<size_t>     m_ids;          ///< Box ids sorted so each leaf references a contiguous range
+};
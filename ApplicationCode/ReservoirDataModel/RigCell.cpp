@@ -21,38 +21,31 @@
 #include "RigCell.h"
 #include "RigMainGrid.h"
 #include "cvfPlane.h"
-
-static size_t undefinedCornersArray[8] = {cvf::UNDEFINED_SIZE_T,
-                                          cvf::UNDEFINED_SIZE_T,
-                                          cvf::UNDEFINED_SIZE_T,
-                                          cvf::UNDEFINED_SIZE_T,
-                                          cvf::UNDEFINED_SIZE_T,
-                                          cvf::UNDEFINED_SIZE_T,
-                                          cvf::UNDEFINED_SIZE_T,
-                                          cvf::UNDEFINED_SIZE_T };
+#include "cvfBoundingBox.h"
+
+static cvf::uint undefinedCornersArray[8] = {cvf::UNDEFINED_UINT,
+                                             cvf::UNDEFINED_UINT,
+                                             cvf::UNDEFINED_UINT,
+                                             cvf::UNDEFINED_UINT,
+                                             cvf::UNDEFINED_UINT,
+                                             cvf::UNDEFINED_UINT,
+                                             cvf::UNDEFINED_UINT,
+                                             cvf::UNDEFINED_UINT };
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
 RigCell::RigCell() : 
-    m_parentCellIndex(cvf::UNDEFINED_SIZE_T),
-    m_mainGridCellIndex(cvf::UNDEFINED_SIZE_T),
-    m_subGrid(NULL),
     m_hostGrid(NULL),
-    m_isInvalid(false),
-    m_isWellCell(false),
-    m_activeIndexInMatrixModel(cvf::UNDEFINED_SIZE_T),
-    m_activeIndexInFractureModel(cvf::UNDEFINED_SIZE_T),
-    m_cellIndex(cvf::UNDEFINED_SIZE_T),
-    m_isInCoarseCell(false)
+    m_subGrid(NULL),
+    m_cellIndex(cvf::UNDEFINED_UINT),
+    m_parentCellIndex(cvf::UNDEFINED_UINT),
+    m_mainGridCellIndex(cvf::UNDEFINED_UINT),
+    m_activeIndexInMatrixModel(cvf::UNDEFINED_UINT),
+    m_activeIndexInFractureModel(cvf::UNDEFINED_UINT),
+    m_flags(0),
+    m_cellFaceFaults(0)
 {
-    memcpy(m_cornerIndices.m_array, undefinedCornersArray, 8*sizeof(size_t));
-
-    m_cellFaceFaults[0] = false;
-    m_cellFaceFaults[1] = false;
-    m_cellFaceFaults[2] = false;
-    m_cellFaceFaults[3] = false;
-    m_cellFaceFaults[4] = false;
-    m_cellFaceFaults[5] = false;
+    memcpy(m_cornerIndices.m_array, undefinedCornersArray, 8*sizeof(cvf::uint));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -292,3 +285,81 @@ bool RigCell::firstIntersectionPoint(const cvf::Ray& ray, cvf::Vec3d* intersecti
     return false;
 }
 
+//--------------------------------------------------------------------------------------------------
+/// Returns whether the point is inside the tetrahedron a, b, c, d. Points on the boundary are inside.
+/// The coordinates are made relative to the point to keep the precision for large UTM coordinates.
+//--------------------------------------------------------------------------------------------------
+static bool isPointInTetrahedron(const cvf::Vec3d& point, const cvf::Vec3d& a, const cvf::Vec3d& b, const cvf::Vec3d& c, const cvf::Vec3d& d)
+{
+    cvf::Vec3d pa = a - point;
+    cvf::Vec3d pb = b - point;
+    cvf::Vec3d pc = c - point;
+    cvf::Vec3d pd = d - point;
+
+    double volume = (pb - pa) * ((pc - pa) ^ (pd - pa));
+    if (volume == 0.0) return false;
+
+    // Barycentric coordinates of the point, scaled by the volume
+    double tolerance = -1.0e-9 * cvf::Math::abs(volume);
+    double sign = volume > 0.0 ? 1.0 : -1.0;
+
+    if (sign * (pb * (pc ^ pd)) < tolerance) return false;
+    if (sign * (pa * (pd ^ pc)) < tolerance) return false;
+    if (sign * (pa * (pb ^ pd)) < tolerance) return false;
+    if (sign * (pa * (pc ^ pb)) < tolerance) return false;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Test whether the point is inside the cell. The cell is split into tetrahedrons from the cell 
+/// center to the same face triangles as used by firstIntersectionPoint(), so neighbour cells 
+/// sharing a face leave no gaps between them.
+//--------------------------------------------------------------------------------------------------
+bool RigCell::containsPoint(const cvf::Vec3d& point) const
+{
+    const std::vector<cvf::Vec3d>& nodes = m_hostGrid->mainGrid()->nodes();
+
+    cvf::Vec3d cellCenter = center();
+
+    cvf::ubyte faceVertexIndices[4];
+    int face;
+    for (face = 0; face < 6 ; ++face)
+    {
+        cvf::StructGridInterface::cellFaceVertexIndices(static_cast<cvf::StructGridInterface::FaceType>(face), faceVertexIndices);
+        cvf::Vec3d faceCenter = this->faceCenter(static_cast<cvf::StructGridInterface::FaceType>(face));
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            size_t next = i < 3 ? i+1 : 0;
+            if (isPointInTetrahedron(point, 
+                                     cellCenter, 
+                                     nodes[m_cornerIndices[faceVertexIndices[i]]], 
+                                     nodes[m_cornerIndices[faceVertexIndices[next]]], 
+                                     faceCenter))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+cvf::BoundingBox RigCell::boundingBox() const
+{
+    cvf::BoundingBox bb;
+
+    const std::vector<cvf::Vec3d>& nodes = m_hostGrid->mainGrid()->nodes();
+
+    size_t i;
+    for (i = 0; i < 8; i++)
+    {
+        bb.add(nodes[m_cornerIndices[i]]);
+    }
+
+    return bb;
+}
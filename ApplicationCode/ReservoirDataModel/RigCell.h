@@ -24,6 +24,7 @@
 namespace cvf
 {
     class Ray;
+    class BoundingBox;
 }
 
 
@@ -34,25 +35,25 @@ public:
     RigCell();
     ~RigCell(); // Not virtual, to save space. Do not inherit from this class
 
-    caf::SizeTArray8&       cornerIndices()                                     { return m_cornerIndices;}
-    const caf::SizeTArray8& cornerIndices() const                               { return m_cornerIndices;}
+    caf::UIntArray8&        cornerIndices()                                     { return m_cornerIndices;}
+    const caf::UIntArray8&  cornerIndices() const                               { return m_cornerIndices;}
 
-    bool                    isActiveInMatrixModel() const                       { return m_activeIndexInMatrixModel != cvf::UNDEFINED_SIZE_T; }
-    size_t                  activeIndexInMatrixModel() const                    { return m_activeIndexInMatrixModel; }
-    void                    setActiveIndexInMatrixModel(size_t val)             { m_activeIndexInMatrixModel = val; }
+    bool                    isActiveInMatrixModel() const                       { return m_activeIndexInMatrixModel != cvf::UNDEFINED_UINT; }
+    size_t                  activeIndexInMatrixModel() const                    { return toSizeT(m_activeIndexInMatrixModel); }
+    void                    setActiveIndexInMatrixModel(size_t val)             { m_activeIndexInMatrixModel = toUInt(val); }
 
-    bool                    isActiveInFractureModel() const                     { return m_activeIndexInFractureModel != cvf::UNDEFINED_SIZE_T; }
-    size_t                  activeIndexInFractureModel() const                  { return m_activeIndexInFractureModel; }
-    void                    setActiveIndexInFractureModel(size_t val)           { m_activeIndexInFractureModel = val; }
+    bool                    isActiveInFractureModel() const                     { return m_activeIndexInFractureModel != cvf::UNDEFINED_UINT; }
+    size_t                  activeIndexInFractureModel() const                  { return toSizeT(m_activeIndexInFractureModel); }
+    void                    setActiveIndexInFractureModel(size_t val)           { m_activeIndexInFractureModel = toUInt(val); }
 
-    bool                    isInvalid() const                                   { return m_isInvalid; }
-    void                    setInvalid( bool val )                              { m_isInvalid = val; }
+    bool                    isInvalid() const                                   { return (m_flags & INVALID) != 0; }
+    void                    setInvalid( bool val )                              { setFlag(INVALID, val); }
 
-    bool                    isWellCell() const                                  { return m_isWellCell; }
-    void                    setAsWellCell(bool isWellCell)                      { m_isWellCell = isWellCell; }
+    bool                    isWellCell() const                                  { return (m_flags & WELL_CELL) != 0; }
+    void                    setAsWellCell(bool isWellCell)                      { setFlag(WELL_CELL, isWellCell); }
 
-    size_t                  cellIndex() const                                   { return m_cellIndex; }
-    void                    setCellIndex(size_t val)                            { m_cellIndex = val; }
+    size_t                  cellIndex() const                                   { return toSizeT(m_cellIndex); }
+    void                    setCellIndex(size_t val)                            { m_cellIndex = toUInt(val); }
 
 
     RigLocalGrid*           subGrid() const                                     { return m_subGrid; }
@@ -61,39 +62,53 @@ public:
     RigGridBase*            hostGrid() const                                    { return m_hostGrid; }
     void                    setHostGrid(RigGridBase* hostGrid)                  { m_hostGrid = hostGrid; }
 
-    size_t                  parentCellIndex() const                             { return m_parentCellIndex; }
-    void                    setParentCellIndex(size_t parentCellIndex)          { m_parentCellIndex = parentCellIndex; }
-    size_t                  mainGridCellIndex() const                           { return m_mainGridCellIndex; }
-    void                    setMainGridCellIndex(size_t mainGridCellContainingThisCell) { m_mainGridCellIndex = mainGridCellContainingThisCell; }
+    size_t                  parentCellIndex() const                             { return toSizeT(m_parentCellIndex); }
+    void                    setParentCellIndex(size_t parentCellIndex)          { m_parentCellIndex = toUInt(parentCellIndex); }
+    size_t                  mainGridCellIndex() const                           { return toSizeT(m_mainGridCellIndex); }
+    void                    setMainGridCellIndex(size_t mainGridCellContainingThisCell) { m_mainGridCellIndex = toUInt(mainGridCellContainingThisCell); }
 
-    bool                    isInCoarseCell() const                              { return m_isInCoarseCell; }
-    void                    setInCoarseCell(bool isInCoarseCell)                { m_isInCoarseCell = isInCoarseCell; }
+    bool                    isInCoarseCell() const                              { return (m_flags & IN_COARSE_CELL) != 0; }
+    void                    setInCoarseCell(bool isInCoarseCell)                { setFlag(IN_COARSE_CELL, isInCoarseCell); }
 
-    void                    setCellFaceFault(cvf::StructGridInterface::FaceType face)       { m_cellFaceFaults[face] = true; }
-    bool                    isCellFaceFault(cvf::StructGridInterface::FaceType face) const  { return m_cellFaceFaults[face]; }
+    void                    setCellFaceFault(cvf::StructGridInterface::FaceType face)       { m_cellFaceFaults |= (1 << face); }
+    bool                    isCellFaceFault(cvf::StructGridInterface::FaceType face) const  { return (m_cellFaceFaults & (1 << face)) != 0; }
+    cvf::ubyte              cellFaceFaults() const                                          { return m_cellFaceFaults; }
 
     cvf::Vec3d              center() const;
     cvf::Vec3d              faceCenter(cvf::StructGridInterface::FaceType face) const;
     bool                    firstIntersectionPoint(const cvf::Ray& ray, cvf::Vec3d* intersectionPoint) const;
+    bool                    containsPoint(const cvf::Vec3d& point) const;
+    cvf::BoundingBox        boundingBox() const;
     bool                    isLongPyramidCell(double maxHeightFactor = 5, double nodeNearTolerance = 1e-3 ) const;
 private:
-    caf::SizeTArray8        m_cornerIndices;
+    enum CellFlags
+    {
+        INVALID         = 0x01,
+        WELL_CELL       = 0x02,
+        IN_COARSE_CELL  = 0x04
+    };
+
+    void                    setFlag(CellFlags flag, bool enable)                { if (enable) m_flags |= flag; else m_flags &= ~flag; }
+
+    // The indices are stored as 32 bit values to keep the cell small, and cvf::UNDEFINED_UINT is
+    // mapped to cvf::UNDEFINED_SIZE_T in the interface
+    static cvf::uint        toUInt(size_t index)                                { CVF_TIGHT_ASSERT(index == cvf::UNDEFINED_SIZE_T || index < cvf::UNDEFINED_UINT); return index == cvf::UNDEFINED_SIZE_T ? cvf::UNDEFINED_UINT : static_cast<cvf::uint>(index); }
+    static size_t           toSizeT(cvf::uint index)                            { return index == cvf::UNDEFINED_UINT ? cvf::UNDEFINED_SIZE_T : index; }
+
+private:
+    caf::UIntArray8         m_cornerIndices;            ///< Indices into the node array of the main grid
 
-    size_t                  m_cellIndex;                ///< This cells index in the grid it belongs to.
     RigGridBase*            m_hostGrid;
     RigLocalGrid*           m_subGrid;
 
-    size_t                  m_parentCellIndex; ///< Grid cell index of the cell in the parent grid containing this cell
-    size_t                  m_mainGridCellIndex;
-    bool                    m_isInCoarseCell; 
-
-    bool                    m_cellFaceFaults[6];
+    cvf::uint               m_cellIndex;                ///< This cells index in the grid it belongs to.
+    cvf::uint               m_parentCellIndex;          ///< Grid cell index of the cell in the parent grid containing this cell
+    cvf::uint               m_mainGridCellIndex;
 
     // Result case specific data 
-    bool                    m_isInvalid;
-    bool                    m_isWellCell;
-
-    size_t                  m_activeIndexInMatrixModel;      ///< This cell's running index of all the active calls (matrix) in the reservoir
-    size_t                  m_activeIndexInFractureModel;    ///< This cell's running index of all the active calls (fracture) in the reservoir
+    cvf::uint               m_activeIndexInMatrixModel;      ///< This cell's running index of all the active calls (matrix) in the reservoir
+    cvf::uint               m_activeIndexInFractureModel;    ///< This cell's running index of all the active calls (fracture) in the reservoir
 
+    cvf::ubyte              m_flags;                    ///< CellFlags
+    cvf::ubyte              m_cellFaceFaults;           ///< Bit n is set when face n is a fault
 };
@@ -154,7 +154,7 @@ void RigGridBase::initSubCellsMainGridCellIndex()
 //--------------------------------------------------------------------------------------------------
 void RigGridBase::cellCornerVertices(size_t cellIndex, cvf::Vec3d vertices[8]) const
 {
-    const caf::SizeTArray8& indices = cell(cellIndex).cornerIndices();
+    const caf::UIntArray8& indices = cell(cellIndex).cornerIndices();
     
     vertices[0].set(m_mainGrid->nodes()[indices[0]]);
     vertices[1].set(m_mainGrid->nodes()[indices[1]]);
@@ -180,7 +180,12 @@ size_t RigGridBase::cellIndexFromIJK(size_t i, size_t j, size_t k) const
 //--------------------------------------------------------------------------------------------------
 void RigGridBase::cellMinMaxCordinates(size_t cellIndex, cvf::Vec3d* minCoordinate, cvf::Vec3d* maxCoordinate) const
 {
-    
+    CVF_ASSERT(minCoordinate && maxCoordinate);
+
+    cvf::BoundingBox bb = cell(cellIndex).boundingBox();
+
+    *minCoordinate = bb.min();
+    *maxCoordinate = bb.max();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -216,10 +221,26 @@ size_t RigGridBase::gridPointIndexFromIJK(size_t i, size_t j, size_t k) const
 }
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Find the cell in this grid containing the coordinate, using the cell search tree of the main grid.
+/// Returns false if no cell in this grid contains the coordinate.
 //--------------------------------------------------------------------------------------------------
 bool RigGridBase::cellIJKFromCoordinate(const cvf::Vec3d& coord, size_t* i, size_t* j, size_t* k) const
 {
+    CVF_ASSERT(m_mainGrid);
+
+    std::vector<size_t> cellIndices;
+    m_mainGrid->findIntersectingCells(cvf::BoundingBox(coord, coord), &cellIndices);
+
+    size_t idx;
+    for (idx = 0; idx < cellIndices.size(); idx++)
+    {
+        const RigCell& candidate = m_mainGrid->cells()[cellIndices[idx]];
+        if (candidate.hostGrid() == this && candidate.containsPoint(coord))
+        {
+            return ijkFromCellIndex(candidate.cellIndex(), i, j, k);
+        }
+    }
+
     return false;
 }
 
@@ -238,9 +259,9 @@ cvf::Vec3d RigGridBase::gridPointCoordinate(size_t i, size_t j, size_t k) const
 //--------------------------------------------------------------------------------------------------
 cvf::Vec3d RigGridBase::minCoordinate() const
 {
-    cvf::Vec3d v;
+    if (!m_boundingBox.isValid()) return cvf::Vec3d::ZERO;
 
-    return v;
+    return m_boundingBox.min();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -272,9 +293,7 @@ size_t RigGridBase::gridPointCountK() const
 //--------------------------------------------------------------------------------------------------
 cvf::Vec3d RigGridBase::cellCentroid(size_t cellIndex) const
 {
-    cvf::Vec3d v;
-
-    return v;
+    return cell(cellIndex).center();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -282,9 +301,9 @@ cvf::Vec3d RigGridBase::cellCentroid(size_t cellIndex) const
 //--------------------------------------------------------------------------------------------------
 cvf::Vec3d RigGridBase::maxCoordinate() const
 {
-    cvf::Vec3d v;
+    if (!m_boundingBox.isValid()) return cvf::Vec3d::ZERO;
 
-    return v;
+    return m_boundingBox.max();
 }
 
 
@@ -342,89 +361,183 @@ bool RigGridBase::cellIJKNeighbor(size_t i, size_t j, size_t k, FaceType face, s
 }
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Returns whether the face of the cell and the opposite face of the neighbour cell have coincident
+/// corners. The opposite face is ordered the other way around, so corner n of the face matches 
+/// corner (4 - n) % 4 of the opposite face.
+//--------------------------------------------------------------------------------------------------
+static bool isFaceShared(const caf::UIntArray8& cornerIndices, const cvf::ubyte faceVertexIndices[4], 
+                         const caf::UIntArray8& neighbourCornerIndices, const cvf::ubyte oppositeFaceVertexIndices[4], 
+                         const std::vector<cvf::Vec3d>& nodes)
+{
+    const double tolerance = 1e-6;
+
+    int n;
+    for (n = 0; n < 4; n++)
+    {
+        size_t nodeIdx = cornerIndices[faceVertexIndices[n]];
+        size_t neighbourNodeIdx = neighbourCornerIndices[oppositeFaceVertexIndices[(4 - n) % 4]];
+
+        // Welded grids share the coincident nodes, so the distance test is only needed for unique nodes
+        if (nodeIdx == neighbourNodeIdx) continue;
+
+        if ((nodes[nodeIdx] - nodes[neighbourNodeIdx]).lengthSquared() > tolerance*tolerance)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Mark the cell faces where the neighbour cell does not share the face corners.
+/// Each face shared by two cells is compared once: The POS_I, POS_J and POS_K faces of all cells 
+/// are compared with the neighbour cells first, and then copied to the opposite face of the neighbour.
 //--------------------------------------------------------------------------------------------------
 void RigGridBase::computeFaults()
 {
-  //size_t k;
-#pragma omp parallel for 
-    for (int k = 0; k < static_cast<int>(cellCountK()); k++)
+    const size_t cellCounts[3] = { cellCountI(), cellCountJ(), cellCountK() };
+    const size_t neighbourOffsets[3] = { 1, cellCounts[0], cellCounts[0]*cellCounts[1] };
+    const FaceType positiveFaces[3] = { POS_I, POS_J, POS_K };
+
+    cvf::ubyte faceVertexIndices[3][4];
+    cvf::ubyte oppositeFaceVertexIndices[3][4];
+    int dir;
+    for (dir = 0; dir < 3; dir++)
+    {
+        cellFaceVertexIndices(positiveFaces[dir], faceVertexIndices[dir]);
+        cellFaceVertexIndices(oppositeFace(positiveFaces[dir]), oppositeFaceVertexIndices[dir]);
+    }
+
+    const std::vector<cvf::Vec3d>& nodes = m_mainGrid->nodes();
+
+    // Bit n is set when the cell face positiveFaces[n] is a fault
+    std::vector<cvf::ubyte> positiveFaceFaults(cellCounts[0]*cellCounts[1]*cellCounts[2], 0);
+
+#pragma omp parallel for
+    for (int k = 0; k < static_cast<int>(cellCounts[2]); k++)
     {
         size_t j;
-        for (j = 0; j < cellCountJ(); j++)
+        for (j = 0; j < cellCounts[1]; j++)
         {
             size_t i;
-            for (i = 0; i < cellCountI(); i++)
+            for (i = 0; i < cellCounts[0]; i++)
             {
                 size_t idx = cellIndexFromIJK(i, j, k);
 
-                RigCell& currentCell = cell(idx);
+                const RigCell& currentCell = cell(idx);
+                if (currentCell.isInvalid()) continue;
 
-                if (currentCell.isInvalid())
-                {
-                    continue;
-                }
-        
-                size_t faceIdx;
-                for (faceIdx = 0; faceIdx < 6; faceIdx++)
+                const size_t ijk[3] = { i, j, static_cast<size_t>(k) };
+
+                int dir;
+                for (dir = 0; dir < 3; dir++)
                 {
-                    cvf::StructGridInterface::FaceType face = static_cast<cvf::StructGridInterface::FaceType>(faceIdx);
+                    if (ijk[dir] + 1 >= cellCounts[dir]) continue;
 
-                    size_t cellNeighbourIdx = 0;
-                    if (!cellIJKNeighbor(i, j, k, face, &cellNeighbourIdx))
-                    {
-                        continue;
-                    }
+                    const RigCell& neighbourCell = cell(idx + neighbourOffsets[dir]);
+                    if (neighbourCell.isInvalid()) continue;
 
-                    const RigCell& neighbourCell = cell(cellNeighbourIdx);
-                    if (neighbourCell.isInvalid())
+                    if (!isFaceShared(currentCell.cornerIndices(), faceVertexIndices[dir], neighbourCell.cornerIndices(), oppositeFaceVertexIndices[dir], nodes))
                     {
-                        continue;
+                        positiveFaceFaults[idx] |= (1 << dir);
                     }
+                }
+            }
+        }
+    }
+
+#pragma omp parallel for
+    for (int k = 0; k < static_cast<int>(cellCounts[2]); k++)
+    {
+        size_t j;
+        for (j = 0; j < cellCounts[1]; j++)
+        {
+            size_t i;
+            for (i = 0; i < cellCounts[0]; i++)
+            {
+                size_t idx = cellIndexFromIJK(i, j, k);
+
+                RigCell& currentCell = cell(idx);
+                if (currentCell.isInvalid()) continue;
+
+                const size_t ijk[3] = { i, j, static_cast<size_t>(k) };
 
-                    cvf::Vec3d currentCellFaceVertices[4];
+                int dir;
+                for (dir = 0; dir < 3; dir++)
+                {
+                    if (positiveFaceFaults[idx] & (1 << dir))
                     {
-                        cvf::ubyte faceVertexIndices[4];
-                        cellFaceVertexIndices(face, faceVertexIndices);
-                        const caf::SizeTArray8& cornerIndices = currentCell.cornerIndices();
-        
-                        currentCellFaceVertices[0].set(m_mainGrid->nodes()[cornerIndices[faceVertexIndices[0]]]);
-                        currentCellFaceVertices[1].set(m_mainGrid->nodes()[cornerIndices[faceVertexIndices[1]]]);
-                        currentCellFaceVertices[2].set(m_mainGrid->nodes()[cornerIndices[faceVertexIndices[2]]]);
-                        currentCellFaceVertices[3].set(m_mainGrid->nodes()[cornerIndices[faceVertexIndices[3]]]);
+                        currentCell.setCellFaceFault(positiveFaces[dir]);
                     }
 
-                    cvf::Vec3d neighbourCellFaceVertices[4];
+                    if (ijk[dir] > 0 && (positiveFaceFaults[idx - neighbourOffsets[dir]] & (1 << dir)))
                     {
-                        cvf::ubyte faceVertexIndices[4];
-                        StructGridInterface::FaceType opposite = StructGridInterface::oppositeFace(face);
-                        cellFaceVertexIndices(opposite, faceVertexIndices);
-                        const caf::SizeTArray8& cornerIndices = neighbourCell.cornerIndices();
-
-                        neighbourCellFaceVertices[0].set(m_mainGrid->nodes()[cornerIndices[faceVertexIndices[0]]]);
-                        neighbourCellFaceVertices[1].set(m_mainGrid->nodes()[cornerIndices[faceVertexIndices[3]]]);
-                        neighbourCellFaceVertices[2].set(m_mainGrid->nodes()[cornerIndices[faceVertexIndices[2]]]);
-                        neighbourCellFaceVertices[3].set(m_mainGrid->nodes()[cornerIndices[faceVertexIndices[1]]]);
+                        currentCell.setCellFaceFault(oppositeFace(positiveFaces[dir]));
                     }
+                }
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Find the faces of each cell that are on the edge of the grid, and the faces that have a 
+/// neighbour cell refined by an LGR. Used to find the visible faces without testing the neighbours 
+/// each time the geometry is generated
+//--------------------------------------------------------------------------------------------------
+void RigGridBase::computeCellFaceMasks()
+{
+    const size_t cellCounts[3] = { cellCountI(), cellCountJ(), cellCountK() };
+    const size_t neighbourOffsets[3] = { 1, cellCounts[0], cellCounts[0]*cellCounts[1] };
+    const FaceType positiveFaces[3] = { POS_I, POS_J, POS_K };
 
-                    bool sharedFaceVertices = true;
+    m_gridEdgeFaceMasks.assign(cellCount(), 0);
+    m_subGridFaceMasks.assign(cellCount(), 0);
 
-                    // Check if vertices are matching
-                    double tolerance = 1e-6;
-                    size_t i;
-                    for (i = 0; i < 4; i++)
+#pragma omp parallel for
+    for (int k = 0; k < static_cast<int>(cellCounts[2]); k++)
+    {
+        size_t j;
+        for (j = 0; j < cellCounts[1]; j++)
+        {
+            size_t i;
+            for (i = 0; i < cellCounts[0]; i++)
+            {
+                size_t idx = cellIndexFromIJK(i, j, k);
+
+                const size_t ijk[3] = { i, j, static_cast<size_t>(k) };
+
+                cvf::ubyte gridEdgeFaces = 0;
+                cvf::ubyte subGridFaces = 0;
+
+                int dir;
+                for (dir = 0; dir < 3; dir++)
+                {
+                    FaceType positiveFace = positiveFaces[dir];
+                    FaceType negativeFace = oppositeFace(positiveFace);
+
+                    if (ijk[dir] + 1 >= cellCounts[dir])
                     {
-                        if (currentCellFaceVertices[i].pointDistance(neighbourCellFaceVertices[i]) > tolerance )
-                        {
-                            sharedFaceVertices = false;
-                        }
+                        gridEdgeFaces |= (1 << positiveFace);
+                    }
+                    else if (cell(idx + neighbourOffsets[dir]).subGrid())
+                    {
+                        subGridFaces |= (1 << positiveFace);
                     }
 
-                    if (!sharedFaceVertices)
+                    if (ijk[dir] == 0)
+                    {
+                        gridEdgeFaces |= (1 << negativeFace);
+                    }
+                    else if (cell(idx - neighbourOffsets[dir]).subGrid())
                     {
-                        currentCell.setCellFaceFault(face);
+                        subGridFaces |= (1 << negativeFace);
                     }
                 }
+
+                m_gridEdgeFaceMasks[idx] = gridEdgeFaces;
+                m_subGridFaceMasks[idx] = subGridFaces;
             }
         }
     }
@@ -520,44 +633,60 @@ void RigGridBase::setMatrixModelActiveCellCount(size_t activeMatrixModelCellCoun
 /// 
 //--------------------------------------------------------------------------------------------------
 bool RigGridCellFaceVisibilityFilter::isFaceVisible(size_t i, size_t j, size_t k, cvf::StructGridInterface::FaceType face, const cvf::UByteArray* cellVisibility) const
+{
+    return (visibleFaceMask(i, j, k, cellVisibility) & (1 << face)) != 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Uses the face masks computed for each cell when loading the grid, so only the visibility of the 
+/// neighbour cells has to be looked up
+//--------------------------------------------------------------------------------------------------
+cvf::ubyte RigGridCellFaceVisibilityFilter::visibleFaceMask(size_t i, size_t j, size_t k, const cvf::UByteArray* cellVisibility) const
 {
     CVF_TIGHT_ASSERT(m_grid);
 
+    size_t cellIndex = m_grid->cellIndexFromIJK(i, j, k);
+
+    cvf::ubyte faceMask = 0;
+
     if (m_showFaultFaces)
     {
-        size_t cellIndex = m_grid->cellIndexFromIJK(i, j, k);
-        if (m_grid->cell(cellIndex).isCellFaceFault(face))
-        {
-            return true;
-        }
+        faceMask |= m_grid->cell(cellIndex).cellFaceFaults();
     }
 
     if (m_showExternalFaces)
     {
-        size_t ni, nj, nk;
-        cvf::StructGridInterface::neighborIJKAtCellFace(i, j, k, face, &ni, &nj, &nk);
+        // Faces on the edge of the grid are always shown. Faces with a LGR neighbor are not shown, 
+        // as the subgrid will be responsible for displaying the face from the opposite side
+        cvf::ubyte gridEdgeFaces = m_grid->gridEdgeFaceMask(cellIndex);
+        faceMask |= gridEdgeFaces;
 
-        if (ni >= m_grid->cellCountI() || nj >= m_grid->cellCountJ() || nk >= m_grid->cellCountK())
+        if (cellVisibility != NULL)
         {
-            // Detected cell on edge of grid
-            return true;
-        }
-
-        size_t neighborCellIndex = m_grid->cellIndexFromIJK(ni, nj, nk);
-        const RigCell& neighborCell = m_grid->cell(neighborCellIndex);
-        if (neighborCell.subGrid())
-        {
-            // Do not show face with a LGR neighbor. The subgrid will be responsible for displaying the face from the opposite side
-            return false;
-        }
-
-        if ((cellVisibility != NULL) && !(*cellVisibility)[neighborCellIndex])
-        {
-            // Neighbor cell is not part of visible cells
-            return true;
+            cvf::ubyte interiorFaces = static_cast<cvf::ubyte>(~(gridEdgeFaces | m_grid->subGridFaceMask(cellIndex)) & 0x3f);
+
+            // Neighbor cell indices in FaceType order: POS_I, NEG_I, POS_J, NEG_J, POS_K, NEG_K
+            const size_t cellCountI = m_grid->cellCountI();
+            const size_t cellCountIJ = cellCountI*m_grid->cellCountJ();
+            const size_t neighborCellIndices[6] = 
+            { 
+                cellIndex + 1, cellIndex - 1, 
+                cellIndex + cellCountI, cellIndex - cellCountI, 
+                cellIndex + cellCountIJ, cellIndex - cellCountIJ 
+            };
+
+            int face;
+            for (face = 0; face < 6; face++)
+            {
+                if ((interiorFaces & (1 << face)) && !(*cellVisibility)[neighborCellIndices[face]])
+                {
+                    // Neighbor cell is not part of visible cells
+                    faceMask |= (1 << face);
+                }
+            }
         }
     }
 
-    return false;
+    return faceMask;
 }
 
@@ -21,6 +21,7 @@
 #include "cvfBase.h"
 
 #include "cvfVector3.h"
+#include "cvfBoundingBox.h"
 
 #include "cvfStructGrid.h"
 #include "cvfStructGridGeometryGenerator.h"
@@ -66,10 +67,16 @@ public:
     size_t                      fractureModelActiveCellCount() const ;
     void                        setFractureModelActiveCellCount(size_t activeFractureModelCellCount);
 
+    // Bit n is set when face n of the cell is on the edge of the grid, or faces a cell refined by an LGR.
+    // Computed by RigMainGrid::computeCachedData()
+    cvf::ubyte                  gridEdgeFaceMask(size_t gridCellIndex) const { return m_gridEdgeFaceMasks[gridCellIndex]; }
+    cvf::ubyte                  subGridFaceMask(size_t gridCellIndex) const  { return m_subGridFaceMasks[gridCellIndex]; }
+
 protected:
     friend class RigMainGrid;//::initAllSubGridsParentGridPointer();
     void                        initSubGridParentPointer();
     void                        initSubCellsMainGridCellIndex();
+    void                        computeCellFaceMasks();
 
     // Interface implementation
 public:
@@ -109,6 +116,11 @@ private:
     size_t                      m_matrixModelActiveCellCount;
     size_t                      m_fractureModelActiveCellCount;
 
+    cvf::BoundingBox            m_boundingBox; ///< Bounding box of the valid cells in this grid. Computed by RigMainGrid::computeCachedData()
+
+    std::vector<cvf::ubyte>     m_gridEdgeFaceMasks;    ///< Per cell, the faces without a neighbour cell in this grid
+    std::vector<cvf::ubyte>     m_subGridFaceMasks;     ///< Per cell, the faces with a neighbour cell refined by an LGR
+
 };
 
 
@@ -123,6 +135,7 @@ public:
     }
 
     virtual bool isFaceVisible( size_t i, size_t j, size_t k, cvf::StructGridInterface::FaceType face, const cvf::UByteArray* cellVisibility ) const;
+    virtual cvf::ubyte visibleFaceMask( size_t i, size_t j, size_t k, const cvf::UByteArray* cellVisibility ) const;
 
 public:
     bool m_showFaultFaces;
@@ -27,13 +27,38 @@
 #include "RigReservoirCellResults.h"
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// The timestep must be loaded. It is pinned, so it is not unloaded while this object references it
 //--------------------------------------------------------------------------------------------------
-RigGridScalarDataAccess::RigGridScalarDataAccess(const RigGridBase* grid, bool useGlobalActiveIndex, std::vector<double>* resultValues) :
+RigGridScalarDataAccess::RigGridScalarDataAccess(const RigGridBase* grid, RigReservoirCellResults* results, size_t scalarSetIndex, size_t timeStepIndex) :
     m_grid(grid),
-    m_useGlobalActiveIndex(useGlobalActiveIndex),
-    m_resultValues(resultValues)
+    m_results(results),
+    m_scalarSetIndex(scalarSetIndex),
+    m_timeStepIndex(timeStepIndex),
+    m_resultValues(NULL),
+    m_singlePrecisionResultValues(NULL)
+{
+    CVF_ASSERT(results);
+
+    m_results->pinFrame(m_scalarSetIndex, m_timeStepIndex);
+
+    if (m_results->isSinglePrecision(m_scalarSetIndex, m_timeStepIndex))
+    {
+        m_singlePrecisionResultValues = &(m_results->singlePrecisionCellScalarResults(m_scalarSetIndex, m_timeStepIndex));
+    }
+    else
+    {
+        m_resultValues = &(m_results->cellScalarResults(m_scalarSetIndex, m_timeStepIndex));
+    }
+
+    m_useGlobalActiveIndex = m_results->isUsingGlobalActiveIndex(m_scalarSetIndex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RigGridScalarDataAccess::~RigGridScalarDataAccess()
 {
+    m_results->unpinFrame(m_scalarSetIndex, m_timeStepIndex);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -50,17 +75,16 @@ cvf::ref<RigGridScalarDataAccess> RigGridScalarDataAccess::createDataAccessObjec
         return NULL;
     }
 
-    bool useGlobalActiveIndex = grid->mainGrid()->results(porosityModel)->isUsingGlobalActiveIndex(scalarSetIndex);
-
-    std::vector< std::vector<double> > & scalarSetResults = grid->mainGrid()->results(porosityModel)->cellScalarResults(scalarSetIndex);
-    if (timeStepIndex >= scalarSetResults.size())
+    RigReservoirCellResults* results = grid->mainGrid()->results(porosityModel);
+    if (timeStepIndex >= results->timeStepCount(scalarSetIndex))
     {
         return NULL;
     }
 
-    std::vector<double>* resultValues = &(scalarSetResults[timeStepIndex]);
+    // Make sure the time step is loaded before looking at the number of values
+    results->loadTimeStep(scalarSetIndex, timeStepIndex);
 
-    cvf::ref<RigGridScalarDataAccess> object = new RigGridScalarDataAccess(grid, useGlobalActiveIndex, resultValues);
+    cvf::ref<RigGridScalarDataAccess> object = new RigGridScalarDataAccess(grid, results, scalarSetIndex, timeStepIndex);
     return object;
 }
 
@@ -79,7 +103,21 @@ double RigGridScalarDataAccess::cellScalar(size_t i, size_t j, size_t k) const
 //--------------------------------------------------------------------------------------------------
 double RigGridScalarDataAccess::cellScalar(size_t cellIndex) const
 {
-    if (m_resultValues->size() == 0 ) return HUGE_VAL;
+    if (m_singlePrecisionResultValues)
+    {
+        return cellScalar(*m_singlePrecisionResultValues, cellIndex);
+    }
+
+    return cellScalar(*m_resultValues, cellIndex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+double RigGridScalarDataAccess::cellScalar(const std::vector<T>& resultValues, size_t cellIndex) const
+{
+    if (resultValues.size() == 0 ) return HUGE_VAL;
 
     size_t resultValueIndex = cellIndex;
 
@@ -89,9 +127,9 @@ double RigGridScalarDataAccess::cellScalar(size_t cellIndex) const
         if (resultValueIndex == cvf::UNDEFINED_SIZE_T) return HUGE_VAL;
     }
 
-    if (m_resultValues->size() <= resultValueIndex) return HUGE_VAL;
+    if (resultValues.size() <= resultValueIndex) return HUGE_VAL;
 
-    return m_resultValues->at(resultValueIndex);
+    return resultValues[resultValueIndex];
 }
 
 //--------------------------------------------------------------------------------------------------
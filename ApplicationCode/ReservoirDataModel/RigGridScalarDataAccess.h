@@ -23,6 +23,8 @@
 #include "RigGridBase.h"
 #include "RifReaderInterface.h"
 
+class RigReservoirCellResults;
+
 
 //--------------------------------------------------------------------------------------------------
 /// 
@@ -30,9 +32,11 @@
 class RigGridScalarDataAccess : public cvf::StructGridScalarDataAccess
 {
 private:
-    RigGridScalarDataAccess(const RigGridBase* grid, bool useGlobalActiveIndex, std::vector<double>* resultValues);
+    RigGridScalarDataAccess(const RigGridBase* grid, RigReservoirCellResults* results, size_t scalarSetIndex, size_t timeStepIndex);
 
 public:
+    virtual ~RigGridScalarDataAccess();
+
     static cvf::ref<RigGridScalarDataAccess> createDataAccessObject(const RigGridBase* grid, RifReaderInterface::PorosityModelResultType porosityModel, size_t timeStepIndex, size_t scalarSetIndex);
 
     virtual double  cellScalar(size_t i, size_t j, size_t k) const;
@@ -43,9 +47,17 @@ public:
     
     virtual const cvf::Vec3d* cellVector(size_t i, size_t j, size_t k) const;
 
+private:
+    template <typename T>
+    double          cellScalar(const std::vector<T>& resultValues, size_t cellIndex) const;
+
 private:
     cvf::cref<RigGridBase>  m_grid;
+    cvf::ref<RigReservoirCellResults> m_results;    ///< The timestep is pinned in the results while this object exists
+    size_t                  m_scalarSetIndex;
+    size_t                  m_timeStepIndex;
     bool                    m_useGlobalActiveIndex;
     std::vector<double>*    m_resultValues;
+    const std::vector<float>* m_singlePrecisionResultValues; ///< Used instead of m_resultValues when not NULL
 };
 
@@ -22,6 +22,7 @@
 #include "RigReservoirCellResults.h"
 
 #include "cvfAssert.h"
+#include <algorithm>
 
 RigMainGrid::RigMainGrid(void)
     : RigGridBase(this),
@@ -67,6 +68,19 @@ void RigMainGrid::initAllSubGridsParentGridPointer()
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigMainGrid::computeAllCellFaceMasks()
+{
+    computeCellFaceMasks();
+    size_t i;
+    for (i = 0; i < m_localGrids.size(); ++i)
+    {
+        m_localGrids[i]->computeCellFaceMasks(); 
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
@@ -217,7 +231,7 @@ void RigMainGrid::computeBoundingBox()
             const RigCell& c = cell(i);
             if (c.isActiveInMatrixModel())
             {
-                const caf::SizeTArray8& indices = c.cornerIndices();
+                const caf::UIntArray8& indices = c.cornerIndices();
 
                 size_t idx;
                 for (idx = 0; idx < 8; idx++)
@@ -239,83 +253,362 @@ void RigMainGrid::computeCachedData()
 {
     initAllSubGridsParentGridPointer();
     initAllSubCellsMainGridCellIndex();
+    computeAllCellFaceMasks();
     computeActiveAndValidCellRanges();
     computeBoundingBox();
+    buildCellSearchTree();
+    computeMatrixModelActiveCellInfo();
 }
 
 //--------------------------------------------------------------------------------------------------
-///
-///
-///
+/// Build the search tree over the bounding boxes of the valid cells in all the grids
 //--------------------------------------------------------------------------------------------------
-void RigMainGrid::calculateMatrixModelActiveCellInfo(std::vector<qint32> &gridNumber,
-                                          std::vector<qint32> &cellI,
-                                          std::vector<qint32> &cellJ,
-                                          std::vector<qint32> &cellK,
-                                          std::vector<qint32> &parentGridNumber,
-                                          std::vector<qint32> &hostCellI,
-                                          std::vector<qint32> &hostCellJ,
-                                          std::vector<qint32> &hostCellK)
+void RigMainGrid::buildCellSearchTree()
 {
-    size_t numMatrixModelActiveCells = this->globalMatrixModelActiveCellCount();
+    std::vector<cvf::BoundingBox> cellBoundingBoxes(m_cells.size());
+    std::vector<size_t> cellIndices(m_cells.size());
 
-    gridNumber.clear();
-    cellI.clear();
-    cellJ.clear();
-    cellK.clear();
-    parentGridNumber.clear();
-    hostCellI.clear();
-    hostCellJ.clear();
-    hostCellK.clear();
-
-    gridNumber.reserve(numMatrixModelActiveCells);
-    cellI.reserve(numMatrixModelActiveCells);
-    cellJ.reserve(numMatrixModelActiveCells);
-    cellK.reserve(numMatrixModelActiveCells);
-    parentGridNumber.reserve(numMatrixModelActiveCells);
-    hostCellI.reserve(numMatrixModelActiveCells);
-    hostCellJ.reserve(numMatrixModelActiveCells);
-    hostCellK.reserve(numMatrixModelActiveCells);
+    int cellCount = static_cast<int>(m_cells.size());
 
-    for (size_t cIdx = 0; cIdx < m_cells.size(); ++cIdx)
+#pragma omp parallel for
+    for (int cellIdx = 0; cellIdx < cellCount; cellIdx++)
+    {
+        cellIndices[cellIdx] = cellIdx;
+
+        // Invalid cells get an invalid bounding box, and are left out of the tree
+        const RigCell& cell = m_cells[cellIdx];
+        if (!cell.isInvalid())
+        {
+            cellBoundingBoxes[cellIdx] = cell.boundingBox();
+        }
+    }
+
+    m_cellSearchTree = new RigBoundingBoxTree;
+    m_cellSearchTree->build(cellBoundingBoxes, cellIndices);
+
+    // The bounding box of each grid is collected from its cells
+    size_t gridIdx;
+    for (gridIdx = 0; gridIdx < gridCount(); ++gridIdx)
+    {
+        gridByIndex(gridIdx)->m_boundingBox.reset();
+    }
+
+    size_t cellIdx;
+    for (cellIdx = 0; cellIdx < m_cells.size(); ++cellIdx)
+    {
+        if (cellBoundingBoxes[cellIdx].isValid() && m_cells[cellIdx].hostGrid())
+        {
+            m_cells[cellIdx].hostGrid()->m_boundingBox.add(cellBoundingBoxes[cellIdx]);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Find the global indices of the valid cells with bounding box intersecting the given box
+//--------------------------------------------------------------------------------------------------
+void RigMainGrid::findIntersectingCells(const cvf::BoundingBox& inputBB, std::vector<size_t>* cellIndices) const
+{
+    CVF_ASSERT(cellIndices);
+
+    if (m_cellSearchTree.isNull()) return;
+
+    std::vector<size_t> candidates;
+    m_cellSearchTree->findIntersectionCandidates(inputBB, &candidates);
+
+    size_t i;
+    for (i = 0; i < candidates.size(); i++)
     {
-        if (m_cells[cIdx].isActiveInMatrixModel())
+        if (m_cells[candidates[i]].boundingBox().intersects(inputBB))
         {
-            RigGridBase* grid = m_cells[cIdx].hostGrid();
-            CVF_ASSERT(grid != NULL);
-            size_t cellIndex = m_cells[cIdx].cellIndex();
-            
-            size_t i, j, k;
-            grid->ijkFromCellIndex(cellIndex, &i, &j, &k);
+            cellIndices->push_back(candidates[i]);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Find the global index of the cell containing the coordinate. Cells in local grid refinements
+/// are preferred over their host cells. Returns cvf::UNDEFINED_SIZE_T if no cell contains it.
+//--------------------------------------------------------------------------------------------------
+size_t RigMainGrid::findCellFromCoordinate(const cvf::Vec3d& coord) const
+{
+    if (m_cellSearchTree.isNull()) return cvf::UNDEFINED_SIZE_T;
+
+    std::vector<size_t> candidates;
+    m_cellSearchTree->findIntersectionCandidates(coord, &candidates);
+
+    size_t hostCellIndex = cvf::UNDEFINED_SIZE_T;
+
+    size_t i;
+    for (i = 0; i < candidates.size(); i++)
+    {
+        const RigCell& cell = m_cells[candidates[i]];
+        if (!cell.containsPoint(coord)) continue;
+
+        if (!cell.subGrid()) return candidates[i];
+
+        hostCellIndex = candidates[i];
+    }
+
+    return hostCellIndex;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Replace the private corner nodes of each cell by nodes shared with the neighbour cells
+/// 
+/// The cells of each grid are visited in index order. A corner is reused from an already visited 
+/// cell touching the same grid point only if the coordinates coincide, so nodes separated by a 
+/// fault throw are kept apart. Nodes are never shared between different grids.
+/// The node table is compacted and the corner indices of all cells are rewritten.
+//--------------------------------------------------------------------------------------------------
+void RigMainGrid::weldCoincidentNodes()
+{
+    // Grid point offset of each corner relative to the cell, using the ResInsight corner numbering
+    static const int cornerOffsetI[8] = { 0, 1, 1, 0, 0, 1, 1, 0 };
+    static const int cornerOffsetJ[8] = { 0, 0, 1, 1, 0, 0, 1, 1 };
+    static const int cornerOffsetK[8] = { 0, 0, 0, 0, 1, 1, 1, 1 };
+
+    const double tolerance = 1e-6;
+    const double squaredTolerance = tolerance*tolerance;
+
+    std::vector<cvf::Vec3d> weldedNodes;
+    weldedNodes.reserve(m_nodes.size() / 4);
 
-            size_t pi, pj, pk;
-            RigGridBase* parentGrid = NULL;
+    std::vector<size_t> newNodeIndices(m_nodes.size(), cvf::UNDEFINED_SIZE_T);
 
-            if (grid->isMainGrid())
+    size_t gridIdx;
+    for (gridIdx = 0; gridIdx < gridCount(); ++gridIdx)
+    {
+        RigGridBase* grid = gridByIndex(gridIdx);
+
+        const int cellCountI = static_cast<int>(grid->cellCountI());
+        const int cellCountJ = static_cast<int>(grid->cellCountJ());
+        const int cellCountK = static_cast<int>(grid->cellCountK());
+
+        int i, j, k;
+        for (k = 0; k < cellCountK; ++k)
+        {
+            for (j = 0; j < cellCountJ; ++j)
             {
-                pi = i;
-                pj = j;
-                pk = k;
-                parentGrid = grid;
+                for (i = 0; i < cellCountI; ++i)
+                {
+                    size_t cellIndex = grid->cellIndexFromIJK(i, j, k);
+                    caf::UIntArray8& cornerIndices = grid->cell(cellIndex).cornerIndices();
+
+                    int cIdx;
+                    for (cIdx = 0; cIdx < 8; ++cIdx)
+                    {
+                        size_t oldNodeIndex = cornerIndices[cIdx];
+                        if (newNodeIndices[oldNodeIndex] != cvf::UNDEFINED_SIZE_T)
+                        {
+                            // Node already shared by the reader
+                            cornerIndices[cIdx] = static_cast<cvf::uint>(newNodeIndices[oldNodeIndex]);
+                            continue;
+                        }
+
+                        const cvf::Vec3d& node = m_nodes[oldNodeIndex];
+
+                        int gridPointI = i + cornerOffsetI[cIdx];
+                        int gridPointJ = j + cornerOffsetJ[cIdx];
+                        int gridPointK = k + cornerOffsetK[cIdx];
+
+                        size_t weldedNodeIndex = cvf::UNDEFINED_SIZE_T;
+
+                        // Search the visited cells touching this grid point for a coincident corner
+                        int otherCIdx;
+                        for (otherCIdx = 0; otherCIdx < 8 && weldedNodeIndex == cvf::UNDEFINED_SIZE_T; ++otherCIdx)
+                        {
+                            int otherI = gridPointI - cornerOffsetI[otherCIdx];
+                            int otherJ = gridPointJ - cornerOffsetJ[otherCIdx];
+                            int otherK = gridPointK - cornerOffsetK[otherCIdx];
+
+                            if (otherI < 0 || otherJ < 0 || otherK < 0) continue;
+                            if (otherI >= cellCountI || otherJ >= cellCountJ || otherK >= cellCountK) continue;
+
+                            size_t otherCellIndex = grid->cellIndexFromIJK(otherI, otherJ, otherK);
+                            if (otherCellIndex >= cellIndex) continue;
+
+                            size_t candidate = grid->cell(otherCellIndex).cornerIndices()[otherCIdx];
+                            if ((weldedNodes[candidate] - node).lengthSquared() <= squaredTolerance)
+                            {
+                                weldedNodeIndex = candidate;
+                            }
+                        }
+
+                        if (weldedNodeIndex == cvf::UNDEFINED_SIZE_T)
+                        {
+                            weldedNodeIndex = weldedNodes.size();
+                            weldedNodes.push_back(node);
+                        }
+
+                        newNodeIndices[oldNodeIndex] = weldedNodeIndex;
+                        cornerIndices[cIdx] = static_cast<cvf::uint>(weldedNodeIndex);
+                    }
+                }
             }
-            else
+        }
+    }
+
+    // Release the memory of the old node table, including any excess capacity
+    std::vector<cvf::Vec3d> compactedNodes(weldedNodes.begin(), weldedNodes.end());
+    m_nodes.swap(compactedNodes);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Compute the grid and IJK of each active cell, and of its host cell in the parent grid, in 
+/// active cell order. Kept in eight columns, ready to be sent to clients
+//--------------------------------------------------------------------------------------------------
+void RigMainGrid::computeMatrixModelActiveCellInfo()
+{
+    size_t numMatrixModelActiveCells = this->globalMatrixModelActiveCellCount();
+    if (numMatrixModelActiveCells == cvf::UNDEFINED_SIZE_T) numMatrixModelActiveCells = 0;
+
+    m_matrixModelActiveCellInfo.resize(8);
+    for (size_t colIdx = 0; colIdx < m_matrixModelActiveCellInfo.size(); ++colIdx)
+    {
+        m_matrixModelActiveCellInfo[colIdx].assign(numMatrixModelActiveCells, 0);
+    }
+
+    std::vector<qint32>& gridNumber         = m_matrixModelActiveCellInfo[0];
+    std::vector<qint32>& cellI              = m_matrixModelActiveCellInfo[1];
+    std::vector<qint32>& cellJ              = m_matrixModelActiveCellInfo[2];
+    std::vector<qint32>& cellK              = m_matrixModelActiveCellInfo[3];
+    std::vector<qint32>& parentGridNumber   = m_matrixModelActiveCellInfo[4];
+    std::vector<qint32>& hostCellI          = m_matrixModelActiveCellInfo[5];
+    std::vector<qint32>& hostCellJ          = m_matrixModelActiveCellInfo[6];
+    std::vector<qint32>& hostCellK          = m_matrixModelActiveCellInfo[7];
+
+    int cellCount = static_cast<int>(m_cells.size());
+
+#pragma omp parallel for
+    for (int cIdx = 0; cIdx < cellCount; ++cIdx)
+    {
+        const RigCell& cell = m_cells[cIdx];
+        size_t activeIndex = cell.activeIndexInMatrixModel();
+
+        if (activeIndex == cvf::UNDEFINED_SIZE_T || activeIndex >= numMatrixModelActiveCells) continue;
+
+        RigGridBase* grid = cell.hostGrid();
+        CVF_ASSERT(grid != NULL);
+        size_t cellIndex = cell.cellIndex();
+
+        size_t i, j, k;
+        grid->ijkFromCellIndex(cellIndex, &i, &j, &k);
+
+        size_t pi, pj, pk;
+        RigGridBase* parentGrid = NULL;
+
+        if (grid->isMainGrid())
+        {
+            pi = i;
+            pj = j;
+            pk = k;
+            parentGrid = grid;
+        }
+        else
+        {
+            size_t parentCellIdx = cell.parentCellIndex();
+            parentGrid = (static_cast<RigLocalGrid*>(grid))->parentGrid();
+            CVF_ASSERT(parentGrid != NULL);
+            parentGrid->ijkFromCellIndex(parentCellIdx, &pi, &pj, &pk);
+        }
+
+        gridNumber[activeIndex]         = static_cast<qint32>(grid->gridIndex());
+        cellI[activeIndex]              = static_cast<qint32>(i);
+        cellJ[activeIndex]              = static_cast<qint32>(j);
+        cellK[activeIndex]              = static_cast<qint32>(k);
+        parentGridNumber[activeIndex]   = static_cast<qint32>(parentGrid->gridIndex());
+        hostCellI[activeIndex]          = static_cast<qint32>(pi);
+        hostCellJ[activeIndex]          = static_cast<qint32>(pj);
+        hostCellK[activeIndex]          = static_cast<qint32>(pk);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The center of each active cell, in active cell order. The coordinates are stored in three 
+/// columns: All the X values, then all the Y values, then all the Z values
+//--------------------------------------------------------------------------------------------------
+void RigMainGrid::matrixModelActiveCellCenters(std::vector<double>* coordinates) const
+{
+    CVF_ASSERT(coordinates);
+
+    size_t activeCellCount = this->globalMatrixModelActiveCellCount();
+    if (activeCellCount == cvf::UNDEFINED_SIZE_T) activeCellCount = 0;
+    coordinates->assign(3 * activeCellCount, HUGE_VAL);
+
+    int cellCount = static_cast<int>(m_cells.size());
+
+#pragma omp parallel for
+    for (int cIdx = 0; cIdx < cellCount; ++cIdx)
+    {
+        size_t activeIndex = m_cells[cIdx].activeIndexInMatrixModel();
+        if (activeIndex == cvf::UNDEFINED_SIZE_T || activeIndex >= activeCellCount) continue;
+
+        cvf::Vec3d center = m_cells[cIdx].center();
+        for (size_t coordIdx = 0; coordIdx < 3; ++coordIdx)
+        {
+            (*coordinates)[coordIdx * activeCellCount + activeIndex] = center[coordIdx];
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The eight corners of each active cell, in active cell order. The coordinates are stored in 24 
+/// columns: The X values of corner 0 to 7, then the Y values of corner 0 to 7, then the Z values
+//--------------------------------------------------------------------------------------------------
+void RigMainGrid::matrixModelActiveCellCorners(std::vector<double>* coordinates) const
+{
+    CVF_ASSERT(coordinates);
+
+    size_t activeCellCount = this->globalMatrixModelActiveCellCount();
+    if (activeCellCount == cvf::UNDEFINED_SIZE_T) activeCellCount = 0;
+    coordinates->assign(24 * activeCellCount, HUGE_VAL);
+
+    int cellCount = static_cast<int>(m_cells.size());
+
+#pragma omp parallel for
+    for (int cIdx = 0; cIdx < cellCount; ++cIdx)
+    {
+        size_t activeIndex = m_cells[cIdx].activeIndexInMatrixModel();
+        if (activeIndex == cvf::UNDEFINED_SIZE_T || activeIndex >= activeCellCount) continue;
+
+        const caf::UIntArray8& cornerIndices = m_cells[cIdx].cornerIndices();
+        for (size_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx)
+        {
+            const cvf::Vec3d& corner = m_nodes[cornerIndices[cornerIdx]];
+            for (size_t coordIdx = 0; coordIdx < 3; ++coordIdx)
             {
-                size_t parentCellIdx = m_cells[cIdx].parentCellIndex();
-                parentGrid = (static_cast<RigLocalGrid*>(grid))->parentGrid();
-                CVF_ASSERT(parentGrid != NULL);
-                parentGrid->ijkFromCellIndex(parentCellIdx, &pi, &pj, &pk);
+                (*coordinates)[(coordIdx * 8 + cornerIdx) * activeCellCount + activeIndex] = corner[coordIdx];
             }
+        }
+    }
+}
 
-            gridNumber.push_back(static_cast<qint32>(grid->gridIndex()));
-            cellI.push_back(static_cast<qint32>(i));
-            cellJ.push_back(static_cast<qint32>(j));
-            cellK.push_back(static_cast<qint32>(k));
-            parentGridNumber.push_back(static_cast<qint32>(parentGrid->gridIndex()));
-            hostCellI.push_back(static_cast<qint32>(pi));
-            hostCellJ.push_back(static_cast<qint32>(pj));
-            hostCellK.push_back(static_cast<qint32>(pk));
+//--------------------------------------------------------------------------------------------------
+/// Find the matrix model active cells inside the main grid IJK box [min, max], including the LGR
+/// cells residing in main grid cells within the box. The active cell indices are returned sorted
+//--------------------------------------------------------------------------------------------------
+void RigMainGrid::matrixModelActiveCellIndicesInBox(const cvf::Vec3st& min, const cvf::Vec3st& max, std::vector<size_t>* activeCellIndices) const
+{
+    CVF_ASSERT(activeCellIndices);
+    activeCellIndices->clear();
+
+    for (size_t cIdx = 0; cIdx < m_cells.size(); ++cIdx)
+    {
+        const RigCell& cell = m_cells[cIdx];
+        if (!cell.isActiveInMatrixModel()) continue;
+
+        size_t i, j, k;
+        this->ijkFromCellIndex(cell.mainGridCellIndex(), &i, &j, &k);
+
+        if (   i >= min.x() && i <= max.x()
+            && j >= min.y() && j <= max.y()
+            && k >= min.z() && k <= max.z())
+        {
+            activeCellIndices->push_back(cell.activeIndexInMatrixModel());
         }
     }
+
+    std::sort(activeCellIndices->begin(), activeCellIndices->end());
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -364,3 +657,21 @@ const RigReservoirCellResults* RigMainGrid::results(RifReaderInterface::Porosity
     return m_fractureModelResults.p();
 }
 
+//--------------------------------------------------------------------------------------------------
+/// Replace the results of a porosity model, used when the results are built separately from the 
+/// grid. The results must be created with this grid as owner
+//--------------------------------------------------------------------------------------------------
+void RigMainGrid::setResults(RifReaderInterface::PorosityModelResultType porosityModel, RigReservoirCellResults* results)
+{
+    CVF_ASSERT(results);
+
+    if (porosityModel == RifReaderInterface::MATRIX_RESULTS)
+    {
+        m_matrixModelResults = results;
+    }
+    else
+    {
+        m_fractureModelResults = results;
+    }
+}
+
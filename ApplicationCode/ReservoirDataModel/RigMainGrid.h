@@ -24,6 +24,7 @@
 #include "cvfCollection.h"
 #include "cvfBoundingBox.h"
 #include "RifReaderInterface.h"
+#include "RigBoundingBoxTree.h"
 
 #include <QtGlobal>
 
@@ -44,6 +45,7 @@ public:
 
     RigReservoirCellResults*		        results(RifReaderInterface::PorosityModelResultType porosityModel);
     const RigReservoirCellResults*          results(RifReaderInterface::PorosityModelResultType porosityModel) const;
+    void                                    setResults(RifReaderInterface::PorosityModelResultType porosityModel, RigReservoirCellResults* results);
 
     size_t                                  globalMatrixModelActiveCellCount() const;
     size_t                                  globalFractureModelActiveCellCount() const;
@@ -58,26 +60,29 @@ public:
     RigGridBase*                            gridByIndex(size_t localGridIndex);
     const RigGridBase*                      gridByIndex(size_t localGridIndex) const;
     
-    void                                    calculateMatrixModelActiveCellInfo(std::vector<qint32>& gridNumber,
-                                                                    std::vector<qint32>& i,
-                                                                    std::vector<qint32>& j,
-                                                                    std::vector<qint32>& k,
-                                                                    std::vector<qint32>& parentGridNumber,
-                                                                    std::vector<qint32>& hostCellI,
-                                                                    std::vector<qint32>& hostCellJ,
-                                                                    std::vector<qint32>& hostCellK);
+    const std::vector< std::vector<qint32> >& matrixModelActiveCellInfo() const { return m_matrixModelActiveCellInfo; }
+    void                                    matrixModelActiveCellCenters(std::vector<double>* coordinates) const;
+    void                                    matrixModelActiveCellCorners(std::vector<double>* coordinates) const;
+    void                                    matrixModelActiveCellIndicesInBox(const cvf::Vec3st& min, const cvf::Vec3st& max, std::vector<size_t>* activeCellIndices) const;
     void                                    computeCachedData();
+    void                                    weldCoincidentNodes();
 
     cvf::BoundingBox                        matrixModelActiveCellsBoundingBox() const;
 
+    void                                    findIntersectingCells(const cvf::BoundingBox& inputBB, std::vector<size_t>* cellIndices) const;
+    size_t                                  findCellFromCoordinate(const cvf::Vec3d& coord) const;
+
     // Overrides
     virtual cvf::Vec3d                      displayModelOffset() const;
 
 private:
     void                                    initAllSubGridsParentGridPointer();
     void                                    initAllSubCellsMainGridCellIndex();
+    void                                    computeAllCellFaceMasks();
     void                                    computeActiveAndValidCellRanges();
     void                                    computeBoundingBox();
+    void                                    buildCellSearchTree();
+    void                                    computeMatrixModelActiveCellInfo();
 
 private:
     std::vector<cvf::Vec3d>                 m_nodes;        ///< Global vertex table
@@ -96,5 +101,9 @@ private:
     cvf::Vec3st                             m_validCellPositionMax;
 
     cvf::BoundingBox                        m_activeCellsBoundingBox;
+
+    cvf::ref<RigBoundingBoxTree>            m_cellSearchTree;   ///< Bounding boxes of all the valid cells, by global cell index
+
+    std::vector< std::vector<qint32> >      m_matrixModelActiveCellInfo; ///< Columns GridNumber, I, J, K, ParentGridNumber, HostCellI, HostCellJ, HostCellK for each active cell
 };
 
@@ -0,0 +1,198 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#include "RIStdInclude.h"
+
+#include "RigQuantileSketch.h"
+
+#include "cvfBase.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RigQuantileSketch::RigQuantileSketch(size_t k)
+    :   m_k(k < 8 ? 8 : k),
+        m_retainedCount(0),
+        m_maxRetainedCount(0),
+        m_valueCount(0)
+{
+    addLevel();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigQuantileSketch::add(double value)
+{
+    m_compactors[0].push_back(value);
+    m_retainedCount++;
+    m_valueCount++;
+
+    if (m_retainedCount >= m_maxRetainedCount)
+    {
+        compress();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigQuantileSketch::merge(const RigQuantileSketch& other)
+{
+    while (m_compactors.size() < other.m_compactors.size())
+    {
+        addLevel();
+    }
+
+    for (size_t level = 0; level < other.m_compactors.size(); ++level)
+    {
+        m_compactors[level].insert(m_compactors[level].end(), other.m_compactors[level].begin(), other.m_compactors[level].end());
+    }
+
+    m_retainedCount += other.m_retainedCount;
+    m_valueCount += other.m_valueCount;
+
+    if (m_retainedCount >= m_maxRetainedCount)
+    {
+        compress();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Returns the estimated value at which the fraction \a pVal of the values are below it.
+/// Returns HUGE_VAL if no values are added
+//--------------------------------------------------------------------------------------------------
+double RigQuantileSketch::quantile(double pVal) const
+{
+    CVF_ASSERT(0.0 <= pVal && pVal <= 1.0);
+
+    if (m_valueCount == 0) return HUGE_VAL;
+
+    std::vector< std::pair<double, size_t> > weightedValues;
+    weightedValues.reserve(m_retainedCount);
+
+    size_t totalWeight = 0;
+    for (size_t level = 0; level < m_compactors.size(); ++level)
+    {
+        size_t weight = static_cast<size_t>(1) << level;
+        for (size_t i = 0; i < m_compactors[level].size(); ++i)
+        {
+            weightedValues.push_back(std::make_pair(m_compactors[level][i], weight));
+        }
+
+        totalWeight += weight * m_compactors[level].size();
+    }
+
+    std::sort(weightedValues.begin(), weightedValues.end());
+
+    double targetWeight = pVal * totalWeight;
+    size_t accumulatedWeight = 0;
+    for (size_t i = 0; i < weightedValues.size(); ++i)
+    {
+        accumulatedWeight += weightedValues[i].second;
+        if (accumulatedWeight >= targetWeight)
+        {
+            return weightedValues[i].first;
+        }
+    }
+
+    return weightedValues.back().first;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigQuantileSketch::addLevel()
+{
+    m_compactors.push_back(std::vector<double>());
+    m_useOddItems.push_back(false);
+
+    m_maxRetainedCount = 0;
+    for (size_t level = 0; level < m_compactors.size(); ++level)
+    {
+        m_maxRetainedCount += levelCapacity(level);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The top level holds k values, and the capacity shrinks by a factor 2/3 for each level below it
+//--------------------------------------------------------------------------------------------------
+size_t RigQuantileSketch::levelCapacity(size_t level) const
+{
+    size_t depth = m_compactors.size() - level - 1;
+    return static_cast<size_t>(std::ceil(std::pow(2.0/3.0, static_cast<double>(depth)) * m_k)) + 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Compact full levels, lowest first, until the retained values fit within the capacity
+//--------------------------------------------------------------------------------------------------
+void RigQuantileSketch::compress()
+{
+    while (m_retainedCount >= m_maxRetainedCount)
+    {
+        size_t level;
+        for (level = 0; level < m_compactors.size(); ++level)
+        {
+            if (m_compactors[level].size() >= levelCapacity(level))
+            {
+                break;
+            }
+        }
+
+        if (level == m_compactors.size()) break;
+
+        if (level + 1 == m_compactors.size())
+        {
+            addLevel();
+        }
+
+        compact(level);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Sort the values at \a level and promote every other one to the level above. 
+/// An odd value count leaves the largest value behind.
+//--------------------------------------------------------------------------------------------------
+void RigQuantileSketch::compact(size_t level)
+{
+    std::vector<double>& compactor = m_compactors[level];
+    std::sort(compactor.begin(), compactor.end());
+
+    bool hasLeftover = compactor.size() % 2 == 1;
+    double leftover = hasLeftover ? compactor.back() : 0.0;
+    size_t pairedCount = hasLeftover ? compactor.size() - 1 : compactor.size();
+
+    std::vector<double>& nextCompactor = m_compactors[level + 1];
+    for (size_t i = m_useOddItems[level] ? 1 : 0; i < pairedCount; i += 2)
+    {
+        nextCompactor.push_back(compactor[i]);
+    }
+
+    m_useOddItems[level] = !m_useOddItems[level];
+
+    m_retainedCount -= pairedCount / 2;
+
+    compactor.clear();
+    if (hasLeftover) compactor.push_back(leftover);
+}
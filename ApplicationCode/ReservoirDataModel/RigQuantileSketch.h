@@ -0,0 +1,58 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+//==================================================================================================
+/// Mergeable quantile sketch (KLL) giving approximate quantiles of a stream of values using 
+/// memory independent of the number of values.
+///
+/// The values are kept in a stack of compactors, where a value at level h represents 2^h of the
+/// original values. When a compactor is full, it is sorted and every other value is promoted to the
+/// next level. Sketches built from different parts of the data can be merged, e.g. one per thread
+/// or one per time step. The rank error is roughly 1.7/k of the value count.
+//==================================================================================================
+class RigQuantileSketch
+{
+public:
+    explicit RigQuantileSketch(size_t k = 200);
+
+    void    add(double value);
+    void    merge(const RigQuantileSketch& other);
+
+    double  quantile(double pVal) const;
+    size_t  valueCount() const { return m_valueCount; }
+
+private:
+    void    addLevel();
+    size_t  levelCapacity(size_t level) const;
+    void    compress();
+    void    compact(size_t level);
+
+private:
+    size_t                              m_k;
+    std::vector< std::vector<double> >  m_compactors;   ///< Retained values at each level
+    std::vector<bool>                   m_useOddItems;  ///< Alternates which half of a compactor is promoted
+    size_t                              m_retainedCount;
+    size_t                              m_maxRetainedCount;
+    size_t                              m_valueCount;
+};
@@ -143,14 +143,14 @@ void RigReservoirBuilderMock::appendCells(size_t nodeStartIndex, size_t cellCoun
         riCell.setHostGrid(hostGrid);
         riCell.setCellIndex(i);
 
-        riCell.cornerIndices()[0] = nodeStartIndex + i * 8 + 0;
-        riCell.cornerIndices()[1] = nodeStartIndex + i * 8 + 1;
-        riCell.cornerIndices()[2] = nodeStartIndex + i * 8 + 2;
-        riCell.cornerIndices()[3] = nodeStartIndex + i * 8 + 3;
-        riCell.cornerIndices()[4] = nodeStartIndex + i * 8 + 4;
-        riCell.cornerIndices()[5] = nodeStartIndex + i * 8 + 5;
-        riCell.cornerIndices()[6] = nodeStartIndex + i * 8 + 6;
-        riCell.cornerIndices()[7] = nodeStartIndex + i * 8 + 7;
+        riCell.cornerIndices()[0] = static_cast<cvf::uint>(nodeStartIndex + i * 8 + 0);
+        riCell.cornerIndices()[1] = static_cast<cvf::uint>(nodeStartIndex + i * 8 + 1);
+        riCell.cornerIndices()[2] = static_cast<cvf::uint>(nodeStartIndex + i * 8 + 2);
+        riCell.cornerIndices()[3] = static_cast<cvf::uint>(nodeStartIndex + i * 8 + 3);
+        riCell.cornerIndices()[4] = static_cast<cvf::uint>(nodeStartIndex + i * 8 + 4);
+        riCell.cornerIndices()[5] = static_cast<cvf::uint>(nodeStartIndex + i * 8 + 5);
+        riCell.cornerIndices()[6] = static_cast<cvf::uint>(nodeStartIndex + i * 8 + 6);
+        riCell.cornerIndices()[7] = static_cast<cvf::uint>(nodeStartIndex + i * 8 + 7);
 
         riCell.setParentCellIndex(0);
 
@@ -223,7 +223,7 @@ void RigReservoirBuilderMock::populateReservoir(RigReservoir* reservoir)
         {
             RigCell& cell = reservoir->mainGrid()->cells()[mainGridIndicesWithSubGrid[cellIdx]];
             
-            caf::SizeTArray8& indices = cell.cornerIndices();
+            caf::UIntArray8& indices = cell.cornerIndices();
             int nodeIdx;
             for (nodeIdx = 0; nodeIdx < 8; nodeIdx++)
             {
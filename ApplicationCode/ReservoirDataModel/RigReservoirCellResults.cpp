@@ -29,6 +29,9 @@
 /// 
 //--------------------------------------------------------------------------------------------------
 RigReservoirCellResults::RigReservoirCellResults(RigMainGrid* ownerGrid)
+    : m_frameAccessCounter(0),
+    m_frameMemoryBudget(0),
+    m_loadedFrameMemory(0)
 {
     CVF_ASSERT(ownerGrid != NULL);
     m_ownerMainGrid = ownerGrid;
@@ -39,91 +42,115 @@ RigReservoirCellResults::RigReservoirCellResults(RigMainGrid* ownerGrid)
 //--------------------------------------------------------------------------------------------------
 void RigReservoirCellResults::minMaxCellScalarValues( size_t scalarResultIndex, double& min, double& max )
 {
-    min = HUGE_VAL;
-    max = -HUGE_VAL;
-	
-    CVF_ASSERT(scalarResultIndex < resultCount());
+    const RigStatistics& stats = statistics(scalarResultIndex);
 
-    // Extend array and cache vars
+    min = stats.m_min;
+    max = stats.m_max;
+}
 
-    if (scalarResultIndex >= m_maxMinValues.size() )
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::minMaxCellScalarValues(size_t scalarResultIndex, size_t timeStepIndex, double& min, double& max)
+{
+    const RigStatistics& stats = statistics(scalarResultIndex, timeStepIndex);
+
+    min = stats.m_min;
+    max = stats.m_max;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Statistics of all the timesteps of a result, merged from the cached statistics of each timestep
+//--------------------------------------------------------------------------------------------------
+const RigStatistics& RigReservoirCellResults::statistics(size_t scalarResultIndex)
+{
+    CVF_ASSERT(scalarResultIndex < resultCount());
+
+    if (scalarResultIndex >= m_statistics.size())
     {
-        m_maxMinValues.resize(scalarResultIndex+1, std::make_pair(HUGE_VAL, -HUGE_VAL));
+        m_statistics.resize(resultCount(), std::make_pair(false, RigStatistics()));
     }
 
-    if (m_maxMinValues[scalarResultIndex].first != HUGE_VAL)
+    if (!m_statistics[scalarResultIndex].first)
     {
-        min = m_maxMinValues[scalarResultIndex].first;
-        max = m_maxMinValues[scalarResultIndex].second;
+        RigStatistics resultStatistics;
 
-        return;
-    }
+        size_t tsIdx;
+        for (tsIdx = 0; tsIdx < timeStepCount(scalarResultIndex); tsIdx++)
+        {
+            resultStatistics.add(statistics(scalarResultIndex, tsIdx));
+        }
 
-    size_t i;
-    for (i = 0; i < timeStepCount(scalarResultIndex); i++)
-    {
-        double tsmin, tsmax;
-        minMaxCellScalarValues(scalarResultIndex, i, tsmin, tsmax);
-        if (tsmin < min) min = tsmin;
-        if (tsmax > max) max = tsmax;
+        m_statistics[scalarResultIndex] = std::make_pair(true, resultStatistics);
     }
 
-    m_maxMinValues[scalarResultIndex].first = min;
-    m_maxMinValues[scalarResultIndex].second= max;
+    return m_statistics[scalarResultIndex].second;
 }
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Statistics of one timestep, computed in one parallel pass over the values and cached
 //--------------------------------------------------------------------------------------------------
-void RigReservoirCellResults::minMaxCellScalarValues(size_t scalarResultIndex, size_t timeStepIndex, double& min, double& max)
+const RigStatistics& RigReservoirCellResults::statistics(size_t scalarResultIndex, size_t timeStepIndex)
 {
-    min = HUGE_VAL;
-    max = -HUGE_VAL;
-
     CVF_ASSERT(scalarResultIndex < resultCount());
     CVF_ASSERT(timeStepIndex < m_cellScalarResults[scalarResultIndex].size() );
 
-    if (scalarResultIndex >= m_maxMinValuesPrTs.size())
+    if (scalarResultIndex >= m_statisticsPrTs.size())
     {
-        m_maxMinValuesPrTs.resize(scalarResultIndex+1);
+        m_statisticsPrTs.resize(resultCount());
     }
 
-    if (timeStepIndex >= m_maxMinValuesPrTs[scalarResultIndex].size())
+    if (timeStepIndex >= m_statisticsPrTs[scalarResultIndex].size())
     {
-        m_maxMinValuesPrTs[scalarResultIndex].resize(timeStepIndex+1, std::make_pair(HUGE_VAL, -HUGE_VAL));
+        m_statisticsPrTs[scalarResultIndex].resize(timeStepCount(scalarResultIndex), std::make_pair(false, RigStatistics()));
     }
 
-    if (m_maxMinValuesPrTs[scalarResultIndex][timeStepIndex].first != HUGE_VAL)
+    if (!m_statisticsPrTs[scalarResultIndex][timeStepIndex].first)
     {
-        min = m_maxMinValuesPrTs[scalarResultIndex][timeStepIndex].first;
-        max = m_maxMinValuesPrTs[scalarResultIndex][timeStepIndex].second;
+        RigStatistics timeStepStatistics;
 
-        return;
+        loadTimeStep(scalarResultIndex, timeStepIndex);
+        if (isSinglePrecision(scalarResultIndex, timeStepIndex))
+        {
+            timeStepStatistics.addData(m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex]);
+        }
+        else
+        {
+            timeStepStatistics.addData(m_cellScalarResults[scalarResultIndex][timeStepIndex]);
+        }
+
+        m_statisticsPrTs[scalarResultIndex][timeStepIndex] = std::make_pair(true, timeStepStatistics);
     }
 
-    std::vector<double>& values = m_cellScalarResults[scalarResultIndex][timeStepIndex];
+    return m_statisticsPrTs[scalarResultIndex][timeStepIndex].second;
+}
 
-    size_t i;
-    for (i = 0; i < values.size(); i++)
+//--------------------------------------------------------------------------------------------------
+/// Statistics of the timesteps whose statistics are computed so far, including the given timestep.
+/// Used where the statistics of all the timesteps are wanted, but reading all of them is too slow.
+/// Equals statistics(scalarResultIndex) once all the timesteps have been visited
+//--------------------------------------------------------------------------------------------------
+RigStatistics RigReservoirCellResults::visitedTimeStepsStatistics(size_t scalarResultIndex, size_t timeStepIndex)
+{
+    CVF_ASSERT(scalarResultIndex < resultCount());
+
+    if (scalarResultIndex < m_statistics.size() && m_statistics[scalarResultIndex].first)
     {
-        if (values[i] == HUGE_VAL)
-        {
-            continue;
-        }
+        return m_statistics[scalarResultIndex].second;
+    }
 
-        if (values[i] < min)
-        {
-            min = values[i];
-        }
+    RigStatistics resultStatistics = statistics(scalarResultIndex, timeStepIndex);
 
-        if (values[i] > max)
+    const std::vector< std::pair<bool, RigStatistics> >& timeStepStatistics = m_statisticsPrTs[scalarResultIndex];
+    for (size_t tsIdx = 0; tsIdx < timeStepStatistics.size(); tsIdx++)
+    {
+        if (tsIdx != timeStepIndex && timeStepStatistics[tsIdx].first)
         {
-            max = values[i];
+            resultStatistics.add(timeStepStatistics[tsIdx].second);
         }
     }
 
-    m_maxMinValuesPrTs[scalarResultIndex][timeStepIndex].first = min;
-    m_maxMinValuesPrTs[scalarResultIndex][timeStepIndex].second= max;
+    return resultStatistics;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -138,7 +165,6 @@ const std::vector<size_t>& RigReservoirCellResults::cellScalarValuesHistogram(si
     if (scalarResultIndex >= m_histograms.size() )
     {
         m_histograms.resize(resultCount());
-        m_p10p90.resize(resultCount(), std::make_pair(HUGE_VAL, HUGE_VAL));
     }
 
     if (m_histograms[scalarResultIndex].size())
@@ -155,14 +181,17 @@ const std::vector<size_t>& RigReservoirCellResults::cellScalarValuesHistogram(si
 
     for (size_t tsIdx = 0; tsIdx < this->timeStepCount(scalarResultIndex); tsIdx++)
     {
-        std::vector<double>& values = m_cellScalarResults[scalarResultIndex][tsIdx];
-
-        histCalc.addData(values);
+        loadTimeStep(scalarResultIndex, tsIdx);
+        if (isSinglePrecision(scalarResultIndex, tsIdx))
+        {
+            histCalc.addData(m_singlePrecisionCellScalarResults[scalarResultIndex][tsIdx]);
+        }
+        else
+        {
+            histCalc.addData(m_cellScalarResults[scalarResultIndex][tsIdx]);
+        }
     } 
 
-    m_p10p90[scalarResultIndex].first = histCalc.calculatePercentil(0.1);
-    m_p10p90[scalarResultIndex].second = histCalc.calculatePercentil(0.9);
-
     return m_histograms[scalarResultIndex];
 }
 
@@ -172,93 +201,559 @@ const std::vector<size_t>& RigReservoirCellResults::cellScalarValuesHistogram(si
 //--------------------------------------------------------------------------------------------------
 void RigReservoirCellResults::p10p90CellScalarValues(size_t scalarResultIndex, double& p10, double& p90)
 {
-    const std::vector<size_t>& histogr = cellScalarValuesHistogram( scalarResultIndex);
-    p10 = m_p10p90[scalarResultIndex].first;
-    p90 = m_p10p90[scalarResultIndex].second;
+    const RigStatistics& stats = statistics(scalarResultIndex);
+
+    p10 = stats.m_quantiles.quantile(0.1);
+    p90 = stats.m_quantiles.quantile(0.9);
 }
 
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::p10p90CellScalarValues(size_t scalarResultIndex, size_t timeStepIndex, double& p10, double& p90)
+{
+    const RigStatistics& stats = statistics(scalarResultIndex, timeStepIndex);
+
+    p10 = stats.m_quantiles.quantile(0.1);
+    p90 = stats.m_quantiles.quantile(0.9);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Mean of the defined values of all the timesteps. Undefined (HUGE_VAL) values are not counted.
+//--------------------------------------------------------------------------------------------------
 void RigReservoirCellResults::meanCellScalarValues(size_t scalarResultIndex, double& meanValue)
 {
-    CVF_ASSERT(scalarResultIndex < resultCount());
+    meanValue = statistics(scalarResultIndex).mean();
+}
 
-    // Extend array and cache vars
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+size_t RigReservoirCellResults::resultCount() const
+{
+	return m_cellScalarResults.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+size_t RigReservoirCellResults::timeStepCount(size_t scalarResultIndex) const
+{
+    CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+
+    return m_cellScalarResults[scalarResultIndex].size();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+/// Access to all the timesteps of a result. Timesteps not loaded yet are read, and the result is 
+/// no longer subject to unloading, as the caller might modify or keep references to the data.
+/// All the timesteps are converted to double precision, as the caller gets them all as doubles.
+//--------------------------------------------------------------------------------------------------
+std::vector< std::vector<double> > & RigReservoirCellResults::cellScalarResults( size_t scalarResultIndex )
+{
+	CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+
+    if (m_resultInfos[scalarResultIndex].m_loadFramesOnDemand)
+    {
+        loadAllFrames(scalarResultIndex);
+    }
 
-    if (scalarResultIndex >= m_meanValues.size() )
+    if (m_resultInfos[scalarResultIndex].m_isSinglePrecision)
     {
-        m_meanValues.resize(scalarResultIndex+1, HUGE_VAL);
+        bool hasPinnedFrames = false;
+        for (size_t tsIdx = 0; tsIdx < timeStepCount(scalarResultIndex); ++tsIdx)
+        {
+            convertToDoublePrecision(scalarResultIndex, tsIdx);
+            hasPinnedFrames = hasPinnedFrames || isFramePinned(scalarResultIndex, tsIdx);
+        }
+
+        // The caller might resize the timesteps, so the single precision storage is dropped 
+        // unless data access objects still reference some of it
+        if (!hasPinnedFrames)
+        {
+            m_singlePrecisionCellScalarResults[scalarResultIndex].clear();
+            m_resultInfos[scalarResultIndex].m_isSinglePrecision = false;
+        }
     }
 
-    if (m_meanValues[scalarResultIndex] != HUGE_VAL)
+	return m_cellScalarResults[scalarResultIndex];
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Access to the values of one timestep. The timestep is read from file if needed, which might
+/// unload the least recently used timesteps to stay within the frame memory budget.
+/// The returned reference is valid until the next timestep is loaded, unless the timestep is pinned.
+/// Only this timestep is converted if it is stored in single precision.
+//--------------------------------------------------------------------------------------------------
+std::vector<double> & RigReservoirCellResults::cellScalarResults(size_t scalarResultIndex, size_t timeStepIndex)
+{
+    CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+    CVF_TIGHT_ASSERT(timeStepIndex < m_cellScalarResults[scalarResultIndex].size());
+
+    loadTimeStep(scalarResultIndex, timeStepIndex);
+
+    if (isSinglePrecision(scalarResultIndex, timeStepIndex))
     {
-        meanValue = m_meanValues[scalarResultIndex];
-        return;
+        convertToDoublePrecision(scalarResultIndex, timeStepIndex);
+        unloadLeastRecentlyUsedFrames();
     }
 
-    double valueSum = 0.0;
-    size_t count = 0;
-    for (size_t tIdx = 0; tIdx < timeStepCount(scalarResultIndex); tIdx++)
+    return m_cellScalarResults[scalarResultIndex][timeStepIndex];
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Access to the values of one timestep of a single precision result, loading it like
+/// cellScalarResults(). Must only be used when isSinglePrecision() is true for the timestep after loadTimeStep()
+//--------------------------------------------------------------------------------------------------
+const std::vector<float> & RigReservoirCellResults::singlePrecisionCellScalarResults(size_t scalarResultIndex, size_t timeStepIndex)
+{
+    CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+    CVF_TIGHT_ASSERT(timeStepIndex < m_cellScalarResults[scalarResultIndex].size());
+
+    loadTimeStep(scalarResultIndex, timeStepIndex);
+
+    CVF_ASSERT(isSinglePrecision(scalarResultIndex, timeStepIndex));
+
+    return m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex];
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Make sure the timestep is present. The timestep is read from file if needed, which might
+/// unload the least recently used timesteps to stay within the frame memory budget.
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::loadTimeStep(size_t scalarResultIndex, size_t timeStepIndex)
+{
+    CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+    CVF_TIGHT_ASSERT(timeStepIndex < m_cellScalarResults[scalarResultIndex].size());
+
+    if (m_resultInfos[scalarResultIndex].m_loadFramesOnDemand)
     {
-        std::vector<double>& values = m_cellScalarResults[scalarResultIndex][tIdx];
-        for (size_t cIdx = 0; cIdx < values.size(); ++cIdx)
+        bool isNewlyLoaded = false;
+        if (m_frameLastAccess[scalarResultIndex][timeStepIndex] == 0)
+        {
+            isNewlyLoaded = loadFrame(scalarResultIndex, timeStepIndex);
+        }
+
+        m_frameLastAccess[scalarResultIndex][timeStepIndex] = ++m_frameAccessCounter;
+
+        if (isNewlyLoaded)
         {
-            valueSum += values[cIdx];
+            unloadLeastRecentlyUsedFrames();
         }
-        count += values.size();
     }
+}
 
-    m_meanValues[scalarResultIndex] = valueSum/count;
-    meanValue = m_meanValues[scalarResultIndex];
+//--------------------------------------------------------------------------------------------------
+/// Whether the values of the timestep are present without reading them. Timesteps of results that 
+/// are not loaded on demand are always present
+//--------------------------------------------------------------------------------------------------
+bool RigReservoirCellResults::isTimeStepLoaded(size_t scalarResultIndex, size_t timeStepIndex) const
+{
+    CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+    CVF_TIGHT_ASSERT(timeStepIndex < m_cellScalarResults[scalarResultIndex].size());
+
+    if (!m_resultInfos[scalarResultIndex].m_loadFramesOnDemand) return true;
+
+    return m_frameLastAccess[scalarResultIndex][timeStepIndex] != 0;
 }
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Release the values of a timestep loaded on demand, when the caller knows it is not needed again 
+/// soon. Pinned timesteps, and timesteps of results that are not loaded on demand, are kept
 //--------------------------------------------------------------------------------------------------
-size_t RigReservoirCellResults::resultCount() const
+void RigReservoirCellResults::unloadTimeStep(size_t scalarResultIndex, size_t timeStepIndex)
 {
-	return m_cellScalarResults.size();
+    CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+    CVF_TIGHT_ASSERT(timeStepIndex < m_cellScalarResults[scalarResultIndex].size());
+
+    if (!m_resultInfos[scalarResultIndex].m_loadFramesOnDemand) return;
+    if (m_frameLastAccess[scalarResultIndex][timeStepIndex] == 0) return;
+    if (isFramePinned(scalarResultIndex, timeStepIndex)) return;
+
+    unloadFrame(scalarResultIndex, timeStepIndex);
 }
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Keep the timestep loaded until unpinned, regardless of the memory budget. Used by data access 
+/// objects, which reference the values of the timestep. Pins are counted
 //--------------------------------------------------------------------------------------------------
-size_t RigReservoirCellResults::timeStepCount(size_t scalarResultIndex) const
+void RigReservoirCellResults::pinFrame(size_t scalarResultIndex, size_t timeStepIndex)
 {
     CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+    CVF_TIGHT_ASSERT(timeStepIndex < m_cellScalarResults[scalarResultIndex].size());
 
-    return m_cellScalarResults[scalarResultIndex].size();
+    if (m_framePinCounts.size() < resultCount())
+    {
+        m_framePinCounts.resize(resultCount());
+    }
+
+    if (m_framePinCounts[scalarResultIndex].size() <= timeStepIndex)
+    {
+        m_framePinCounts[scalarResultIndex].resize(timeStepCount(scalarResultIndex), 0);
+    }
+
+    m_framePinCounts[scalarResultIndex][timeStepIndex]++;
 }
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Release a pin set by pinFrame(). When the last pin is released, the single precision values kept
+/// for the data access objects are dropped if the timestep has been converted to double precision
+/// meanwhile, and the memory budget is enforced again.
 //--------------------------------------------------------------------------------------------------
-std::vector< std::vector<double> > & RigReservoirCellResults::cellScalarResults( size_t scalarResultIndex )
+void RigReservoirCellResults::unpinFrame(size_t scalarResultIndex, size_t timeStepIndex)
 {
-	CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+    CVF_ASSERT(isFramePinned(scalarResultIndex, timeStepIndex));
 
-	return m_cellScalarResults[scalarResultIndex];
+    m_framePinCounts[scalarResultIndex][timeStepIndex]--;
+
+    if (!isFramePinned(scalarResultIndex, timeStepIndex))
+    {
+        if (!isSinglePrecision(scalarResultIndex, timeStepIndex))
+        {
+            releaseSinglePrecisionCopy(scalarResultIndex, timeStepIndex);
+        }
+
+        unloadLeastRecentlyUsedFrames();
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
-double RigReservoirCellResults::cellScalarResult(size_t timeStepIndex, size_t scalarResultIndex, size_t resultValueIndex)
+bool RigReservoirCellResults::isFramePinned(size_t scalarResultIndex, size_t timeStepIndex) const
+{
+    if (scalarResultIndex >= m_framePinCounts.size()) return false;
+    if (timeStepIndex >= m_framePinCounts[scalarResultIndex].size()) return false;
+
+    return m_framePinCounts[scalarResultIndex][timeStepIndex] > 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Replace all the timesteps of a result at once by swapping in the given values, so the result is 
+/// never seen partially updated. The old values are returned in values. Timesteps of an on demand 
+/// result are released instead of being read, and the result is kept resident from now on.
+/// Single precision values of pinned timesteps are kept until unpinned, as data access objects reference them.
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::replaceCellScalarResults(size_t scalarResultIndex, std::vector< std::vector<double> >* values)
+{
+    CVF_TIGHT_ASSERT(scalarResultIndex < resultCount());
+    CVF_ASSERT(values);
+
+    if (m_resultInfos[scalarResultIndex].m_loadFramesOnDemand)
+    {
+        for (size_t tsIdx = 0; tsIdx < m_cellScalarResults[scalarResultIndex].size(); ++tsIdx)
+        {
+            if (isFramePinned(scalarResultIndex, tsIdx))
+            {
+                // No longer counted as an on demand timestep
+                m_loadedFrameMemory -= frameByteCount(scalarResultIndex, tsIdx);
+            }
+            else
+            {
+                unloadFrame(scalarResultIndex, tsIdx);
+            }
+        }
+
+        m_resultInfos[scalarResultIndex].m_loadFramesOnDemand = false;
+        m_resultInfos[scalarResultIndex].m_isComputedSOIL = false;
+        m_frameLastAccess[scalarResultIndex].clear();
+    }
+
+    std::vector< std::vector<float> >& singlePrecisionFrames = m_singlePrecisionCellScalarResults[scalarResultIndex];
+
+    bool hasPinnedFrames = false;
+    for (size_t tsIdx = 0; tsIdx < singlePrecisionFrames.size(); ++tsIdx)
+    {
+        if (isFramePinned(scalarResultIndex, tsIdx))
+        {
+            hasPinnedFrames = true;
+        }
+        else
+        {
+            std::vector<float>().swap(singlePrecisionFrames[tsIdx]);
+        }
+    }
+
+    if (!hasPinnedFrames)
+    {
+        singlePrecisionFrames.clear();
+    }
+
+    m_resultInfos[scalarResultIndex].m_isSinglePrecision = false;
+
+    m_cellScalarResults[scalarResultIndex].swap(*values);
+
+    recalculateMinMax(scalarResultIndex);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Value of one cell in a timestep. The timestep must be loaded by loadTimeStep() first, as this 
+/// method is called for each cell, possibly from several threads, and never loads or unloads anything.
+/// Returns HUGE_VAL for timesteps that are not loaded.
+//--------------------------------------------------------------------------------------------------
+double RigReservoirCellResults::cellScalarResult(size_t timeStepIndex, size_t scalarResultIndex, size_t resultValueIndex) const
 {
     if (scalarResultIndex < resultCount() &&
         timeStepIndex < m_cellScalarResults[scalarResultIndex].size() &&
-        resultValueIndex != cvf::UNDEFINED_SIZE_T &&
-        resultValueIndex < m_cellScalarResults[scalarResultIndex][timeStepIndex].size())
+        resultValueIndex != cvf::UNDEFINED_SIZE_T)
+    {
+        if (isSinglePrecision(scalarResultIndex, timeStepIndex))
+        {
+            const std::vector<float>& values = m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex];
+            if (resultValueIndex < values.size()) return values[resultValueIndex];
+        }
+        else
+        {
+            const std::vector<double>& values = m_cellScalarResults[scalarResultIndex][timeStepIndex];
+            if (resultValueIndex < values.size()) return values[resultValueIndex];
+        }
+    }
+
+    return HUGE_VAL;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Set the max number of bytes to be used by dynamic results read on demand. Zero means unlimited.
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::setFrameMemoryBudget(size_t byteCount)
+{
+    m_frameMemoryBudget = byteCount;
+    unloadLeastRecentlyUsedFrames();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Read the values of one timestep of an on demand result from the reader.
+/// Returns whether the timestep actually occupies memory afterwards.
+//--------------------------------------------------------------------------------------------------
+bool RigReservoirCellResults::loadFrame(size_t scalarResultIndex, size_t timeStepIndex)
+{
+    CVF_ASSERT(frameValueCount(scalarResultIndex, timeStepIndex) == 0);
+
+    const QString& resultName = m_resultInfos[scalarResultIndex].m_resultName;
+
+    if (m_resultInfos[scalarResultIndex].m_isComputedSOIL)
+    {
+        std::vector<double> soilValues;
+        computeSOILFrame(timeStepIndex, &soilValues);
+        storeFrame(scalarResultIndex, timeStepIndex, &soilValues);
+
+        size_t byteCount = frameByteCount(scalarResultIndex, timeStepIndex);
+        m_loadedFrameMemory += byteCount;
+
+        return byteCount > 0;
+    }
+
+    // Single precision values are taken as they are when the reader has them, instead of going through double
+    if (m_readerInterface.notNull() && m_resultInfos[scalarResultIndex].m_isSinglePrecision)
+    {
+        std::vector<float>& frame = m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex];
+        if (m_readerInterface->singlePrecisionDynamicResult(resultName, RifReaderInterface::MATRIX_RESULTS, timeStepIndex, &frame) && frame.size() > 0)
+        {
+            size_t byteCount = frameByteCount(scalarResultIndex, timeStepIndex);
+            m_loadedFrameMemory += byteCount;
+
+            return true;
+        }
+
+        frame.clear();
+    }
+
+    std::vector<double> values;
+    if (m_readerInterface.notNull())
+    {
+        if (!m_readerInterface->dynamicResult(resultName, RifReaderInterface::MATRIX_RESULTS, timeStepIndex, &values))
+        {
+            values.clear();
+        }
+    }
+
+    storeFrame(scalarResultIndex, timeStepIndex, &values);
+
+    size_t byteCount = frameByteCount(scalarResultIndex, timeStepIndex);
+    m_loadedFrameMemory += byteCount;
+
+    return byteCount > 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::unloadFrame(size_t scalarResultIndex, size_t timeStepIndex)
+{
+    size_t byteCount = frameByteCount(scalarResultIndex, timeStepIndex);
+
+    CVF_ASSERT(m_loadedFrameMemory >= byteCount);
+    m_loadedFrameMemory -= byteCount;
+
+    // Swap with an empty vector to actually release the memory
+    std::vector<double>().swap(m_cellScalarResults[scalarResultIndex][timeStepIndex]);
+
+    if (timeStepIndex < m_singlePrecisionCellScalarResults[scalarResultIndex].size())
     {
-        return m_cellScalarResults[scalarResultIndex][timeStepIndex][resultValueIndex];
+        std::vector<float>().swap(m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex]);
+    }
+
+    m_frameLastAccess[scalarResultIndex][timeStepIndex] = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+size_t RigReservoirCellResults::frameValueCount(size_t scalarResultIndex, size_t timeStepIndex) const
+{
+    if (isSinglePrecision(scalarResultIndex, timeStepIndex))
+    {
+        return m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex].size();
+    }
+
+    return m_cellScalarResults[scalarResultIndex][timeStepIndex].size();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Memory used by the timestep, including single precision values kept for data access objects
+/// after the timestep was converted to double precision
+//--------------------------------------------------------------------------------------------------
+size_t RigReservoirCellResults::frameByteCount(size_t scalarResultIndex, size_t timeStepIndex) const
+{
+    size_t byteCount = m_cellScalarResults[scalarResultIndex][timeStepIndex].size() * sizeof(double);
+
+    if (timeStepIndex < m_singlePrecisionCellScalarResults[scalarResultIndex].size())
+    {
+        byteCount += m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex].size() * sizeof(float);
+    }
+
+    return byteCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Move values read from file into the timestep. A timestep of a single precision result is stored
+/// in double precision if any of its values can not be represented exactly as float.
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::storeFrame(size_t scalarResultIndex, size_t timeStepIndex, std::vector<double>* values)
+{
+    CVF_ASSERT(values);
+
+    bool storeAsFloat = m_resultInfos[scalarResultIndex].m_isSinglePrecision;
+    for (size_t i = 0; storeAsFloat && i < values->size(); ++i)
+    {
+        double value = (*values)[i];
+        if (static_cast<double>(static_cast<float>(value)) != value)
+        {
+            storeAsFloat = false;
+        }
+    }
+
+    if (storeAsFloat)
+    {
+        std::vector<float>& frame = m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex];
+        frame.assign(values->begin(), values->end());
     }
     else
     {
-        return HUGE_VAL;
+        m_cellScalarResults[scalarResultIndex][timeStepIndex].swap(*values);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Convert one single precision timestep to double precision. The single precision values are kept
+/// while the timestep is pinned, as data access objects reference them.
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::convertToDoublePrecision(size_t scalarResultIndex, size_t timeStepIndex)
+{
+    if (!isSinglePrecision(scalarResultIndex, timeStepIndex)) return;
+
+    size_t byteCount = frameByteCount(scalarResultIndex, timeStepIndex);
+
+    const std::vector<float>& frame = m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex];
+    m_cellScalarResults[scalarResultIndex][timeStepIndex].assign(frame.begin(), frame.end());
+
+    if (m_resultInfos[scalarResultIndex].m_loadFramesOnDemand)
+    {
+        m_loadedFrameMemory += frameByteCount(scalarResultIndex, timeStepIndex) - byteCount;
+    }
+
+    if (!isFramePinned(scalarResultIndex, timeStepIndex))
+    {
+        releaseSinglePrecisionCopy(scalarResultIndex, timeStepIndex);
     }
 }
 
+//--------------------------------------------------------------------------------------------------
+/// Drop the single precision values of a timestep that has been converted to double precision
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::releaseSinglePrecisionCopy(size_t scalarResultIndex, size_t timeStepIndex)
+{
+    if (timeStepIndex >= m_singlePrecisionCellScalarResults[scalarResultIndex].size()) return;
+
+    std::vector<float>& frame = m_singlePrecisionCellScalarResults[scalarResultIndex][timeStepIndex];
+
+    if (m_resultInfos[scalarResultIndex].m_loadFramesOnDemand)
+    {
+        CVF_ASSERT(m_loadedFrameMemory >= frame.size() * sizeof(float));
+        m_loadedFrameMemory -= frame.size() * sizeof(float);
+    }
+
+    std::vector<float>().swap(frame);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Unload on demand timesteps, least recently used first, until the memory budget is met.
+/// The most recently used timestep, and timesteps pinned by data access objects, are always kept.
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::unloadLeastRecentlyUsedFrames()
+{
+    if (m_frameMemoryBudget == 0) return;
+
+    while (m_loadedFrameMemory > m_frameMemoryBudget)
+    {
+        size_t lruResultIndex = cvf::UNDEFINED_SIZE_T;
+        size_t lruTimeStepIndex = cvf::UNDEFINED_SIZE_T;
+        size_t lruAccess = m_frameAccessCounter;
+
+        for (size_t resIdx = 0; resIdx < m_frameLastAccess.size(); ++resIdx)
+        {
+            const std::vector<size_t>& lastAccess = m_frameLastAccess[resIdx];
+            for (size_t tsIdx = 0; tsIdx < lastAccess.size(); ++tsIdx)
+            {
+                if (lastAccess[tsIdx] != 0 && lastAccess[tsIdx] < lruAccess && frameValueCount(resIdx, tsIdx) > 0
+                    && !isFramePinned(resIdx, tsIdx))
+                {
+                    lruAccess = lastAccess[tsIdx];
+                    lruResultIndex = resIdx;
+                    lruTimeStepIndex = tsIdx;
+                }
+            }
+        }
+
+        if (lruResultIndex == cvf::UNDEFINED_SIZE_T) break;
+
+        unloadFrame(lruResultIndex, lruTimeStepIndex);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Load the remaining timesteps of an on demand result, and keep them resident from now on
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::loadAllFrames(size_t scalarResultIndex)
+{
+    CVF_ASSERT(m_resultInfos[scalarResultIndex].m_loadFramesOnDemand);
+
+    for (size_t tsIdx = 0; tsIdx < timeStepCount(scalarResultIndex); ++tsIdx)
+    {
+        if (m_frameLastAccess[scalarResultIndex][tsIdx] == 0)
+        {
+            loadFrame(scalarResultIndex, tsIdx);
+        }
+
+        m_loadedFrameMemory -= frameByteCount(scalarResultIndex, tsIdx);
+    }
+
+    m_resultInfos[scalarResultIndex].m_loadFramesOnDemand = false;
+    m_frameLastAccess[scalarResultIndex].clear();
+}
+
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
@@ -270,7 +765,7 @@ size_t RigReservoirCellResults::findOrLoadScalarResult(RimDefines::ResultCatType
 
     if (resultGridIndex == cvf::UNDEFINED_SIZE_T)  return cvf::UNDEFINED_SIZE_T;
 
-    if (cellScalarResults(resultGridIndex).size()) return resultGridIndex;
+    if (m_cellScalarResults[resultGridIndex].size()) return resultGridIndex;
 
     if (type == RimDefines::GENERATED)
     {
@@ -284,26 +779,45 @@ size_t RigReservoirCellResults::findOrLoadScalarResult(RimDefines::ResultCatType
 
         bool resultLoadingSucess = true;
 
+        // Results read from file are kept in single precision as long as the values allow it
+
         if (type == RimDefines::DYNAMIC_NATIVE && timeStepCount > 0)
         {
+            // Only the first timestep is read now, to verify that the result is available. 
+            // The rest are read when asked for.
+
             m_cellScalarResults[resultGridIndex].resize(timeStepCount);
+            m_singlePrecisionCellScalarResults[resultGridIndex].resize(timeStepCount);
+            m_resultInfos[resultGridIndex].m_isSinglePrecision = true;
 
-            size_t i;
-            for (i = 0; i < timeStepCount; i++)
+            if (m_frameLastAccess.size() < resultCount())
             {
-                std::vector<double>& values = m_cellScalarResults[resultGridIndex][i];
-                if (!m_readerInterface->dynamicResult(resultName, RifReaderInterface::MATRIX_RESULTS, i, &values))
-                {
-                    resultLoadingSucess = false;
-                }
+                m_frameLastAccess.resize(resultCount());
+            }
+            m_frameLastAccess[resultGridIndex].resize(timeStepCount, 0);
+            m_resultInfos[resultGridIndex].m_loadFramesOnDemand = true;
+
+            loadTimeStep(resultGridIndex, 0);
+            if (frameValueCount(resultGridIndex, 0) == 0)
+            {
+                resultLoadingSucess = false;
+
+                m_resultInfos[resultGridIndex].m_loadFramesOnDemand = false;
+                m_frameLastAccess[resultGridIndex].clear();
             }
         }
         else if (type == RimDefines::STATIC_NATIVE)
         {
             m_cellScalarResults[resultGridIndex].resize(1);
+            m_singlePrecisionCellScalarResults[resultGridIndex].resize(1);
+            m_resultInfos[resultGridIndex].m_isSinglePrecision = true;
 
-            std::vector<double>& values = m_cellScalarResults[resultGridIndex][0];
-            if (!m_readerInterface->staticResult(resultName, RifReaderInterface::MATRIX_RESULTS, &values))
+            std::vector<double> values;
+            if (m_readerInterface->staticResult(resultName, RifReaderInterface::MATRIX_RESULTS, &values))
+            {
+                storeFrame(resultGridIndex, 0, &values);
+            }
+            else
             {
                 resultLoadingSucess = false;
             }
@@ -313,6 +827,8 @@ size_t RigReservoirCellResults::findOrLoadScalarResult(RimDefines::ResultCatType
         {
             // Remove last scalar result because loading of result failed
             m_cellScalarResults[resultGridIndex].clear();
+            m_singlePrecisionCellScalarResults[resultGridIndex].clear();
+            m_resultInfos[resultGridIndex].m_isSinglePrecision = false;
         }
     }
 
@@ -371,8 +887,27 @@ size_t RigReservoirCellResults::findScalarResultIndex(const QString& resultName)
     return scalarResultIndex;
 }
 
+namespace
+{
+    //--------------------------------------------------------------------------------------------------
+    /// Subtract values from the corresponding target values, ignoring values beyond the target size
+    //--------------------------------------------------------------------------------------------------
+    template <typename T>
+    void subtractValues(const std::vector<T>& values, std::vector<double>* targetValues)
+    {
+        int valueCount = static_cast<int>(qMin(targetValues->size(), values.size()));
+
+#pragma omp parallel for
+        for (int idx = 0; idx < valueCount; idx++)
+        {
+            (*targetValues)[idx] -= values[idx];
+        }
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Make SOIL available. If it is not in the result files, it is added as a result computed from 
+/// SWAT and SGAS one timestep at a time when used, like timesteps read on demand
 //--------------------------------------------------------------------------------------------------
 void RigReservoirCellResults::loadOrComputeSOIL()
 {
@@ -389,62 +924,89 @@ void RigReservoirCellResults::loadOrComputeSOIL()
             return;
         }
 
-        soilResultGridIndex = addEmptyScalarResult(RimDefines::DYNAMIC_NATIVE, "SOIL");
-
-        const std::vector< std::vector<double> >* swat = NULL;
-        const std::vector< std::vector<double> >* sgas = NULL;
+        size_t soilTimeStepCount = 0;
         if (scalarIndexSWAT != cvf::UNDEFINED_SIZE_T)
         {
-            swat = &(cellScalarResults(scalarIndexSWAT));
+            soilTimeStepCount = timeStepCount(scalarIndexSWAT);
         }
 
         if (scalarIndexSGAS != cvf::UNDEFINED_SIZE_T)
         {
-            sgas = &(cellScalarResults(scalarIndexSGAS));
+            soilTimeStepCount = qMax(soilTimeStepCount, timeStepCount(scalarIndexSGAS));
         }
 
-        size_t soilResultValueCount = 0;
-        size_t soilTimeStepCount = 0;
-        if (swat)
-        {
-            soilResultValueCount = swat->at(0).size();
-            soilTimeStepCount = m_resultInfos[scalarIndexSWAT].m_timeStepDates.size();
-        }
+        soilResultGridIndex = addEmptyScalarResult(RimDefines::DYNAMIC_NATIVE, "SOIL");
 
-        if (sgas)
+        m_cellScalarResults[soilResultGridIndex].resize(soilTimeStepCount);
+
+        if (m_frameLastAccess.size() < resultCount())
         {
-            soilResultValueCount = qMax(soilResultValueCount, sgas->at(0).size());
-            
-            size_t sgasTimeStepCount = m_resultInfos[scalarIndexSGAS].m_timeStepDates.size();
-            soilTimeStepCount = qMax(soilTimeStepCount, sgasTimeStepCount);
+            m_frameLastAccess.resize(resultCount());
         }
+        m_frameLastAccess[soilResultGridIndex].resize(soilTimeStepCount, 0);
 
-        m_cellScalarResults[soilResultGridIndex].resize(soilTimeStepCount);
+        m_resultInfos[soilResultGridIndex].m_loadFramesOnDemand = true;
+        m_resultInfos[soilResultGridIndex].m_isComputedSOIL = true;
+    }
+}
 
-        std::vector< std::vector<double> >& soil = cellScalarResults(soilResultGridIndex);
+//--------------------------------------------------------------------------------------------------
+/// Compute one timestep of SOIL as 1 - SGAS - SWAT. The SGAS timestep is pinned while SWAT is 
+/// loaded, as loading might unload other timesteps to stay within the memory budget
+//--------------------------------------------------------------------------------------------------
+void RigReservoirCellResults::computeSOILFrame(size_t timeStepIndex, std::vector<double>* soilValues)
+{
+    CVF_ASSERT(soilValues);
 
-        int timeStepIdx = 0;
-        for (timeStepIdx = 0; timeStepIdx < static_cast<int>(soilTimeStepCount); timeStepIdx++)
-        {
-            soil[timeStepIdx].resize(soilResultValueCount);
+    size_t scalarIndexSWAT = findScalarResultIndex(RimDefines::DYNAMIC_NATIVE, "SWAT");
+    size_t scalarIndexSGAS = findScalarResultIndex(RimDefines::DYNAMIC_NATIVE, "SGAS");
 
-#pragma omp parallel for
-            for (int idx = 0; idx < static_cast<int>(soilResultValueCount); idx++)
-            {
-                double soilValue = 1.0;
-                if (sgas)
-                {
-                    soilValue -= sgas->at(timeStepIdx)[idx];
-                }
+    bool hasSwat = scalarIndexSWAT != cvf::UNDEFINED_SIZE_T && timeStepIndex < timeStepCount(scalarIndexSWAT);
+    bool hasSgas = scalarIndexSGAS != cvf::UNDEFINED_SIZE_T && timeStepIndex < timeStepCount(scalarIndexSGAS);
 
-                if (swat)
-                {
-                    soilValue -= swat->at(timeStepIdx)[idx];
-                }
+    size_t soilResultValueCount = 0;
+    if (hasSgas)
+    {
+        loadTimeStep(scalarIndexSGAS, timeStepIndex);
+        pinFrame(scalarIndexSGAS, timeStepIndex);
+        soilResultValueCount = frameValueCount(scalarIndexSGAS, timeStepIndex);
+    }
 
-                soil[timeStepIdx][idx] = soilValue;
-            }
+    if (hasSwat)
+    {
+        loadTimeStep(scalarIndexSWAT, timeStepIndex);
+        soilResultValueCount = qMax(soilResultValueCount, frameValueCount(scalarIndexSWAT, timeStepIndex));
+    }
+
+    soilValues->resize(soilResultValueCount, 1.0);
+
+    if (hasSgas)
+    {
+        if (isSinglePrecision(scalarIndexSGAS, timeStepIndex))
+        {
+            subtractValues(m_singlePrecisionCellScalarResults[scalarIndexSGAS][timeStepIndex], soilValues);
+        }
+        else
+        {
+            subtractValues(m_cellScalarResults[scalarIndexSGAS][timeStepIndex], soilValues);
+        }
+    }
+
+    if (hasSwat)
+    {
+        if (isSinglePrecision(scalarIndexSWAT, timeStepIndex))
+        {
+            subtractValues(m_singlePrecisionCellScalarResults[scalarIndexSWAT][timeStepIndex], soilValues);
         }
+        else
+        {
+            subtractValues(m_cellScalarResults[scalarIndexSWAT][timeStepIndex], soilValues);
+        }
+    }
+
+    if (hasSgas)
+    {
+        unpinFrame(scalarIndexSGAS, timeStepIndex);
     }
 }
 
@@ -505,12 +1067,13 @@ void RigReservoirCellResults::computeDepthRelatedResults()
         computeBottom = true;
     }
 
-    std::vector< std::vector<double> >& depth   = cellScalarResults(depthResultGridIndex);
-    std::vector< std::vector<double> >& dx      = cellScalarResults(dxResultGridIndex);
-    std::vector< std::vector<double> >& dy      = cellScalarResults(dyResultGridIndex);
-    std::vector< std::vector<double> >& dz      = cellScalarResults(dzResultGridIndex);
-    std::vector< std::vector<double> >& tops    = cellScalarResults(topsResultGridIndex);
-    std::vector< std::vector<double> >& bottom  = cellScalarResults(bottomResultGridIndex);
+    // Only the computed results are accessed, leaving results read from file in single precision
+    std::vector<double>* depth   = computeDepth  ? &(cellScalarResults(depthResultGridIndex)[0])  : NULL;
+    std::vector<double>* dx      = computeDx     ? &(cellScalarResults(dxResultGridIndex)[0])     : NULL;
+    std::vector<double>* dy      = computeDy     ? &(cellScalarResults(dyResultGridIndex)[0])     : NULL;
+    std::vector<double>* dz      = computeDz     ? &(cellScalarResults(dzResultGridIndex)[0])     : NULL;
+    std::vector<double>* tops    = computeTops   ? &(cellScalarResults(topsResultGridIndex)[0])   : NULL;
+    std::vector<double>* bottom  = computeBottom ? &(cellScalarResults(bottomResultGridIndex)[0]) : NULL;
     
     bool computeValuesForActiveCellsOnly = m_ownerMainGrid->globalMatrixModelActiveCellCount() > 0;
 
@@ -526,35 +1089,35 @@ void RigReservoirCellResults::computeDepthRelatedResults()
 
         if (computeDepth)
         {
-            depth[0][cellIdx] = cvf::Math::abs(cell.center().z());
+            (*depth)[cellIdx] = cvf::Math::abs(cell.center().z());
         }
 
         if (computeDx)
         {
             cvf::Vec3d cellWidth = cell.faceCenter(cvf::StructGridInterface::NEG_I) - cell.faceCenter(cvf::StructGridInterface::POS_I);
-            dx[0][cellIdx] =  cvf::Math::abs(cellWidth.x());
+            (*dx)[cellIdx] =  cvf::Math::abs(cellWidth.x());
         }
 
         if (computeDy)
         {
             cvf::Vec3d cellWidth = cell.faceCenter(cvf::StructGridInterface::NEG_J) - cell.faceCenter(cvf::StructGridInterface::POS_J);
-            dy[0][cellIdx] =  cvf::Math::abs(cellWidth.y());
+            (*dy)[cellIdx] =  cvf::Math::abs(cellWidth.y());
         }
 
         if (computeDz)
         {
             cvf::Vec3d cellWidth = cell.faceCenter(cvf::StructGridInterface::NEG_K) - cell.faceCenter(cvf::StructGridInterface::POS_K);
-            dz[0][cellIdx] = cvf::Math::abs(cellWidth.z());
+            (*dz)[cellIdx] = cvf::Math::abs(cellWidth.z());
         }
 
         if (computeTops)
         {
-            tops[0][cellIdx] = cvf::Math::abs(cell.faceCenter(cvf::StructGridInterface::NEG_K).z());
+            (*tops)[cellIdx] = cvf::Math::abs(cell.faceCenter(cvf::StructGridInterface::NEG_K).z());
         }
 
         if (computeBottom)
         {
-            bottom[0][cellIdx] = cvf::Math::abs(cell.faceCenter(cvf::StructGridInterface::POS_K).z());
+            (*bottom)[cellIdx] = cvf::Math::abs(cell.faceCenter(cvf::StructGridInterface::POS_K).z());
         }
     }
 }
@@ -600,6 +1163,7 @@ size_t RigReservoirCellResults::addEmptyScalarResult(RimDefines::ResultCatType t
     {
         scalarResultIndex = this->resultCount();
         m_cellScalarResults.push_back(std::vector<std::vector<double> >());
+        m_singlePrecisionCellScalarResults.push_back(std::vector<std::vector<float> >());
         ResultInfo resInfo(type, resultName, scalarResultIndex);
         m_resultInfos.push_back(resInfo);
     }
@@ -629,17 +1193,22 @@ QStringList RigReservoirCellResults::resultNames(RimDefines::ResultCatType resTy
 //--------------------------------------------------------------------------------------------------
 void RigReservoirCellResults::recalculateMinMax(size_t scalarResultIndex)
 {
-    // Make sure cached max min values are recalculated next time asked for, since
+    // Make sure cached statistics are recalculated next time asked for, since
     // the data could be changed.
 
-    if (scalarResultIndex < m_maxMinValues.size())
+    if (scalarResultIndex < m_statistics.size())
+    {
+        m_statistics[scalarResultIndex].first = false;
+    }
+
+    if (scalarResultIndex < m_statisticsPrTs.size())
     {
-        m_maxMinValues[scalarResultIndex] = std::make_pair(HUGE_VAL, -HUGE_VAL);
+        m_statisticsPrTs[scalarResultIndex].clear();
     }
 
-    if (scalarResultIndex < m_maxMinValuesPrTs.size())
+    if (scalarResultIndex < m_histograms.size())
     {
-        m_maxMinValuesPrTs[scalarResultIndex].clear();
+        m_histograms[scalarResultIndex].clear();
     }
 }
 
@@ -650,9 +1219,14 @@ bool RigReservoirCellResults::isUsingGlobalActiveIndex(size_t scalarResultIndex)
 {
     CVF_TIGHT_ASSERT(scalarResultIndex < m_cellScalarResults.size());
 
-    if (!m_cellScalarResults[scalarResultIndex].size()) return true;
+    // Use the first loaded timestep, as timesteps read on demand might not be present
+
+    size_t tsIdx = 0;
+    while (tsIdx < timeStepCount(scalarResultIndex) && frameValueCount(scalarResultIndex, tsIdx) == 0) ++tsIdx;
+
+    if (tsIdx == timeStepCount(scalarResultIndex)) return true;
     
-    size_t firstTimeStepResultValueCount = m_cellScalarResults[scalarResultIndex][0].size();
+    size_t firstTimeStepResultValueCount = frameValueCount(scalarResultIndex, tsIdx);
     if (firstTimeStepResultValueCount == m_ownerMainGrid->globalMatrixModelActiveCellCount()) return true;
     if (firstTimeStepResultValueCount == m_ownerMainGrid->globalFractureModelActiveCellCount()) return true;
     if (firstTimeStepResultValueCount == m_ownerMainGrid->cells().size()) return false;
@@ -662,6 +1236,20 @@ bool RigReservoirCellResults::isUsingGlobalActiveIndex(size_t scalarResultIndex)
     return false;
 }
 
+//--------------------------------------------------------------------------------------------------
+/// Returns whether the values of the timestep are stored as float. Timesteps of a result read from 
+/// file are converted to double precision one at a time, when accessed as doubles.
+//--------------------------------------------------------------------------------------------------
+bool RigReservoirCellResults::isSinglePrecision(size_t scalarResultIndex, size_t timeStepIndex) const
+{
+    CVF_TIGHT_ASSERT(scalarResultIndex < m_resultInfos.size());
+
+    if (!m_resultInfos[scalarResultIndex].m_isSinglePrecision) return false;
+    if (timeStepIndex >= m_singlePrecisionCellScalarResults[scalarResultIndex].size()) return false;
+
+    return m_cellScalarResults[scalarResultIndex][timeStepIndex].empty();
+}
+
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
@@ -737,7 +1325,22 @@ void RigReservoirCellResults::removeResult(const QString& resultName)
     size_t resultIdx = findScalarResultIndex(resultName);
     if (resultIdx == cvf::UNDEFINED_SIZE_T) return;
 
+    if (m_resultInfos[resultIdx].m_loadFramesOnDemand)
+    {
+        for (size_t tsIdx = 0; tsIdx < m_cellScalarResults[resultIdx].size(); ++tsIdx)
+        {
+            unloadFrame(resultIdx, tsIdx);
+        }
+
+        m_resultInfos[resultIdx].m_loadFramesOnDemand = false;
+        m_frameLastAccess[resultIdx].clear();
+    }
+
+    m_resultInfos[resultIdx].m_isComputedSOIL = false;
+
     m_cellScalarResults[resultIdx].clear();
+    m_singlePrecisionCellScalarResults[resultIdx].clear();
+    m_resultInfos[resultIdx].m_isSinglePrecision = false;
 
     m_resultInfos[resultIdx].m_resultType = RimDefines::REMOVED;
 }
@@ -750,7 +1353,14 @@ void RigReservoirCellResults::clearAllResults()
     for (size_t i = 0; i < m_cellScalarResults.size(); i++)
     {
         m_cellScalarResults[i].clear();
+        m_singlePrecisionCellScalarResults[i].clear();
+        m_resultInfos[i].m_loadFramesOnDemand = false;
+        m_resultInfos[i].m_isSinglePrecision = false;
+        m_resultInfos[i].m_isComputedSOIL = false;
     }
+
+    m_frameLastAccess.clear();
+    m_loadedFrameMemory = 0;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -776,3 +1386,100 @@ RifReaderInterface::PorosityModelResultType RigReservoirCellResults::convertFrom
     return RifReaderInterface::FRACTURE_RESULTS;
 }
 
+
+//--------------------------------------------------------------------------------------------------
+/// Add the defined values in \a data. The values are swept in parallel, each thread collecting
+/// its own statistics which are merged at the end.
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+void RigStatistics::addData(const std::vector<T>& data)
+{
+    int valueCount = static_cast<int>(data.size());
+
+#pragma omp parallel
+    {
+        RigStatistics threadStatistics;
+
+#pragma omp for nowait
+        for (int i = 0; i < valueCount; i++)
+        {
+            double value = data[i];
+            if (value == HUGE_VAL) continue;
+
+            if (value < threadStatistics.m_min) threadStatistics.m_min = value;
+            if (value > threadStatistics.m_max) threadStatistics.m_max = value;
+
+            threadStatistics.m_sum += value;
+            threadStatistics.m_valueCount++;
+
+            threadStatistics.m_quantiles.add(value);
+        }
+
+#pragma omp critical
+        {
+            add(threadStatistics);
+        }
+    }
+}
+
+template void RigStatistics::addData(const std::vector<double>& data);
+template void RigStatistics::addData(const std::vector<float>& data);
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigStatistics::add(const RigStatistics& other)
+{
+    if (other.m_min < m_min) m_min = other.m_min;
+    if (other.m_max > m_max) m_max = other.m_max;
+
+    m_sum += other.m_sum;
+    m_valueCount += other.m_valueCount;
+
+    m_quantiles.merge(other.m_quantiles);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Add the defined values in \a data to the histogram. Each thread fills its own bins, which are
+/// added to the histogram at the end.
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+void RigHistogramCalculator::addData(const std::vector<T>& data)
+{
+    CVF_ASSERT(m_histogram);
+
+    int valueCount = static_cast<int>(data.size());
+    size_t binCount = m_histogram->size();
+
+#pragma omp parallel
+    {
+        std::vector<size_t> threadHistogram(binCount, 0);
+
+#pragma omp for nowait
+        for (int i = 0; i < valueCount; i++)
+        {
+            double value = data[i];
+            if (value == HUGE_VAL) continue;
+
+            size_t index = 0;
+
+            if (maxIndex > 0) index = (size_t)(maxIndex*(value - m_min)/m_range);
+
+            if(index < binCount) // Just clip to the max min range (-index will overflow to positive )
+            {
+                threadHistogram[index]++;
+            }
+        }
+
+#pragma omp critical
+        {
+            for (size_t binIdx = 0; binIdx < binCount; ++binIdx)
+            {
+                (*m_histogram)[binIdx] += threadHistogram[binIdx];
+            }
+        }
+    }
+}
+
+template void RigHistogramCalculator::addData(const std::vector<double>& data);
+template void RigHistogramCalculator::addData(const std::vector<float>& data);
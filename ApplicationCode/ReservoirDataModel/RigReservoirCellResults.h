@@ -23,10 +23,35 @@
 #include <vector>
 #include <cmath>
 #include "RifReaderInterface.h"
+#include "RigQuantileSketch.h"
 
 class RifReaderInterface;
 class RigMainGrid;
 
+//==================================================================================================
+/// Min, max, sum, count and quantile sketch of the defined (not HUGE_VAL) values in one or more 
+/// sets of result values
+//==================================================================================================
+class RigStatistics
+{
+public:
+    RigStatistics() : m_min(HUGE_VAL), m_max(-HUGE_VAL), m_sum(0.0), m_valueCount(0) {}
+
+    template <typename T>
+    void    addData(const std::vector<T>& data);
+    void    add(const RigStatistics& other);
+
+    double  mean() const { return m_valueCount > 0 ? m_sum / m_valueCount : HUGE_VAL; }
+
+public:
+    double  m_min;
+    double  m_max;
+    double  m_sum;
+    size_t  m_valueCount;
+
+    RigQuantileSketch m_quantiles;
+};
+
 //==================================================================================================
 /// Class containing the results for the complete number of active cells. Both main grid and LGR's
 //==================================================================================================
@@ -36,6 +61,11 @@ public:
     RigReservoirCellResults(RigMainGrid* ownerGrid);
 
     void                setReaderInterface(RifReaderInterface* readerInterface);
+    void                setFrameMemoryBudget(size_t byteCount);
+
+    const RigStatistics& statistics(size_t scalarResultIndex);
+    const RigStatistics& statistics(size_t scalarResultIndex, size_t timeStepIndex);
+    RigStatistics       visitedTimeStepsStatistics(size_t scalarResultIndex, size_t timeStepIndex);
 
     // Max and min values of the results
     void                recalculateMinMax(size_t scalarResultIndex);
@@ -43,6 +73,7 @@ public:
     void                minMaxCellScalarValues(size_t scalarResultIndex, size_t timeStepIndex, double& min, double& max);
     const std::vector<size_t>& cellScalarValuesHistogram(size_t scalarResultIndex);
     void                p10p90CellScalarValues(size_t scalarResultIndex, double& p10, double& p90);
+    void                p10p90CellScalarValues(size_t scalarResultIndex, size_t timeStepIndex, double& p10, double& p90);
     void                meanCellScalarValues(size_t scalarResultIndex, double& meanValue);
 
     // Access meta-information about the results
@@ -51,6 +82,7 @@ public:
     size_t              maxTimeStepCount() const; 
     QStringList         resultNames(RimDefines::ResultCatType type) const;
     bool                isUsingGlobalActiveIndex(size_t scalarResultIndex) const;
+    bool                isSinglePrecision(size_t scalarResultIndex, size_t timeStepIndex) const;
 
     QDateTime           timeStepDate(size_t scalarResultIndex, size_t timeStepIndex) const;
     QList<QDateTime>    timeStepDates(size_t scalarResultIndex) const;
@@ -70,35 +102,64 @@ public:
     void                loadOrComputeSOIL();
     void                computeDepthRelatedResults();
 
-    // Access the results data
+    // Access the results data. Single precision timesteps are converted to double precision when accessed as doubles
     std::vector< std::vector<double> > &                    cellScalarResults(size_t scalarResultIndex);
-    double                                                  cellScalarResult(size_t timeStepIndex, size_t scalarResultIndex, size_t resultValueIndex);
+    std::vector<double> &                                   cellScalarResults(size_t scalarResultIndex, size_t timeStepIndex);
+    const std::vector<float> &                              singlePrecisionCellScalarResults(size_t scalarResultIndex, size_t timeStepIndex);
+    double                                                  cellScalarResult(size_t timeStepIndex, size_t scalarResultIndex, size_t resultValueIndex) const;
+    void                                                    loadTimeStep(size_t scalarResultIndex, size_t timeStepIndex);
+    bool                                                    isTimeStepLoaded(size_t scalarResultIndex, size_t timeStepIndex) const;
+    void                                                    unloadTimeStep(size_t scalarResultIndex, size_t timeStepIndex);
+    void                                                    pinFrame(size_t scalarResultIndex, size_t timeStepIndex);
+    void                                                    unpinFrame(size_t scalarResultIndex, size_t timeStepIndex);
+    void                                                    replaceCellScalarResults(size_t scalarResultIndex, std::vector< std::vector<double> >* values);
 
     static RifReaderInterface::PorosityModelResultType convertFromProjectModelPorosityModel(RimDefines::PorosityModelType porosityModel);
     
 private:
     size_t              addStaticScalarResult(RimDefines::ResultCatType type, const QString& resultName, size_t resultValueCount);
 
+    bool                loadFrame(size_t scalarResultIndex, size_t timeStepIndex);
+    void                computeSOILFrame(size_t timeStepIndex, std::vector<double>* soilValues);
+    void                unloadFrame(size_t scalarResultIndex, size_t timeStepIndex);
+    void                unloadLeastRecentlyUsedFrames();
+    void                loadAllFrames(size_t scalarResultIndex);
+    bool                isFramePinned(size_t scalarResultIndex, size_t timeStepIndex) const;
+    size_t              frameValueCount(size_t scalarResultIndex, size_t timeStepIndex) const;
+    size_t              frameByteCount(size_t scalarResultIndex, size_t timeStepIndex) const;
+
+    void                storeFrame(size_t scalarResultIndex, size_t timeStepIndex, std::vector<double>* values);
+    void                convertToDoublePrecision(size_t scalarResultIndex, size_t timeStepIndex);
+    void                releaseSinglePrecisionCopy(size_t scalarResultIndex, size_t timeStepIndex);
+
 private:
     std::vector< std::vector< std::vector<double> > >       m_cellScalarResults; ///< Scalar results for each timestep for each Result index (ResultVariable)
-    std::vector< std::pair<double, double> >                m_maxMinValues; ///< Max min values for each Result index
+    std::vector< std::vector< std::vector<float> > >        m_singlePrecisionCellScalarResults; ///< Values of single precision timesteps. The timestep of m_cellScalarResults is empty for these
     std::vector< std::vector<size_t> >                      m_histograms; ///< Histogram for each Result Index
-    std::vector< std::pair<double, double> >                m_p10p90; ///< P10 and p90 values for each Result Index
-    std::vector< double >                                   m_meanValues; ///< Mean value for each Result Index
 
-    std::vector< std::vector< std::pair<double, double> > > m_maxMinValuesPrTs; ///< Max min values for each timestep and Result index
+    std::vector< std::pair<bool, RigStatistics> >                   m_statistics;       ///< Statistics for each Result index, and whether it is computed
+    std::vector< std::vector< std::pair<bool, RigStatistics> > >    m_statisticsPrTs;   ///< Statistics for each timestep and Result index, and whether it is computed
+
+    std::vector< std::vector<size_t> >                      m_frameLastAccess; ///< Access counter value when each on demand timestep was last used. Zero when not loaded
+    std::vector< std::vector<int> >                         m_framePinCounts;  ///< Number of data access objects referencing each timestep. Pinned timesteps are not unloaded
+    size_t                                                  m_frameAccessCounter;
+    size_t                                                  m_frameMemoryBudget; ///< Max number of bytes used by timesteps loaded on demand. Zero means unlimited
+    size_t                                                  m_loadedFrameMemory; ///< Number of bytes currently used by timesteps loaded on demand
 
     class ResultInfo
     {
     public:
         ResultInfo(RimDefines::ResultCatType resultType, QString resultName, size_t gridScalarResultIndex)
-            : m_resultType(resultType), m_resultName(resultName), m_gridScalarResultIndex(gridScalarResultIndex) { }
+            : m_resultType(resultType), m_resultName(resultName), m_gridScalarResultIndex(gridScalarResultIndex), m_loadFramesOnDemand(false), m_isSinglePrecision(false), m_isComputedSOIL(false) { }
 
     public:
         RimDefines::ResultCatType   m_resultType;
         QString                     m_resultName;
         size_t                      m_gridScalarResultIndex;
         QList<QDateTime>            m_timeStepDates;
+        bool                        m_loadFramesOnDemand; ///< Timesteps are read from the reader when first used, and can be unloaded again
+        bool                        m_isSinglePrecision;  ///< Timesteps read from file are stored as float when the values allow it
+        bool                        m_isComputedSOIL;     ///< Timesteps are computed from SWAT and SGAS when loaded, instead of being read
     };
 
     std::vector<ResultInfo>                                 m_resultInfos;
@@ -119,7 +180,6 @@ public:
 
         m_histogram = histogram;
         m_min = min;
-        m_observationCount = 0;
 
         // Initialize bins
         m_histogram->resize(nBins);
@@ -129,63 +189,12 @@ public:
         maxIndex = nBins-1;
     }
 
-    void addData(const std::vector<double>& data)
-    {
-        CVF_ASSERT(m_histogram);
-        for (size_t i = 0; i < data.size(); ++i) 
-        {
-            if (data[i] == HUGE_VAL)
-            {
-                continue;
-            }
-
-            size_t index = 0;
-
-            if (maxIndex > 0) index = (size_t)(maxIndex*(data[i] - m_min)/m_range);
-
-            if(index < m_histogram->size()) // Just clip to the max min range (-index will overflow to positive )
-            {
-                (*m_histogram)[index]++;
-                m_observationCount++;
-            }
-        }
-    }
-
-    /// Calculates the estimated percentile from the histogram. 
-    /// the percentile is the domain value at which pVal of the observations are below it.
-    /// Will only consider observed values between min and max, as all other values are discarded from the histogram
-
-    double calculatePercentil(double pVal) 
-    {
-        CVF_ASSERT(m_histogram);
-        CVF_ASSERT(m_histogram->size());
-        CVF_ASSERT( 0.0 <= pVal && pVal <= 1.0);
-
-        double pValObservationCount = pVal*m_observationCount;
-        if (pValObservationCount == 0.0) return m_min;
-
-        size_t accObsCount = 0;
-        double binWidth =  m_range/m_histogram->size();
-        for (size_t binIdx = 0; binIdx < m_histogram->size(); ++binIdx)
-        {
-            size_t binObsCount = (*m_histogram)[binIdx];
-
-            accObsCount += binObsCount;
-            if (accObsCount >= pValObservationCount)
-            {
-                double domainValueAtEndOfBin = m_min + (binIdx+1) * binWidth;
-                double unusedFractionOfLastBin = (double)(accObsCount - pValObservationCount)/binObsCount;
-                return domainValueAtEndOfBin - unusedFractionOfLastBin*binWidth;
-            }
-        }
-        CVF_ASSERT(false);
-        return HUGE_VAL;
-    }
+    template <typename T>
+    void addData(const std::vector<T>& data);
 
 private:
     size_t maxIndex;
     double m_range;
     double m_min;
-    size_t m_observationCount;
     std::vector<size_t>* m_histogram;
 };
@@ -0,0 +1,811 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include "RIStdInclude.h"
+
+#include "RigResultExpression.h"
+#include "RigReservoirCellResults.h"
+
+#include "cvfCollection.h"
+
+#include <cmath>
+
+
+//==================================================================================================
+/// 
+//==================================================================================================
+class RigResultExpression::Node : public cvf::Object
+{
+public:
+    enum NodeType { CONSTANT, RESULT, OPERATOR, FUNCTION };
+
+    enum Operator { ADD, SUBTRACT, MULTIPLY, DIVIDE, POWER, NEGATE, 
+                    LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, EQUAL, NOT_EQUAL };
+
+    enum Function { ABS, SQRT, EXP, LOG, LOG10, ELEMENT_MIN, ELEMENT_MAX, IF,
+                    CELL_SUM, CELL_MEAN, CELL_MIN, CELL_MAX, 
+                    TIME_SUM, TIME_MEAN, TIME_MIN, TIME_MAX };
+
+public:
+    explicit Node(NodeType type)
+    :   m_type(type),
+        m_constant(0.0),
+        m_operator(ADD),
+        m_function(ABS),
+        m_timeStepOffset(0),
+        m_scalarResultIndex(cvf::UNDEFINED_SIZE_T),
+        m_hasCachedValues(false)
+    {}
+
+    NodeType                m_type;
+    double                  m_constant;
+    Operator                m_operator;
+    Function                m_function;
+    QString                 m_resultName;
+    int                     m_timeStepOffset;
+    size_t                  m_scalarResultIndex;
+    cvf::Collection<Node>   m_arguments;
+
+    bool                    m_hasCachedValues;  ///< Time reductions are the same for all timesteps, and computed once
+    std::vector<double>     m_cachedValues;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RigResultExpression::RigResultExpression()
+    :   m_position(0),
+        m_results(NULL),
+        m_timeStepCount(0),
+        m_valueCount(0)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+RigResultExpression::~RigResultExpression()
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Parse the expression. Returns false, and sets the error message if it is invalid
+//--------------------------------------------------------------------------------------------------
+bool RigResultExpression::parse(const QString& expression)
+{
+    m_text = expression.toLatin1();
+    m_position = 0;
+    m_errorMessage.clear();
+
+    m_root = parseComparison();
+
+    if (m_root.notNull() && peek() != '\0')
+    {
+        setError(QString("Unexpected \"%1\"").arg(QString(m_text.mid(m_position))));
+    }
+
+    if (!m_errorMessage.isEmpty())
+    {
+        m_root = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Returns the next character that is not white space, or '\0' at the end
+//--------------------------------------------------------------------------------------------------
+char RigResultExpression::peek()
+{
+    while (m_position < m_text.size() && isspace(m_text[m_position])) m_position++;
+
+    return m_position < m_text.size() ? m_text[m_position] : '\0';
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Consume the token if it is next in the text
+//--------------------------------------------------------------------------------------------------
+bool RigResultExpression::accept(const char* token)
+{
+    peek();
+
+    int length = static_cast<int>(strlen(token));
+    if (m_text.mid(m_position, length) != QByteArray(token)) return false;
+
+    m_position += length;
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RigResultExpression::setError(const QString& message)
+{
+    // Keep the first error, as the following ones are consequences of it
+    if (m_errorMessage.isEmpty())
+    {
+        m_errorMessage = message;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// comparison := sum [ ( "<=" | ">=" | "==" | "!=" | "<" | ">" ) sum ]
+//--------------------------------------------------------------------------------------------------
+cvf::ref<RigResultExpression::Node> RigResultExpression::parseComparison()
+{
+    cvf::ref<Node> left = parseSum();
+    if (left.isNull()) return NULL;
+
+    Node::Operator op;
+    if      (accept("<=")) op = Node::LESS_EQUAL;
+    else if (accept(">=")) op = Node::GREATER_EQUAL;
+    else if (accept("==")) op = Node::EQUAL;
+    else if (accept("!=")) op = Node::NOT_EQUAL;
+    else if (accept("<"))  op = Node::LESS;
+    else if (accept(">"))  op = Node::GREATER;
+    else return left;
+
+    cvf::ref<Node> right = parseSum();
+    if (right.isNull()) return NULL;
+
+    cvf::ref<Node> node = new Node(Node::OPERATOR);
+    node->m_operator = op;
+    node->m_arguments.push_back(left.p());
+    node->m_arguments.push_back(right.p());
+
+    return node;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// sum := product { ( "+" | "-" ) product }
+//--------------------------------------------------------------------------------------------------
+cvf::ref<RigResultExpression::Node> RigResultExpression::parseSum()
+{
+    cvf::ref<Node> left = parseProduct();
+
+    while (left.notNull())
+    {
+        Node::Operator op;
+        if      (accept("+")) op = Node::ADD;
+        else if (accept("-")) op = Node::SUBTRACT;
+        else break;
+
+        cvf::ref<Node> right = parseProduct();
+        if (right.isNull()) return NULL;
+
+        cvf::ref<Node> node = new Node(Node::OPERATOR);
+        node->m_operator = op;
+        node->m_arguments.push_back(left.p());
+        node->m_arguments.push_back(right.p());
+        left = node;
+    }
+
+    return left;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// product := unary { ( "*" | "/" ) unary }
+//--------------------------------------------------------------------------------------------------
+cvf::ref<RigResultExpression::Node> RigResultExpression::parseProduct()
+{
+    cvf::ref<Node> left = parseUnary();
+
+    while (left.notNull())
+    {
+        Node::Operator op;
+        if      (accept("*")) op = Node::MULTIPLY;
+        else if (accept("/")) op = Node::DIVIDE;
+        else break;
+
+        cvf::ref<Node> right = parseUnary();
+        if (right.isNull()) return NULL;
+
+        cvf::ref<Node> node = new Node(Node::OPERATOR);
+        node->m_operator = op;
+        node->m_arguments.push_back(left.p());
+        node->m_arguments.push_back(right.p());
+        left = node;
+    }
+
+    return left;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// unary := ( "-" | "+" ) unary | power
+//--------------------------------------------------------------------------------------------------
+cvf::ref<RigResultExpression::Node> RigResultExpression::parseUnary()
+{
+    if (accept("+")) return parseUnary();
+
+    if (accept("-"))
+    {
+        cvf::ref<Node> argument = parseUnary();
+        if (argument.isNull()) return NULL;
+
+        cvf::ref<Node> node = new Node(Node::OPERATOR);
+        node->m_operator = Node::NEGATE;
+        node->m_arguments.push_back(argument.p());
+
+        return node;
+    }
+
+    return parsePower();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// power := primary [ "^" unary ]
+//--------------------------------------------------------------------------------------------------
+cvf::ref<RigResultExpression::Node> RigResultExpression::parsePower()
+{
+    cvf::ref<Node> base = parsePrimary();
+    if (base.isNull() || !accept("^")) return base;
+
+    cvf::ref<Node> exponent = parseUnary();
+    if (exponent.isNull()) return NULL;
+
+    cvf::ref<Node> node = new Node(Node::OPERATOR);
+    node->m_operator = Node::POWER;
+    node->m_arguments.push_back(base.p());
+    node->m_arguments.push_back(exponent.p());
+
+    return node;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// primary := number | "(" comparison ")" | function "(" comparison { "," comparison } ")" 
+///          | resultName [ "[" [ "-" | "+" ] integer "]" ]
+//--------------------------------------------------------------------------------------------------
+cvf::ref<RigResultExpression::Node> RigResultExpression::parsePrimary()
+{
+    struct FunctionDefinition
+    {
+        const char*     name;
+        int             argumentCount;
+        Node::Function  function;
+    };
+
+    static const FunctionDefinition functions[] = 
+    {
+        { "abs",   1, Node::ABS },
+        { "sqrt",  1, Node::SQRT },
+        { "exp",   1, Node::EXP },
+        { "log",   1, Node::LOG },
+        { "log10", 1, Node::LOG10 },
+        { "min",   2, Node::ELEMENT_MIN },
+        { "max",   2, Node::ELEMENT_MAX },
+        { "if",    3, Node::IF },
+        { "sum",   1, Node::CELL_SUM },
+        { "mean",  1, Node::CELL_MEAN },
+        { "min",   1, Node::CELL_MIN },
+        { "max",   1, Node::CELL_MAX },
+        { "tsum",  1, Node::TIME_SUM },
+        { "tmean", 1, Node::TIME_MEAN },
+        { "tmin",  1, Node::TIME_MIN },
+        { "tmax",  1, Node::TIME_MAX }
+    };
+
+    char c = peek();
+
+    if (c == '(')
+    {
+        accept("(");
+        cvf::ref<Node> node = parseComparison();
+        if (node.notNull() && !accept(")"))
+        {
+            setError("Missing \")\"");
+            return NULL;
+        }
+
+        return node;
+    }
+
+    if (isdigit(c) || c == '.')
+    {
+        const char* start = m_text.constData() + m_position;
+        char* end = NULL;
+        double value = strtod(start, &end);
+        if (end == start)
+        {
+            setError(QString("Invalid number at \"%1\"").arg(QString(m_text.mid(m_position))));
+            return NULL;
+        }
+        m_position += static_cast<int>(end - start);
+
+        cvf::ref<Node> node = new Node(Node::CONSTANT);
+        node->m_constant = value;
+
+        return node;
+    }
+
+    if (!(isalpha(c) || c == '_'))
+    {
+        if (c == '\0') setError("Unexpected end of expression");
+        else           setError(QString("Unexpected \"%1\"").arg(QString(m_text.mid(m_position))));
+
+        return NULL;
+    }
+
+    int nameStart = m_position;
+    while (m_position < m_text.size() && (isalnum(m_text[m_position]) || m_text[m_position] == '_')) m_position++;
+    QByteArray name = m_text.mid(nameStart, m_position - nameStart);
+
+    if (accept("("))
+    {
+        cvf::ref<Node> node = new Node(Node::FUNCTION);
+
+        do
+        {
+            cvf::ref<Node> argument = parseComparison();
+            if (argument.isNull()) return NULL;
+
+            node->m_arguments.push_back(argument.p());
+        } 
+        while (accept(","));
+
+        if (!accept(")"))
+        {
+            setError(QString("Missing \")\" after the arguments to %1").arg(QString(name)));
+            return NULL;
+        }
+
+        size_t functionCount = sizeof(functions) / sizeof(functions[0]);
+        for (size_t fIdx = 0; fIdx < functionCount; ++fIdx)
+        {
+            if (name == functions[fIdx].name && static_cast<int>(node->m_arguments.size()) == functions[fIdx].argumentCount)
+            {
+                node->m_function = functions[fIdx].function;
+                return node;
+            }
+        }
+
+        setError(QString("Unknown function %1 with %2 arguments").arg(QString(name)).arg(node->m_arguments.size()));
+        return NULL;
+    }
+
+    cvf::ref<Node> node = new Node(Node::RESULT);
+    node->m_resultName = QString(name);
+
+    if (accept("["))
+    {
+        bool isNegative = false;
+        if      (accept("-")) isNegative = true;
+        else if (accept("+")) isNegative = false;
+
+        peek();
+        int offsetStart = m_position;
+        while (m_position < m_text.size() && isdigit(m_text[m_position])) m_position++;
+
+        bool isOk = false;
+        int offset = m_text.mid(offsetStart, m_position - offsetStart).toInt(&isOk);
+
+        if (!isOk || !accept("]"))
+        {
+            setError(QString("Invalid timestep offset for %1. Use %1[n] or %1[-n]").arg(QString(name)));
+            return NULL;
+        }
+
+        node->m_timeStepOffset = isNegative ? -offset : offset;
+    }
+
+    return node;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Compute the expression for all the timesteps, and store it as the result named resultName. 
+/// The result is created as a generated result if it does not exist. 
+/// Returns the scalar result index, or cvf::UNDEFINED_SIZE_T if the expression could not be computed
+//--------------------------------------------------------------------------------------------------
+size_t RigResultExpression::computeResult(RigReservoirCellResults* results, const QString& resultName)
+{
+    CVF_ASSERT(results);
+
+    if (m_root.isNull())
+    {
+        setError("No valid expression to compute");
+        return cvf::UNDEFINED_SIZE_T;
+    }
+
+    m_errorMessage.clear();
+    m_results = results;
+    m_timeStepCount = 1;
+    m_valueCount = 0;
+
+    QList<QDateTime> timeStepDates;
+    if (!resolveResults(m_root.p(), &timeStepDates)) return cvf::UNDEFINED_SIZE_T;
+
+    // Compute all the timesteps before storing any of them, as the result may be used in the expression
+
+    std::vector< std::vector<double> > computedValues(m_timeStepCount);
+
+    for (size_t tIdx = 0; tIdx < m_timeStepCount; ++tIdx)
+    {
+        if (!evaluate(m_root.p(), tIdx, &computedValues[tIdx])) return cvf::UNDEFINED_SIZE_T;
+    }
+
+    if (m_valueCount == 0)
+    {
+        setError("The expression must use at least one result");
+        return cvf::UNDEFINED_SIZE_T;
+    }
+
+    // Values that are the same for all cells, like reductions, are expanded to all the cells
+    for (size_t tIdx = 0; tIdx < m_timeStepCount; ++tIdx)
+    {
+        if (computedValues[tIdx].size() == 1)
+        {
+            computedValues[tIdx].resize(m_valueCount, computedValues[tIdx][0]);
+        }
+    }
+
+    size_t scalarResultIndex = results->findOrLoadScalarResult(resultName);
+    if (scalarResultIndex == cvf::UNDEFINED_SIZE_T)
+    {
+        scalarResultIndex = results->addEmptyScalarResult(RimDefines::GENERATED, resultName);
+        results->setTimeStepDates(scalarResultIndex, timeStepDates);
+    }
+
+    results->replaceCellScalarResults(scalarResultIndex, &computedValues);
+
+    return scalarResultIndex;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Find the results used, and the number of timesteps to compute
+//--------------------------------------------------------------------------------------------------
+bool RigResultExpression::resolveResults(Node* node, QList<QDateTime>* timeStepDates)
+{
+    node->m_hasCachedValues = false;
+    node->m_cachedValues.clear();
+
+    if (node->m_type == Node::RESULT)
+    {
+        node->m_scalarResultIndex = m_results->findOrLoadScalarResult(node->m_resultName);
+        if (node->m_scalarResultIndex == cvf::UNDEFINED_SIZE_T)
+        {
+            setError(QString("Could not find the result %1").arg(node->m_resultName));
+            return false;
+        }
+
+        size_t timeStepCount = m_results->timeStepCount(node->m_scalarResultIndex);
+        if (timeStepCount == 0)
+        {
+            setError(QString("The result %1 has no data").arg(node->m_resultName));
+            return false;
+        }
+
+        if (timeStepCount > m_timeStepCount)
+        {
+            m_timeStepCount = timeStepCount;
+            *timeStepDates = m_results->timeStepDates(node->m_scalarResultIndex);
+        }
+    }
+
+    for (size_t aIdx = 0; aIdx < node->m_arguments.size(); ++aIdx)
+    {
+        if (!resolveResults(node->m_arguments[aIdx].p(), timeStepDates)) return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Evaluate the node at one timestep. A single value is used for all the cells
+//--------------------------------------------------------------------------------------------------
+bool RigResultExpression::evaluate(Node* node, size_t timeStepIndex, std::vector<double>* values)
+{
+    switch (node->m_type)
+    {
+        case Node::CONSTANT:
+        {
+            values->assign(1, node->m_constant);
+            return true;
+        }
+
+        case Node::RESULT:
+        {
+            size_t resultTimeStepCount = m_results->timeStepCount(node->m_scalarResultIndex);
+            int resultTimeStep = resultTimeStepCount == 1 ? 0 : static_cast<int>(timeStepIndex) + node->m_timeStepOffset;
+
+            if (resultTimeStep < 0 || resultTimeStep >= static_cast<int>(resultTimeStepCount))
+            {
+                values->assign(1, HUGE_VAL);
+                return true;
+            }
+
+            resultValues(node->m_scalarResultIndex, static_cast<size_t>(resultTimeStep), values);
+            if (values->empty())
+            {
+                // The timestep could not be read
+                values->assign(1, HUGE_VAL);
+                return true;
+            }
+
+            if (m_valueCount != 0 && values->size() != m_valueCount)
+            {
+                setError("The results used in the expression have different number of values");
+                return false;
+            }
+            m_valueCount = values->size();
+
+            return true;
+        }
+
+        case Node::OPERATOR:
+        {
+            return evaluateOperator(node, timeStepIndex, values);
+        }
+
+        case Node::FUNCTION:
+        {
+            return evaluateFunction(node, timeStepIndex, values);
+        }
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+bool RigResultExpression::evaluateOperator(Node* node, size_t timeStepIndex, std::vector<double>* values)
+{
+    std::vector<double> a;
+    if (!evaluate(node->m_arguments[0].p(), timeStepIndex, &a)) return false;
+
+    if (node->m_operator == Node::NEGATE)
+    {
+        values->resize(a.size());
+
+        int valueCount = static_cast<int>(a.size());
+#pragma omp parallel for
+        for (int vIdx = 0; vIdx < valueCount; ++vIdx)
+        {
+            (*values)[vIdx] = a[vIdx] == HUGE_VAL ? HUGE_VAL : -a[vIdx];
+        }
+
+        return true;
+    }
+
+    std::vector<double> b;
+    if (!evaluate(node->m_arguments[1].p(), timeStepIndex, &b)) return false;
+
+    // Sizes are either equal, or one of them is a single value used for all the cells
+    size_t aStep = a.size() == 1 ? 0 : 1;
+    size_t bStep = b.size() == 1 ? 0 : 1;
+    values->resize(qMax(a.size(), b.size()));
+
+    Node::Operator op = node->m_operator;
+    int valueCount = static_cast<int>(values->size());
+
+#pragma omp parallel for
+    for (int vIdx = 0; vIdx < valueCount; ++vIdx)
+    {
+        double x = a[vIdx * aStep];
+        double y = b[vIdx * bStep];
+
+        if (x == HUGE_VAL || y == HUGE_VAL)
+        {
+            (*values)[vIdx] = HUGE_VAL;
+            continue;
+        }
+
+        double value = 0.0;
+        switch (op)
+        {
+            case Node::ADD:             value = x + y; break;
+            case Node::SUBTRACT:        value = x - y; break;
+            case Node::MULTIPLY:        value = x * y; break;
+            case Node::DIVIDE:          value = y != 0.0 ? x / y : HUGE_VAL; break;
+            case Node::POWER:           value = pow(x, y); break;
+            case Node::LESS:            value = x <  y ? 1.0 : 0.0; break;
+            case Node::LESS_EQUAL:      value = x <= y ? 1.0 : 0.0; break;
+            case Node::GREATER:         value = x >  y ? 1.0 : 0.0; break;
+            case Node::GREATER_EQUAL:   value = x >= y ? 1.0 : 0.0; break;
+            case Node::EQUAL:           value = x == y ? 1.0 : 0.0; break;
+            case Node::NOT_EQUAL:       value = x != y ? 1.0 : 0.0; break;
+            default:                    value = HUGE_VAL; break;
+        }
+
+        (*values)[vIdx] = value;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+bool RigResultExpression::evaluateFunction(Node* node, size_t timeStepIndex, std::vector<double>* values)
+{
+    Node::Function function = node->m_function;
+
+    if (function == Node::TIME_SUM || function == Node::TIME_MEAN || function == Node::TIME_MIN || function == Node::TIME_MAX)
+    {
+        return evaluateTimeReduction(node, values);
+    }
+
+    std::vector< std::vector<double> > arguments(node->m_arguments.size());
+    size_t valueCount = 1;
+
+    for (size_t aIdx = 0; aIdx < arguments.size(); ++aIdx)
+    {
+        if (!evaluate(node->m_arguments[aIdx].p(), timeStepIndex, &arguments[aIdx])) return false;
+        valueCount = qMax(valueCount, arguments[aIdx].size());
+    }
+
+    const std::vector<double>& a = arguments[0];
+
+    if (function == Node::CELL_SUM || function == Node::CELL_MEAN || function == Node::CELL_MIN || function == Node::CELL_MAX)
+    {
+        double sum = 0.0;
+        double min = HUGE_VAL;
+        double max = -HUGE_VAL;
+        size_t definedCount = 0;
+
+        for (size_t vIdx = 0; vIdx < a.size(); ++vIdx)
+        {
+            if (a[vIdx] == HUGE_VAL) continue;
+
+            sum += a[vIdx];
+            min = qMin(min, a[vIdx]);
+            max = qMax(max, a[vIdx]);
+            definedCount++;
+        }
+
+        double value = HUGE_VAL;
+        if (definedCount > 0)
+        {
+            if      (function == Node::CELL_SUM)  value = sum;
+            else if (function == Node::CELL_MEAN) value = sum / definedCount;
+            else if (function == Node::CELL_MIN)  value = min;
+            else                                  value = max;
+        }
+
+        values->assign(1, value);
+        return true;
+    }
+
+    size_t aStep = a.size() == 1 ? 0 : 1;
+    size_t bStep = arguments.size() > 1 && arguments[1].size() > 1 ? 1 : 0;
+    size_t cStep = arguments.size() > 2 && arguments[2].size() > 1 ? 1 : 0;
+
+    const std::vector<double>& b = arguments.size() > 1 ? arguments[1] : a;
+    const std::vector<double>& c = arguments.size() > 2 ? arguments[2] : a;
+
+    values->resize(valueCount);
+    int count = static_cast<int>(valueCount);
+
+#pragma omp parallel for
+    for (int vIdx = 0; vIdx < count; ++vIdx)
+    {
+        double x = a[vIdx * aStep];
+        double value = HUGE_VAL;
+
+        if (x != HUGE_VAL)
+        {
+            switch (function)
+            {
+                case Node::ABS:     value = fabs(x); break;
+                case Node::SQRT:    value = x >= 0.0 ? sqrt(x) : HUGE_VAL; break;
+                case Node::EXP:     value = exp(x); break;
+                case Node::LOG:     value = x > 0.0 ? log(x) : HUGE_VAL; break;
+                case Node::LOG10:   value = x > 0.0 ? log10(x) : HUGE_VAL; break;
+                case Node::IF:      value = x != 0.0 ? b[vIdx * bStep] : c[vIdx * cStep]; break;
+                case Node::ELEMENT_MIN:
+                {
+                    double y = b[vIdx * bStep];
+                    value = y == HUGE_VAL ? HUGE_VAL : qMin(x, y);
+                    break;
+                }
+                case Node::ELEMENT_MAX:
+                {
+                    double y = b[vIdx * bStep];
+                    value = y == HUGE_VAL ? HUGE_VAL : qMax(x, y);
+                    break;
+                }
+                default: break;
+            }
+        }
+
+        (*values)[vIdx] = value;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Reduce the argument over all timesteps in each cell. Computed once, as it is the same for all timesteps
+//--------------------------------------------------------------------------------------------------
+bool RigResultExpression::evaluateTimeReduction(Node* node, std::vector<double>* values)
+{
+    if (!node->m_hasCachedValues)
+    {
+        Node::Function function = node->m_function;
+
+        std::vector<double> reduced;
+        std::vector<size_t> definedCounts;
+        std::vector<double> timeStepValues;
+
+        for (size_t tIdx = 0; tIdx < m_timeStepCount; ++tIdx)
+        {
+            if (!evaluate(node->m_arguments[0].p(), tIdx, &timeStepValues)) return false;
+
+            // Grow a single value to the number of cells when needed
+            if (timeStepValues.size() > reduced.size())
+            {
+                double initialValue = reduced.empty() ? HUGE_VAL : reduced[0];
+                size_t initialCount = definedCounts.empty() ? 0 : definedCounts[0];
+                reduced.resize(timeStepValues.size(), initialValue);
+                definedCounts.resize(timeStepValues.size(), initialCount);
+            }
+
+            size_t step = timeStepValues.size() == 1 ? 0 : 1;
+            int valueCount = static_cast<int>(reduced.size());
+
+#pragma omp parallel for
+            for (int vIdx = 0; vIdx < valueCount; ++vIdx)
+            {
+                double value = timeStepValues[vIdx * step];
+                if (value == HUGE_VAL) continue;
+
+                double& current = reduced[vIdx];
+                if (definedCounts[vIdx] == 0)                                   current = value;
+                else if (function == Node::TIME_MIN)                            current = qMin(current, value);
+                else if (function == Node::TIME_MAX)                            current = qMax(current, value);
+                else                                                            current += value;
+
+                definedCounts[vIdx]++;
+            }
+        }
+
+        if (function == Node::TIME_MEAN)
+        {
+            for (size_t vIdx = 0; vIdx < reduced.size(); ++vIdx)
+            {
+                if (definedCounts[vIdx] > 0) reduced[vIdx] /= definedCounts[vIdx];
+            }
+        }
+
+        node->m_cachedValues.swap(reduced);
+        node->m_hasCachedValues = true;
+    }
+
+    *values = node->m_cachedValues;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Copy the values of one timestep. Only that timestep of results read on demand is loaded
+//--------------------------------------------------------------------------------------------------
+void RigResultExpression::resultValues(size_t scalarResultIndex, size_t timeStepIndex, std::vector<double>* values)
+{
+    m_results->loadTimeStep(scalarResultIndex, timeStepIndex);
+
+    if (m_results->isSinglePrecision(scalarResultIndex, timeStepIndex))
+    {
+        const std::vector<float>& singlePrecisionValues = m_results->singlePrecisionCellScalarResults(scalarResultIndex, timeStepIndex);
+        values->assign(singlePrecisionValues.begin(), singlePrecisionValues.end());
+    }
+    else
+    {
+        *values = m_results->cellScalarResults(scalarResultIndex, timeStepIndex);
+    }
+}
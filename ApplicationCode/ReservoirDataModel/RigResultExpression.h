@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "cvfBase.h"
+#include "cvfObject.h"
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QDateTime>
+
+#include <vector>
+
+class RigReservoirCellResults;
+
+
+//==================================================================================================
+/// Expression computing a new result from the results of a case, cell by cell for each timestep.
+/// Examples: "SOIL*PORV", "SOIL[1] - SOIL", "if(SWAT > 0.5, 1, 0)", "SOIL/tmax(SOIL)"
+///
+/// Operators:  + - * / ^ and < > <= >= == != giving 1 or 0
+/// Results:    NAME is the value at the current timestep, NAME[n] the value n timesteps later
+/// Functions:  abs sqrt exp log log10 min(a, b) max(a, b) if(condition, a, b)
+/// Reductions: sum mean min max over all the cells in a timestep,
+///             tsum tmean tmin tmax over all the timesteps of each cell
+///
+/// Results with one timestep (static results) are used at all timesteps. Undefined values (HUGE_VAL)
+/// give undefined values, and are ignored by the reductions.
+//==================================================================================================
+class RigResultExpression
+{
+public:
+    RigResultExpression();
+    ~RigResultExpression();
+
+    bool        parse(const QString& expression);
+    size_t      computeResult(RigReservoirCellResults* results, const QString& resultName);
+
+    QString     errorMessage() const { return m_errorMessage; }
+
+private:
+    class Node;
+
+    cvf::ref<Node>  parseComparison();
+    cvf::ref<Node>  parseSum();
+    cvf::ref<Node>  parseProduct();
+    cvf::ref<Node>  parseUnary();
+    cvf::ref<Node>  parsePower();
+    cvf::ref<Node>  parsePrimary();
+
+    char            peek();
+    bool            accept(const char* token);
+    void            setError(const QString& message);
+
+    bool            resolveResults(Node* node, QList<QDateTime>* timeStepDates);
+    bool            evaluate(Node* node, size_t timeStepIndex, std::vector<double>* values);
+    bool            evaluateOperator(Node* node, size_t timeStepIndex, std::vector<double>* values);
+    bool            evaluateFunction(Node* node, size_t timeStepIndex, std::vector<double>* values);
+    bool            evaluateTimeReduction(Node* node, std::vector<double>* values);
+    void            resultValues(size_t scalarResultIndex, size_t timeStepIndex, std::vector<double>* values);
+
+private:
+    cvf::ref<Node>              m_root;
+    QString                     m_errorMessage;
+
+    // Parser state
+    QByteArray                  m_text;
+    int                         m_position;
+
+    // Evaluation state
+    RigReservoirCellResults*    m_results;
+    size_t                      m_timeStepCount;
+    size_t                      m_valueCount;   ///< Number of values in each timestep of the results used
+};
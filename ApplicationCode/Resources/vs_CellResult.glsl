@@ -0,0 +1,34 @@
+
+uniform vec2 u_cellTextureSize;     // Width and height of the texture holding one color per cell
+
+attribute float a_cellIndex;        // Index of the texel of the cell, row by row
+
+// Native visualization lib stuff
+uniform mat4 cvfu_modelViewProjectionMatrix;
+uniform mat4 cvfu_modelViewMatrix;
+uniform mat3 cvfu_normalMatrix;
+
+attribute vec4 cvfa_vertex;
+attribute vec3 cvfa_normal;
+
+varying vec3 v_ecPosition;
+varying vec3 v_ecNormal;
+varying vec2 v_texCoord;
+// End native vz stuff
+
+//--------------------------------------------------------------------------------------------------
+/// Vertex Shader - Cell result colors looked up in a texture by cell index
+//--------------------------------------------------------------------------------------------------
+void main()
+{
+    // Center of the texel of the cell
+    float row = floor((a_cellIndex + 0.5) / u_cellTextureSize.x);
+    float column = a_cellIndex - row*u_cellTextureSize.x;
+    v_texCoord = vec2((column + 0.5) / u_cellTextureSize.x, (row + 0.5) / u_cellTextureSize.y);
+
+    // Transforms vertex position and normal vector to eye space
+    v_ecPosition = (cvfu_modelViewMatrix * cvfa_vertex).xyz;
+    v_ecNormal = cvfu_normalMatrix * cvfa_normal;
+
+    gl_Position = cvfu_modelViewProjectionMatrix*cvfa_vertex;
+}
@@ -21,6 +21,8 @@
 #include <QDialog>
 #include <QAbstractSocket>
 
+#include <vector>
+
 class QLabel;
 class QPushButton;
 class QTcpServer;
@@ -34,47 +36,19 @@ class RiaSocketServer : public QObject
 {
     Q_OBJECT
 
-public:
-    enum ReadState {ReadingCommand, ReadingPropertyData};
-
 public:
     RiaSocketServer(QObject *parent = 0);
     ~RiaSocketServer();
     unsigned short  serverPort();
 
+    RimReservoir*   findReservoir(const QString &casename);
+    bool            findReservoirs(const QString& caseList, std::vector<RimReservoir*>* reservoirs);
+    void            showErrorMessage(const QString& message);
+
 private slots:
     void            slotNewClientConnection();
-    void            slotCurrentClientDisconnected();
-    void            slotReadyRead();
-
-private:
-    void            readCommandFromOctave();
-    void            readPropertyDataFromOctave();
-
-
-    void            handleClientConnection( QTcpSocket* clientToHandle);
-    RimReservoir*   findReservoir(const QString &casename);
-    void            terminateCurrentConnection();
 
 private:
     QTcpServer*     m_tcpServer;
     QErrorMessage*  m_errorMessageDialog;
-
-    QTcpSocket*     m_currentClient;
-    qint64          m_currentCommandSize; ///< The size in bytes of the command we are currently reading.
-
-
-    // Vars used for reading data from octave and adding them to the available results
-    ReadState       m_readState;
-    quint64         m_timeStepCountToRead;
-    quint64         m_bytesPerTimeStepToRead;
-    size_t          m_currentTimeStepToRead;
-    std::vector< std::vector<double> >* m_scalarResultsToAdd;
-    RimReservoir*   m_currentReservoir;
-    size_t          m_currentScalarIndex;
-    QString         m_currentPropertyName;
-    bool            m_invalidActiveCellCountDetected;
 };
-
-
-
@@ -0,0 +1,1450 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#include "RIStdInclude.h"
+
+#include <QtGui>
+#include <QtNetwork>
+
+#include <stdlib.h>
+#include <limits>
+#include <algorithm>
+
+#include "RiaSocketSession.h"
+#include "RiaSocketServer.h"
+#include "RIMainWindow.h"
+#include "RimReservoir.h"
+#include "RigReservoir.h"
+#include "RigReservoirCellResults.h"
+#include "RigResultExpression.h"
+#include "RimInputProperty.h"
+#include "RimInputReservoir.h"
+#include "RimUiTreeModelPdm.h"
+
+namespace
+{
+    const qint64 maxQueuedWriteByteCount = 4 * 1024 * 1024; ///< Produce no more data while this much is waiting to be sent
+    const size_t maxChunkByteCount = 1024 * 1024;
+
+    int sharedMemoryKeyCounter = 0;
+
+    //--------------------------------------------------------------------------------------------------
+    /// Parse "first-last" or "index" into an inclusive index range
+    //--------------------------------------------------------------------------------------------------
+    bool parseIndexRange(const QByteArray& text, size_t* first, size_t* last)
+    {
+        bool isFirstOk = false;
+        bool isLastOk = false;
+
+        int separatorPos = text.indexOf('-');
+        if (separatorPos < 0)
+        {
+            *first = text.toULongLong(&isFirstOk);
+            *last = *first;
+            isLastOk = true;
+        }
+        else
+        {
+            *first = text.left(separatorPos).toULongLong(&isFirstOk);
+            *last  = text.mid(separatorPos + 1).toULongLong(&isLastOk);
+        }
+
+        return isFirstOk && isLastOk && *first <= *last;
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    /// Parse a comma separated list of indices and index ranges like "0,3,5-8". 
+    /// All indices must be less than indexCount
+    //--------------------------------------------------------------------------------------------------
+    bool parseIndexList(const QByteArray& text, size_t indexCount, std::vector<size_t>* indices)
+    {
+        indices->clear();
+
+        QList<QByteArray> items = text.split(',');
+        for (int itemIdx = 0; itemIdx < items.size(); ++itemIdx)
+        {
+            size_t first, last;
+            if (!parseIndexRange(items[itemIdx], &first, &last) || last >= indexCount) return false;
+
+            for (size_t idx = first; idx <= last; ++idx)
+            {
+                indices->push_back(idx);
+            }
+        }
+
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    /// Copy valueCount values starting at firstValue into target. If cellIndices is non-empty, it 
+    /// selects the active cells to copy. Values missing in the source are set to HUGE_VAL
+    //--------------------------------------------------------------------------------------------------
+    template <typename SourceType, typename TargetType>
+    void copyValues(const std::vector<SourceType>& source, const std::vector<size_t>& cellIndices, size_t firstValue, size_t valueCount, TargetType* target)
+    {
+        for (size_t vIdx = 0; vIdx < valueCount; ++vIdx)
+        {
+            size_t sourceIdx = cellIndices.empty() ? firstValue + vIdx : cellIndices[firstValue + vIdx];
+            target[vIdx] = sourceIdx < source.size() ? static_cast<TargetType>(source[sourceIdx]) : static_cast<TargetType>(HUGE_VAL);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    /// Extract values from one timestep. Only the requested timestep is loaded. The values are set to
+    /// HUGE_VAL if the result or the timestep does not exist, like for a case in a multi case request
+    //--------------------------------------------------------------------------------------------------
+    template <typename TargetType>
+    void timeStepValues(RigReservoirCellResults* results, size_t scalarResultIndex, size_t timeStepIndex, 
+                        const std::vector<size_t>& cellIndices, size_t firstValue, size_t valueCount, TargetType* values)
+    {
+        if (scalarResultIndex == cvf::UNDEFINED_SIZE_T || timeStepIndex >= results->timeStepCount(scalarResultIndex))
+        {
+            std::fill(values, values + valueCount, static_cast<TargetType>(HUGE_VAL));
+            return;
+        }
+
+        results->loadTimeStep(scalarResultIndex, timeStepIndex);
+
+        if (results->isSinglePrecision(scalarResultIndex, timeStepIndex))
+        {
+            copyValues(results->singlePrecisionCellScalarResults(scalarResultIndex, timeStepIndex), cellIndices, firstValue, valueCount, values);
+        }
+        else
+        {
+            copyValues(results->cellScalarResults(scalarResultIndex, timeStepIndex), cellIndices, firstValue, valueCount, values);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------
+    /// 
+    //--------------------------------------------------------------------------------------------------
+    size_t timeStepValueCount(RigReservoirCellResults* results, size_t scalarResultIndex, size_t timeStepIndex)
+    {
+        results->loadTimeStep(scalarResultIndex, timeStepIndex);
+
+        if (results->isSinglePrecision(scalarResultIndex, timeStepIndex))
+        {
+            return results->singlePrecisionCellScalarResults(scalarResultIndex, timeStepIndex).size();
+        }
+
+        return results->cellScalarResults(scalarResultIndex, timeStepIndex).size();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// The session takes ownership of the socket
+//--------------------------------------------------------------------------------------------------
+RiaSocketSession::RiaSocketSession(QTcpSocket* socket, RiaSocketServer* server)
+: QObject(server),
+  m_server(server),
+  m_socket(socket),
+  m_currentCommandSize(0),
+  m_currentRequestId(cvf::UNDEFINED_SIZE_T),
+  m_isTerminated(false),
+  m_readState(ReadingCommand),
+  m_timeStepCountToRead(0),
+  m_bytesPerTimeStepToRead(0),
+  m_currentTimeStepToRead(0),
+  m_bytesReadInTimeStep(0),
+  m_isPropertyDataReadCancelled(false),
+  m_currentScalarIndex(cvf::UNDEFINED_SIZE_T),
+  m_invalidActiveCellCountDetected(false),
+  m_valueCountToWrite(0),
+  m_currentTimeStepToWrite(0),
+  m_currentCaseToWrite(0),
+  m_currentValueToWrite(0),
+  m_writeSinglePrecision(false),
+  m_sharedMemorySegmentsToAck(0)
+{
+    CVF_ASSERT(m_socket != NULL);
+    CVF_ASSERT(m_server != NULL);
+
+    m_socket->setParent(this);
+
+    connect(m_socket, SIGNAL(disconnected()), this, SLOT(slotDisconnected()));
+
+    if (m_socket->bytesAvailable())
+    {
+        this->slotReadyRead();
+    }
+
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(slotReadyRead()));
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+RiaSocketSession::~RiaSocketSession()
+{
+
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Read and execute one command. Returns false if the complete command is not available yet
+//--------------------------------------------------------------------------------------------------
+bool RiaSocketSession::readCommandFromOctave()
+{
+    QDataStream socketStream(m_socket);
+    socketStream.setVersion(QDataStream::Qt_4_0);
+
+    // If we have not read the currentCommandSize
+    // read the size of the command if all the data is available
+    if (m_currentCommandSize == 0) 
+    {
+        if (m_socket->bytesAvailable() < (int)sizeof(qint64)) return false;
+
+        socketStream >> m_currentCommandSize;
+    }
+
+    // Check if the complete command is available, return and whait for readyRead() if not
+    if (m_socket->bytesAvailable() < m_currentCommandSize) return false;
+
+    // Now we can read the command
+
+    QByteArray command = m_socket->read( m_currentCommandSize);
+    m_currentCommandSize = 0;
+
+    // The expression of ComputeProperty follows a free standing "=", and can contain spaces
+    QByteArray expression;
+    int assignmentPos = command.indexOf(" = ");
+    if (command.startsWith("ComputeProperty") && assignmentPos >= 0)
+    {
+        expression = command.mid(assignmentPos + 3).trimmed();
+        command.truncate(assignmentPos);
+    }
+
+    QTextStream commandStream(command);
+
+    QList<QByteArray> args;
+    while (!commandStream.atEnd())
+    {
+        QByteArray arg;
+        commandStream >> arg;
+        args.push_back(arg);
+    }
+
+    // Commands accept optional Key=Value arguments after the case and property names.
+    // RequestId=<number> is accepted by all commands, and makes the response start with the id. 
+    // A client can then send several commands without waiting, and match the responses to them
+
+    QList<QByteArray> options;
+    QList<QByteArray> positionalArgs;
+    m_currentRequestId = cvf::UNDEFINED_SIZE_T;
+
+    for (int aIdx = 0; aIdx < args.size(); ++aIdx)
+    {
+        if (args[aIdx].startsWith("RequestId="))
+        {
+            m_currentRequestId = args[aIdx].mid(args[aIdx].indexOf('=') + 1).toULongLong();
+        }
+        else if (args[aIdx].contains('='))
+        {
+            options.push_back(args[aIdx]);
+        }
+        else if (!args[aIdx].isEmpty())
+        {
+            positionalArgs.push_back(args[aIdx]);
+        }
+    }
+    args = positionalArgs;
+
+    if (args.isEmpty()) return true;
+
+
+    bool isGetProperty = args[0] == "GetProperty"; // GetProperty [casename/index] PropertyName [TimeSteps=0,2-4] [Cells=0-99|CellBox=i1-i2,j1-j2,k1-k2] [ValueType=Float32] [Transport=SharedMemory]
+    bool isSetProperty = args[0] == "SetProperty"; // SetProperty [casename/index] PropertyName [SharedMemoryKey=key]
+    bool isGetCellInfo = args[0] == "GetActiveCellInfo"; // GetActiveCellInfo [casename/index]
+    bool isGetCellCenters = args[0] == "GetActiveCellCenters"; // GetActiveCellCenters [casename/index]
+    bool isGetCellCorners = args[0] == "GetActiveCellCorners"; // GetActiveCellCorners [casename/index]
+    bool isGetGridDim  = args[0] == "GetMainGridDimensions"; // GetMainGridDimensions [casename/index]
+    bool isGetAllGridDims = args[0] == "GetGridDimensions"; // GetGridDimensions [casename/index]
+    bool isComputeProperty = args[0] == "ComputeProperty"; // ComputeProperty [casename/index] PropertyName = Expression
+    bool isGetMultiCaseProperty = args[0] == "GetMultiCaseProperty"; // GetMultiCaseProperty All|case1,case2 PropertyName [TimeSteps=0,2-4] [Cells=0-99|CellBox=i1-i2,j1-j2,k1-k2] [ValueType=Float32] [Transport=SharedMemory]
+
+
+    bool isGridQuery = isGetCellInfo || isGetCellCenters || isGetCellCorners || isGetGridDim || isGetAllGridDims;
+
+    if (!(isGetProperty || isSetProperty || isGridQuery || isComputeProperty || isGetMultiCaseProperty))
+    {
+        m_server->showErrorMessage(tr("Unknown command: %1").arg(args[0].data()));
+        terminate();
+        return false;
+    }
+
+    if (isGetMultiCaseProperty)
+    {
+        writeRequestId();
+
+        std::vector<RimReservoir*> reservoirs;
+        if (args.size() < 3 || !m_server->findReservoirs(args[1], &reservoirs) || !startMultiCasePropertyDataStream(reservoirs, args[2], options))
+        {
+            // No data available
+            socketStream << (quint64)0 << (quint64)0 << (quint64)0;
+        }
+
+        return true;
+    }
+
+    QString caseName;
+    QString propertyName;
+    RimReservoir* reservoir = NULL;
+
+    // Find the correct arguments
+
+    if (isGetProperty || isSetProperty || isComputeProperty)
+    {
+        if (args.size() == 2)
+        {
+            propertyName = args[1];
+        }
+        else if (args.size() > 2)
+        {
+            caseName = args[1];
+            propertyName = args[2];
+        }
+    }
+    else if (isGridQuery)
+    {
+        if (args.size() > 1)
+        {
+            caseName = args[1];
+        }
+    }
+
+    reservoir = m_server->findReservoir(caseName);
+
+    if (reservoir == NULL)
+    {
+        // Answer with no data, so the following commands can still be served
+        m_server->showErrorMessage(tr("Could not find the eclipse case with name or index: \"%1\"").arg(caseName));
+    }
+
+    // The response of SetProperty is written when its data has been read
+    if (!isSetProperty)
+    {
+        writeRequestId();
+    }
+
+    if (isGetProperty || isSetProperty)
+    {
+        // Find the requested data. Data that is set is stored in the result when all of it is read
+
+        size_t scalarResultIndex = cvf::UNDEFINED_SIZE_T;
+        m_currentScalarIndex = cvf::UNDEFINED_SIZE_T;
+        m_currentPropertyName = propertyName;
+        RigReservoirCellResults* results = NULL;
+
+        if (isGetProperty && reservoir && reservoir->reservoirData() && reservoir->reservoirData()->mainGrid() && reservoir->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS))
+        {
+            results = reservoir->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+            scalarResultIndex = results->findOrLoadScalarResult(propertyName);
+            m_currentScalarIndex = scalarResultIndex;
+
+            if (scalarResultIndex == cvf::UNDEFINED_SIZE_T)
+            {
+                m_server->showErrorMessage(tr("Could not find the property named: \"%1\"").arg(propertyName));
+            }
+        }
+
+        if (isGetProperty )
+        {
+            // Write data back : timeStepCount, bytesPrTimestep, dataForTimestep0 ... dataForTimestepN
+            // The data is written in chunks from writePropertyDataChunks() as the socket gets it sent
+
+            if ( scalarResultIndex == cvf::UNDEFINED_SIZE_T || results->timeStepCount(scalarResultIndex) == 0 
+                || !startPropertyDataStream(std::vector<RimReservoir*>(1, reservoir), std::vector<size_t>(1, scalarResultIndex), options, false))
+            {
+                // No data available
+                socketStream << (quint64)0 << (quint64)0 ;
+            }
+        }
+        else // Set property
+        {
+            m_readState = ReadingPropertyData;
+
+            m_sharedMemoryKeyToRead.clear();
+            for (int oIdx = 0; oIdx < options.size(); ++oIdx)
+            {
+                if (options[oIdx].startsWith("SharedMemoryKey="))
+                {
+                    m_sharedMemoryKeyToRead = options[oIdx].mid(options[oIdx].indexOf('=') + 1);
+                }
+            }
+
+            // The data is read by readPropertyDataFromOctave(). It is skipped if the case is not found
+            m_currentReservoir = reservoir;
+        }
+    }
+    else if (isGetCellInfo )
+    {
+        // Write data back to octave: columnCount, bytesPrColumn, GridNr I J K ParentGridNr PI PJ PK
+        // The info is computed along with the other cached grid data, and sent as it is
+
+        if (!(reservoir && reservoir->reservoirData() && reservoir->reservoirData()->mainGrid()) )
+        {
+            // No data available
+            socketStream << (quint64)0 << (quint64)0 ;
+            return true;
+        }
+
+        const std::vector< std::vector<qint32> >& activeCellInfo = reservoir->reservoirData()->mainGrid()->matrixModelActiveCellInfo();
+        if (activeCellInfo.empty())
+        {
+            socketStream << (quint64)0 << (quint64)0 ;
+            return true;
+        }
+
+        // First write column count
+        quint64 columnCount = (quint64)activeCellInfo.size();
+        socketStream << columnCount;
+
+        // then the byte-size of the values in one column
+        size_t  columnValueCount = activeCellInfo[0].size();
+        quint64 columnByteCount = (quint64)(columnValueCount*sizeof(qint32));
+        socketStream << columnByteCount ;
+
+        // Then write the data.
+
+        for (size_t colIdx = 0; colIdx < activeCellInfo.size(); ++colIdx)
+        {
+#if 1 // Write data as raw bytes, fast but does not handle byteswapping
+            m_socket->write((const char *)activeCellInfo[colIdx].data(), columnByteCount);
+#else  // Write data using QDataStream, does byteswapping for us. Must use QDataStream on client as well
+            for (size_t cIdx = 0; cIdx < activeCellInfo[colIdx].size(); ++cIdx)
+            {
+                socketStream << activeCellInfo[colIdx][cIdx];
+            }
+#endif
+        }
+    }
+    else if (isGetCellCenters || isGetCellCorners)
+    {
+        // Write data back to octave: columnCount, bytesPrColumn, X Y Z of the cell centers, 
+        // or X of corner 0 to 7, Y of corner 0 to 7 and Z of corner 0 to 7
+
+        if (!(reservoir && reservoir->reservoirData() && reservoir->reservoirData()->mainGrid()) )
+        {
+            // No data available
+            socketStream << (quint64)0 << (quint64)0 ;
+            return true;
+        }
+
+        RigMainGrid* mainGrid = reservoir->reservoirData()->mainGrid();
+
+        std::vector<double> coordinates;
+        size_t columnCount = 0;
+        if (isGetCellCenters)
+        {
+            mainGrid->matrixModelActiveCellCenters(&coordinates);
+            columnCount = 3;
+        }
+        else
+        {
+            mainGrid->matrixModelActiveCellCorners(&coordinates);
+            columnCount = 24;
+        }
+
+        size_t columnValueCount = coordinates.size() / columnCount;
+        if (columnValueCount == 0)
+        {
+            socketStream << (quint64)0 << (quint64)0 ;
+            return true;
+        }
+
+        quint64 columnByteCount = (quint64)(columnValueCount*sizeof(double));
+        socketStream << (quint64)columnCount << columnByteCount;
+
+        // The columns are contiguous, so all of them are written in one go
+        m_socket->write((const char *)coordinates.data(), columnCount*columnByteCount);
+    }
+    else if (isGetGridDim)
+    {
+        // Write data back to octave: I, J, K dimensions
+
+        size_t iCount = 0;
+        size_t jCount = 0;
+        size_t kCount = 0;
+
+        if (reservoir && reservoir->reservoirData() && reservoir->reservoirData()->mainGrid())
+        {
+             iCount = reservoir->reservoirData()->mainGrid()->cellCountI();
+             jCount = reservoir->reservoirData()->mainGrid()->cellCountJ();
+             kCount = reservoir->reservoirData()->mainGrid()->cellCountK();
+        }
+
+        socketStream << (quint64)iCount << (quint64)jCount << (quint64)kCount;
+    }
+    else if (isGetAllGridDims)
+    {
+        // Write data back to octave: gridCount, then I, J, K dimensions of each grid in grid index order,
+        // starting with the main grid
+
+        if (!(reservoir && reservoir->reservoirData() && reservoir->reservoirData()->mainGrid()) )
+        {
+            socketStream << (quint64)0;
+            return true;
+        }
+
+        const RigMainGrid* mainGrid = reservoir->reservoirData()->mainGrid();
+        size_t gridCount = mainGrid->gridCount();
+
+        socketStream << (quint64)gridCount;
+        for (size_t gIdx = 0; gIdx < gridCount; ++gIdx)
+        {
+            const RigGridBase* grid = mainGrid->gridByIndex(gIdx);
+            socketStream << (quint64)grid->cellCountI() << (quint64)grid->cellCountJ() << (quint64)grid->cellCountK();
+        }
+    }
+    else if (isComputeProperty)
+    {
+        // Write back the number of timesteps computed. 0 if the expression could not be computed
+
+        quint64 timeStepsComputed = 0;
+
+        if (reservoir && reservoir->reservoirData() && reservoir->reservoirData()->mainGrid() && reservoir->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS))
+        {
+            RigReservoirCellResults* results = reservoir->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+
+            RigResultExpression resultExpression;
+            size_t scalarResultIndex = cvf::UNDEFINED_SIZE_T;
+
+            if (propertyName.isEmpty() || expression.isEmpty())
+            {
+                m_server->showErrorMessage(tr("ComputeProperty needs a property name and an expression: ComputeProperty PropertyName = Expression"));
+            }
+            else if (resultExpression.parse(expression))
+            {
+                scalarResultIndex = resultExpression.computeResult(results, propertyName);
+            }
+
+            if (scalarResultIndex != cvf::UNDEFINED_SIZE_T)
+            {
+                timeStepsComputed = results->timeStepCount(scalarResultIndex);
+                propertyDataChanged(reservoir, scalarResultIndex, propertyName);
+            }
+            else if (!resultExpression.errorMessage().isEmpty())
+            {
+                m_server->showErrorMessage(tr("Could not compute \"%1 = %2\": %3").arg(propertyName).arg(QString(expression)).arg(resultExpression.errorMessage()));
+            }
+        }
+
+        socketStream << timeStepsComputed;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// This method reads data from octave and puts it into the resInsight Structures.
+/// The data is read into a separate buffer as it arrives, including partial timesteps, so the 
+/// application is not held up by large transfers. The result is replaced when all the data is read.
+/// Returns true when all the data of the SetProperty command has been read
+//--------------------------------------------------------------------------------------------------
+bool RiaSocketSession::readPropertyDataFromOctave()
+{
+    QDataStream socketStream(m_socket);
+    socketStream.setVersion(QDataStream::Qt_4_0);
+
+    // If we have not read the header and there are data enough: Read it.
+    // Do nothing if we have not enough data
+
+    if (m_timeStepCountToRead == 0 || m_bytesPerTimeStepToRead == 0)
+    {
+        if (m_socket->bytesAvailable() < (int)sizeof(quint64)*2) return false;
+
+        socketStream >> m_timeStepCountToRead;
+        socketStream >> m_bytesPerTimeStepToRead;
+    }
+
+    bool isUsingSharedMemory = !m_sharedMemoryKeyToRead.isEmpty();
+
+    // If nothing should be read, we are done
+
+    if (m_timeStepCountToRead == 0 || m_bytesPerTimeStepToRead == 0)
+    {
+        finishPropertyDataRead(0);
+        return true;
+    }
+
+    // The timesteps are read straight into vectors of doubles, so a partial value would overrun them
+
+    if (m_bytesPerTimeStepToRead % sizeof(double) != 0)
+    {
+        m_server->showErrorMessage(tr("The size of the data coming from octave is not a whole number of doubles: %1 bytes per time step").arg(m_bytesPerTimeStepToRead));
+
+        m_invalidActiveCellCountDetected = true;
+        m_socket->abort();
+
+        return false;
+    }
+
+    // The case might not be found, or closed while another client was served, or the user cancelled. 
+    // Skip the data to be able to read the next command
+    if (m_currentReservoir.isNull() || m_isPropertyDataReadCancelled)
+    {
+        while (!isUsingSharedMemory && m_currentTimeStepToRead < m_timeStepCountToRead && m_socket->bytesAvailable() > 0)
+        {
+            qint64 byteCount = qMin(m_socket->bytesAvailable(), (qint64)(m_bytesPerTimeStepToRead - m_bytesReadInTimeStep));
+            discardBytes(byteCount);
+
+            m_bytesReadInTimeStep += byteCount;
+            if (m_bytesReadInTimeStep == m_bytesPerTimeStepToRead)
+            {
+                m_bytesReadInTimeStep = 0;
+                ++m_currentTimeStepToRead;
+            }
+        }
+
+        if (isUsingSharedMemory || m_currentTimeStepToRead == m_timeStepCountToRead)
+        {
+            finishPropertyDataRead(0);
+            return true;
+        }
+
+        return false;
+    }
+
+    size_t  cellCountFromOctave = m_bytesPerTimeStepToRead / sizeof(double);
+
+    if (m_scalarResultsToRead.empty())
+    {
+        size_t gridActiveCellCount = m_currentReservoir->reservoirData()->mainGrid()->globalMatrixModelActiveCellCount();
+        size_t gridTotalCellCount = m_currentReservoir->reservoirData()->mainGrid()->cellCount();
+
+        if (cellCountFromOctave != gridActiveCellCount && cellCountFromOctave != gridTotalCellCount)
+        {
+            m_server->showErrorMessage(
+                tr("The number of cells in the data coming from octave does not match the case") + ":\""  + m_currentReservoir->caseName() + "\"\n"
+                "   Octave: " + QString::number(cellCountFromOctave) + "\n"
+                "  " + m_currentReservoir->caseName() + ": Active cell count: " + QString::number(gridActiveCellCount) + " Total cell count: " +  QString::number(gridTotalCellCount)) ;
+
+            cellCountFromOctave = 0;
+            m_invalidActiveCellCountDetected = true;
+            m_socket->abort();
+
+            return false;
+        }
+
+        // The timesteps are allocated as their data arrives
+        m_scalarResultsToRead.resize(m_timeStepCountToRead);
+
+        if (!isUsingSharedMemory)
+        {
+            // Shown only if the transfer takes a while
+            m_progressDialog = new QProgressDialog(tr("Receiving %1 from Octave").arg(m_currentPropertyName), tr("Cancel"), 0, static_cast<int>(m_timeStepCountToRead), RIMainWindow::instance());
+            m_progressDialog->setWindowModality(Qt::NonModal);
+            m_progressDialog->setMinimumDuration(500);
+            m_progressDialog->setValue(0);
+            connect(m_progressDialog, SIGNAL(canceled()), this, SLOT(slotCancelPropertyDataRead()));
+        }
+    }
+
+    if (isUsingSharedMemory && !readPropertyDataFromSharedMemory(&m_scalarResultsToRead))
+    {
+        m_socket->abort();
+        return false;
+    }
+
+    // Read the available data straight into the timestep it belongs to
+    while (m_currentTimeStepToRead < m_timeStepCountToRead && m_socket->bytesAvailable() > 0)
+    {
+        std::vector<double>& timeStepValues = m_scalarResultsToRead[m_currentTimeStepToRead];
+        if (timeStepValues.empty())
+        {
+            timeStepValues.resize(cellCountFromOctave);
+        }
+
+        // Use raw data transfer. Does not handle byteswapping
+        char* internalMatrixData = reinterpret_cast<char*>(timeStepValues.data()) + m_bytesReadInTimeStep;
+        qint64 bytesRead = m_socket->read(internalMatrixData, m_bytesPerTimeStepToRead - m_bytesReadInTimeStep);
+
+        if (bytesRead <= 0)
+        {
+            m_server->showErrorMessage(tr("Could not read binary double data properly from socket"));
+            break;
+        }
+
+        m_bytesReadInTimeStep += bytesRead;
+        if (m_bytesReadInTimeStep == m_bytesPerTimeStepToRead)
+        {
+            m_bytesReadInTimeStep = 0;
+            ++m_currentTimeStepToRead;
+
+            if (m_progressDialog) m_progressDialog->setValue(static_cast<int>(m_currentTimeStepToRead));
+        }
+    }
+
+    if (m_currentTimeStepToRead < m_timeStepCountToRead) return false;
+
+    // All the data is read. Replace the result in one go, and refresh the views
+
+    RigReservoirCellResults* results = NULL;
+    if (m_currentReservoir->reservoirData() && m_currentReservoir->reservoirData()->mainGrid())
+    {
+        results = m_currentReservoir->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+    }
+
+    if (!results)
+    {
+        finishPropertyDataRead(0);
+        return true;
+    }
+
+    m_currentScalarIndex = results->findScalarResultIndex(m_currentPropertyName);
+    if (m_currentScalarIndex == cvf::UNDEFINED_SIZE_T)
+    {
+        m_currentScalarIndex = results->addEmptyScalarResult(RimDefines::GENERATED, m_currentPropertyName);
+    }
+
+    results->replaceCellScalarResults(m_currentScalarIndex, &m_scalarResultsToRead);
+
+    propertyDataChanged(m_currentReservoir, m_currentScalarIndex, m_currentPropertyName);
+
+    finishPropertyDataRead(m_currentTimeStepToRead);
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Register the property as an input property of input cases, update its statistics and redraw the 
+/// views after new data has been stored
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::propertyDataChanged(RimReservoir* reservoir, size_t scalarResultIndex, const QString& propertyName)
+{
+    if (!reservoir) return;
+
+    // Create a new input property if we have an input reservoir
+    RimInputReservoir* inputRes = dynamic_cast<RimInputReservoir*>(reservoir);
+    if (inputRes)
+    {
+        RimInputProperty* inputProperty = NULL;
+        inputProperty = inputRes->m_inputPropertyCollection->findInputProperty(propertyName);
+        if (!inputProperty)
+        {
+            inputProperty = new RimInputProperty;
+            inputProperty->resultName = propertyName;
+            inputProperty->eclipseKeyword = "";
+            inputProperty->fileName = "";
+            inputRes->m_inputPropertyCollection->inputProperties.push_back(inputProperty);
+            RimUiTreeModelPdm* treeModel = RIMainWindow::instance()->uiPdmModel();
+            treeModel->rebuildUiSubTree(inputRes->m_inputPropertyCollection());
+        }
+        inputProperty->resolvedState = RimInputProperty::RESOLVED_NOT_SAVED;
+    }
+
+    if( scalarResultIndex != cvf::UNDEFINED_SIZE_T &&
+        reservoir->reservoirData() && 
+        reservoir->reservoirData()->mainGrid() &&
+        reservoir->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS) )
+    {
+        reservoir->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS)->recalculateMinMax(scalarResultIndex);
+    }
+
+    for (size_t i = 0; i < reservoir->reservoirViews.size(); ++i)
+    {
+        if (reservoir->reservoirViews[i])
+        {
+            reservoir->reservoirViews[i]->updateCurrentTimeStepAndRedraw();
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Acknowledge a SetProperty command with the number of timesteps stored, if the client waits 
+/// for it, and go back to reading commands
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::finishPropertyDataRead(quint64 timeStepsStored)
+{
+    if (!m_sharedMemoryKeyToRead.isEmpty() || m_currentRequestId != cvf::UNDEFINED_SIZE_T)
+    {
+        writeRequestId();
+
+        QDataStream socketStream(m_socket);
+        socketStream.setVersion(QDataStream::Qt_4_0);
+
+        socketStream << timeStepsStored;
+    }
+
+    m_timeStepCountToRead = 0;
+    m_bytesPerTimeStepToRead = 0;
+    m_currentTimeStepToRead = 0;
+    m_bytesReadInTimeStep = 0;
+    m_isPropertyDataReadCancelled = false;
+    m_sharedMemoryKeyToRead.clear();
+    std::vector< std::vector<double> >().swap(m_scalarResultsToRead);
+    if (m_progressDialog) m_progressDialog->deleteLater();
+    m_readState = ReadingCommand;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Called when the user cancels receiving property data. The rest of the data is skipped, 
+/// and the result is left unchanged
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::slotCancelPropertyDataRead()
+{
+    if (m_readState != ReadingPropertyData) return;
+
+    m_isPropertyDataReadCancelled = true;
+    std::vector< std::vector<double> >().swap(m_scalarResultsToRead);
+
+    // Skip the data that has already arrived, and continue with the commands after it
+    slotReadyRead();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::discardBytes(qint64 byteCount)
+{
+    char buffer[64 * 1024];
+
+    while (byteCount > 0)
+    {
+        qint64 bytesRead = m_socket->read(buffer, qMin(byteCount, (qint64)sizeof(buffer)));
+        if (bytesRead <= 0) break;
+
+        byteCount -= bytesRead;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Start the response with the request id of the current command, if it was given
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::writeRequestId()
+{
+    if (m_currentRequestId == cvf::UNDEFINED_SIZE_T) return;
+
+    QDataStream socketStream(m_socket);
+    socketStream.setVersion(QDataStream::Qt_4_0);
+
+    socketStream << (quint64)m_currentRequestId;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Find the property in each of the cases, and stream the values of all the cases. The cases must 
+/// have the same number of active cells. Cases without the property, or with fewer timesteps, 
+/// get HUGE_VAL values. Returns false if no data can be sent
+//--------------------------------------------------------------------------------------------------
+bool RiaSocketSession::startMultiCasePropertyDataStream(const std::vector<RimReservoir*>& reservoirs, const QString& propertyName, const QList<QByteArray>& options)
+{
+    std::vector<size_t> scalarResultIndices(reservoirs.size(), cvf::UNDEFINED_SIZE_T);
+    size_t activeCellCount = cvf::UNDEFINED_SIZE_T;
+    bool isPropertyFound = false;
+
+    for (size_t cIdx = 0; cIdx < reservoirs.size(); ++cIdx)
+    {
+        RimReservoir* reservoir = reservoirs[cIdx];
+        if (!(reservoir->reservoirData() && reservoir->reservoirData()->mainGrid() && reservoir->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS)))
+        {
+            m_server->showErrorMessage(tr("The eclipse case \"%1\" is not loaded").arg(reservoir->caseName()));
+            return false;
+        }
+
+        RigMainGrid* mainGrid = reservoir->reservoirData()->mainGrid();
+        if (activeCellCount == cvf::UNDEFINED_SIZE_T)
+        {
+            activeCellCount = mainGrid->globalMatrixModelActiveCellCount();
+        }
+        else if (activeCellCount != mainGrid->globalMatrixModelActiveCellCount())
+        {
+            m_server->showErrorMessage(tr("The cases must have the same number of active cells. \"%1\" has %2, while the first case has %3")
+                .arg(reservoir->caseName()).arg(mainGrid->globalMatrixModelActiveCellCount()).arg(activeCellCount));
+            return false;
+        }
+
+        RigReservoirCellResults* results = mainGrid->results(RifReaderInterface::MATRIX_RESULTS);
+        scalarResultIndices[cIdx] = results->findOrLoadScalarResult(propertyName);
+
+        if (scalarResultIndices[cIdx] != cvf::UNDEFINED_SIZE_T && results->timeStepCount(scalarResultIndices[cIdx]) > 0)
+        {
+            isPropertyFound = true;
+        }
+    }
+
+    if (!isPropertyFound)
+    {
+        m_server->showErrorMessage(tr("Could not find the property named: \"%1\"").arg(propertyName));
+        return false;
+    }
+
+    return startPropertyDataStream(reservoirs, scalarResultIndices, options, true);
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Set up streaming of the results according to the GetProperty options, and write the header:
+/// [caseCount], timeStepCount, bytesPrTimestep. Returns false if the options are invalid. 
+/// The cell selection uses the grid of the first case. With several cases, the values are sent 
+/// timestep by timestep, with the values of all the cases for each timestep
+//--------------------------------------------------------------------------------------------------
+bool RiaSocketSession::startPropertyDataStream(const std::vector<RimReservoir*>& reservoirs, const std::vector<size_t>& scalarResultIndices, 
+                                               const QList<QByteArray>& options, bool writeCaseCount)
+{
+    CVF_ASSERT(!reservoirs.empty() && reservoirs.size() == scalarResultIndices.size());
+
+    RigMainGrid* mainGrid = reservoirs[0]->reservoirData()->mainGrid();
+
+    size_t timeStepCount = 0;
+    for (size_t cIdx = 0; cIdx < reservoirs.size(); ++cIdx)
+    {
+        if (scalarResultIndices[cIdx] == cvf::UNDEFINED_SIZE_T) continue;
+
+        RigReservoirCellResults* results = reservoirs[cIdx]->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+        timeStepCount = qMax(timeStepCount, results->timeStepCount(scalarResultIndices[cIdx]));
+    }
+
+    std::vector<size_t> timeSteps;
+    std::vector<size_t> cellIndices;
+    bool hasCellSelection = false;
+    bool singlePrecision = false;
+    bool useSharedMemory = false;
+
+    for (int oIdx = 0; oIdx < options.size(); ++oIdx)
+    {
+        int separatorPos = options[oIdx].indexOf('=');
+        QByteArray key = options[oIdx].left(separatorPos);
+        QByteArray value = options[oIdx].mid(separatorPos + 1);
+
+        bool isValid = false;
+        if (key == "TimeSteps")
+        {
+            isValid = parseIndexList(value, timeStepCount, &timeSteps);
+        }
+        else if (key == "Cells")
+        {
+            isValid = parseIndexList(value, mainGrid->globalMatrixModelActiveCellCount(), &cellIndices);
+            hasCellSelection = true;
+        }
+        else if (key == "CellBox")
+        {
+            QList<QByteArray> ranges = value.split(',');
+            cvf::Vec3st min, max;
+
+            isValid = ranges.size() == 3;
+            for (int dim = 0; isValid && dim < 3; ++dim)
+            {
+                isValid = parseIndexRange(ranges[dim], &min[dim], &max[dim]);
+            }
+
+            if (isValid)
+            {
+                mainGrid->matrixModelActiveCellIndicesInBox(min, max, &cellIndices);
+                hasCellSelection = true;
+            }
+        }
+        else if (key == "ValueType")
+        {
+            isValid = value == "Float32" || value == "Float64";
+            singlePrecision = value == "Float32";
+        }
+        else if (key == "Transport")
+        {
+            isValid = value == "Socket" || value == "SharedMemory";
+            useSharedMemory = value == "SharedMemory";
+        }
+
+        if (!isValid)
+        {
+            m_server->showErrorMessage(tr("Invalid GetProperty argument: \"%1\"").arg(options[oIdx].data()));
+            return false;
+        }
+    }
+
+    // The cell selection is given as active cell indices, while results with a value for all the cells
+    // are indexed by global cell index. Map the selection for a single case. The cases of a multi case
+    // request might have different active cells, so they must all have values for the active cells only,
+    // whether cells are selected or not
+
+    bool isUsingActiveIndex = true;
+    for (size_t cIdx = 0; cIdx < reservoirs.size(); ++cIdx)
+    {
+        if (scalarResultIndices[cIdx] == cvf::UNDEFINED_SIZE_T) continue;
+
+        RigReservoirCellResults* results = reservoirs[cIdx]->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+        if (!results->isUsingGlobalActiveIndex(scalarResultIndices[cIdx])) isUsingActiveIndex = false;
+    }
+
+    if (!isUsingActiveIndex && reservoirs.size() > 1)
+    {
+        m_server->showErrorMessage(tr("Properties with values for all the cells can not be read from several cases"));
+        return false;
+    }
+
+    if (hasCellSelection)
+    {
+        if (!isUsingActiveIndex)
+        {
+            const std::vector<RigCell>& cells = mainGrid->cells();
+
+            std::vector<size_t> activeToGlobalCellIndex(mainGrid->globalMatrixModelActiveCellCount(), cvf::UNDEFINED_SIZE_T);
+            for (size_t gIdx = 0; gIdx < cells.size(); ++gIdx)
+            {
+                if (cells[gIdx].isActiveInMatrixModel())
+                {
+                    activeToGlobalCellIndex[cells[gIdx].activeIndexInMatrixModel()] = gIdx;
+                }
+            }
+
+            for (size_t vIdx = 0; vIdx < cellIndices.size(); ++vIdx)
+            {
+                cellIndices[vIdx] = activeToGlobalCellIndex[cellIndices[vIdx]];
+            }
+        }
+    }
+
+    if (timeSteps.empty())
+    {
+        for (size_t tIdx = 0; tIdx < timeStepCount; ++tIdx)
+        {
+            timeSteps.push_back(tIdx);
+        }
+    }
+
+    size_t valueCount = cellIndices.size();
+    if (!hasCellSelection)
+    {
+        valueCount = mainGrid->globalMatrixModelActiveCellCount();
+
+        // Results with a value for all the cells are sent as they are, for a single case
+        if (reservoirs.size() == 1)
+        {
+            size_t resultValueCount = timeStepValueCount(mainGrid->results(RifReaderInterface::MATRIX_RESULTS), scalarResultIndices[0], timeSteps[0]);
+            if (resultValueCount > 0) valueCount = resultValueCount;
+        }
+    }
+
+    QDataStream socketStream(m_socket);
+    socketStream.setVersion(QDataStream::Qt_4_0);
+
+    if (writeCaseCount)
+    {
+        socketStream << (quint64)reservoirs.size();
+    }
+    socketStream << (quint64)timeSteps.size();
+    socketStream << (quint64)(valueCount * (singlePrecision ? sizeof(float) : sizeof(double)));
+
+    m_casesToWrite.assign(reservoirs.begin(), reservoirs.end());
+    m_scalarIndicesToWrite = scalarResultIndices;
+    m_timeStepsToWrite.swap(timeSteps);
+    m_cellIndicesToWrite.swap(cellIndices);
+    m_valueCountToWrite = valueCount;
+    m_currentTimeStepToWrite = 0;
+    m_currentCaseToWrite = 0;
+    m_currentValueToWrite = 0;
+    m_writeSinglePrecision = singlePrecision;
+
+    // With shared memory, the header is followed by keyByteCount, key. If the key is empty, 
+    // the data is sent on the socket as usual
+
+    if (useSharedMemory)
+    {
+        QByteArray sharedMemoryKey = writePropertyDataToSharedMemory().toLatin1();
+
+        socketStream << (quint64)sharedMemoryKey.size();
+        m_socket->write(sharedMemoryKey);
+
+        if (!sharedMemoryKey.isEmpty())
+        {
+            resetWriteState();
+
+            // Wait for the client to release the segments one by one
+            m_sharedMemorySegmentsToAck = m_sharedMemorySegments.size();
+            m_readState = ReadingSharedMemoryAcks;
+
+            return true;
+        }
+    }
+
+    m_readState = WritingPropertyData;
+
+    connect(m_socket, SIGNAL(bytesWritten(qint64)), this, SLOT(slotBytesWritten()));
+
+    writePropertyDataChunks();
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Write the requested values chunk by chunk. Stops when the socket has enough data queued, 
+/// and continues when it has been sent. Only the timestep being written needs to be loaded
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::writePropertyDataChunks()
+{
+    size_t valueByteCount = m_writeSinglePrecision ? sizeof(float) : sizeof(double);
+    size_t maxChunkValueCount = maxChunkByteCount / valueByteCount;
+
+    std::vector<float>  singlePrecisionValues;
+    std::vector<double> values;
+
+    while (m_currentTimeStepToWrite < m_timeStepsToWrite.size())
+    {
+        if (m_socket->bytesToWrite() >= maxQueuedWriteByteCount) return;
+
+        // The case might have been closed while the data was sent. The client can not recover from a truncated stream
+        if (!areCasesToWriteLoaded())
+        {
+            m_socket->abort();
+            return;
+        }
+
+        size_t timeStepIndex = m_timeStepsToWrite[m_currentTimeStepToWrite];
+
+        if (m_currentCaseToWrite == 0 && m_currentValueToWrite == 0)
+        {
+            loadTimeStepOfCasesToWrite(timeStepIndex);
+        }
+
+        RigReservoirCellResults* results = m_casesToWrite[m_currentCaseToWrite]->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+        size_t scalarResultIndex = m_scalarIndicesToWrite[m_currentCaseToWrite];
+        size_t chunkValueCount = qMin(m_valueCountToWrite - m_currentValueToWrite, maxChunkValueCount);
+
+        // Raw print of data. Fast but no platform conversion
+        if (m_writeSinglePrecision)
+        {
+            singlePrecisionValues.resize(chunkValueCount);
+            timeStepValues(results, scalarResultIndex, timeStepIndex, m_cellIndicesToWrite, m_currentValueToWrite, chunkValueCount, singlePrecisionValues.data());
+            m_socket->write((const char *)singlePrecisionValues.data(), chunkValueCount * valueByteCount);
+        }
+        else
+        {
+            values.resize(chunkValueCount);
+            timeStepValues(results, scalarResultIndex, timeStepIndex, m_cellIndicesToWrite, m_currentValueToWrite, chunkValueCount, values.data());
+            m_socket->write((const char *)values.data(), chunkValueCount * valueByteCount);
+        }
+
+        m_currentValueToWrite += chunkValueCount;
+        if (m_currentValueToWrite >= m_valueCountToWrite)
+        {
+            m_currentValueToWrite = 0;
+            ++m_currentCaseToWrite;
+        }
+
+        if (m_currentCaseToWrite >= m_casesToWrite.size())
+        {
+            m_currentCaseToWrite = 0;
+            ++m_currentTimeStepToWrite;
+        }
+    }
+
+    // All data is queued. Go back to reading commands, including any that arrived meanwhile
+
+    m_socket->disconnect(SIGNAL(bytesWritten(qint64)));
+
+    resetWriteState();
+
+    if (m_socket->bytesAvailable())
+    {
+        QMetaObject::invokeMethod(this, "slotReadyRead", Qt::QueuedConnection);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+bool RiaSocketSession::areCasesToWriteLoaded() const
+{
+    for (size_t cIdx = 0; cIdx < m_casesToWrite.size(); ++cIdx)
+    {
+        if (m_casesToWrite[cIdx].isNull() || !m_casesToWrite[cIdx]->reservoirData()) return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Load the timestep in all the cases to write before their values are copied. Each case has its
+/// own results and reader, so different cases are read in parallel. A case listed more than once 
+/// is loaded only once, as neither the results nor the reader can be used by several threads.
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::loadTimeStepOfCasesToWrite(size_t timeStepIndex)
+{
+    if (m_casesToWrite.size() < 2) return;
+
+    std::vector<RigReservoirCellResults*> results;
+    std::vector<size_t> scalarResultIndices;
+    for (size_t cIdx = 0; cIdx < m_casesToWrite.size(); ++cIdx)
+    {
+        RigReservoirCellResults* caseResults = m_casesToWrite[cIdx]->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+        size_t scalarResultIndex = m_scalarIndicesToWrite[cIdx];
+
+        if (scalarResultIndex == cvf::UNDEFINED_SIZE_T || timeStepIndex >= caseResults->timeStepCount(scalarResultIndex)) continue;
+        if (std::find(results.begin(), results.end(), caseResults) != results.end()) continue;
+
+        results.push_back(caseResults);
+        scalarResultIndices.push_back(scalarResultIndex);
+    }
+
+    int caseCount = static_cast<int>(results.size());
+
+#pragma omp parallel for
+    for (int cIdx = 0; cIdx < caseCount; ++cIdx)
+    {
+        results[cIdx]->loadTimeStep(scalarResultIndices[cIdx], timeStepIndex);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::resetWriteState()
+{
+    m_casesToWrite.clear();
+    m_scalarIndicesToWrite.clear();
+    m_timeStepsToWrite.clear();
+    m_cellIndicesToWrite.clear();
+    m_valueCountToWrite = 0;
+    m_currentTimeStepToWrite = 0;
+    m_currentCaseToWrite = 0;
+    m_currentValueToWrite = 0;
+    m_readState = ReadingCommand;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Clients on this host can map the values directly instead of receiving them through the socket
+//--------------------------------------------------------------------------------------------------
+bool RiaSocketSession::isLocalClient() const
+{
+    QHostAddress peerAddress = m_socket->peerAddress();
+    return peerAddress == QHostAddress::LocalHost || peerAddress == QHostAddress::LocalHostIPv6;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Copy the requested values into one shared memory segment per timestep, named "<key>-<n>" for 
+/// the n'th requested timestep. With several cases, n counts the cases within each timestep, like
+/// on the socket. Returns the key, or an empty string if shared memory can not be used.
+/// Each segment is kept until the client acknowledges that it has read it, or the session ends.
+/// The values are copied one case and timestep at a time, and timesteps loaded only for the copy 
+/// are unloaded again, so the memory used is the segments and a single timestep
+//--------------------------------------------------------------------------------------------------
+QString RiaSocketSession::writePropertyDataToSharedMemory()
+{
+    releaseSharedMemory();
+
+    if (!isLocalClient()) return QString();
+
+    size_t valueByteCount = m_writeSinglePrecision ? sizeof(float) : sizeof(double);
+    size_t timeStepByteCount = m_valueCountToWrite * valueByteCount;
+
+    // QSharedMemory segments are limited to int size
+    if (timeStepByteCount == 0 || timeStepByteCount > static_cast<size_t>(std::numeric_limits<int>::max())) return QString();
+
+    QString key = QString("ResInsight-%1-%2").arg(QCoreApplication::applicationPid()).arg(++sharedMemoryKeyCounter);
+
+    for (size_t tIdx = 0; tIdx < m_timeStepsToWrite.size(); ++tIdx)
+    {
+        size_t timeStepIndex = m_timeStepsToWrite[tIdx];
+
+        for (size_t cIdx = 0; cIdx < m_casesToWrite.size(); ++cIdx)
+        {
+            size_t segmentIndex = tIdx * m_casesToWrite.size() + cIdx;
+            QSharedMemory* segment = new QSharedMemory(key + "-" + QString::number(segmentIndex), this);
+            m_sharedMemorySegments.push_back(segment);
+
+            if (!segment->create(static_cast<int>(timeStepByteCount)))
+            {
+                releaseSharedMemory();
+                return QString();
+            }
+
+            RigReservoirCellResults* results = m_casesToWrite[cIdx]->reservoirData()->mainGrid()->results(RifReaderInterface::MATRIX_RESULTS);
+            size_t scalarResultIndex = m_scalarIndicesToWrite[cIdx];
+
+            bool hasTimeStep = scalarResultIndex != cvf::UNDEFINED_SIZE_T && timeStepIndex < results->timeStepCount(scalarResultIndex);
+            bool isLoadedForCopy = hasTimeStep && !results->isTimeStepLoaded(scalarResultIndex, timeStepIndex);
+
+            if (m_writeSinglePrecision)
+            {
+                timeStepValues(results, scalarResultIndex, timeStepIndex, m_cellIndicesToWrite, 0, m_valueCountToWrite, static_cast<float*>(segment->data()));
+            }
+            else
+            {
+                timeStepValues(results, scalarResultIndex, timeStepIndex, m_cellIndicesToWrite, 0, m_valueCountToWrite, static_cast<double*>(segment->data()));
+            }
+
+            if (isLoadedForCopy)
+            {
+                results->unloadTimeStep(scalarResultIndex, timeStepIndex);
+            }
+        }
+    }
+
+    return key;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Copy the timesteps from the shared memory segments "<key>-<n>" created by the client
+//--------------------------------------------------------------------------------------------------
+bool RiaSocketSession::readPropertyDataFromSharedMemory(std::vector< std::vector<double> >* scalarResultsToAdd)
+{
+    for (; m_currentTimeStepToRead < m_timeStepCountToRead; ++m_currentTimeStepToRead)
+    {
+        QSharedMemory segment(m_sharedMemoryKeyToRead + "-" + QString::number(m_currentTimeStepToRead));
+
+        if (!segment.attach(QSharedMemory::ReadOnly) || segment.size() < (int)m_bytesPerTimeStepToRead)
+        {
+            m_server->showErrorMessage(tr("Could not read the data from shared memory: %1").arg(segment.errorString()));
+            return false;
+        }
+
+        scalarResultsToAdd->at(m_currentTimeStepToRead).resize(m_bytesPerTimeStepToRead / sizeof(double));
+        memcpy(scalarResultsToAdd->at(m_currentTimeStepToRead).data(), segment.constData(), m_bytesPerTimeStepToRead);
+        segment.detach();
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Read the indices of the shared memory segments the client is done with, and release them, so 
+/// the memory of a large transfer is returned while the client is still reading.
+/// Returns true when all the segments are released, and the next command can be read
+//--------------------------------------------------------------------------------------------------
+bool RiaSocketSession::readSharedMemoryAcksFromOctave()
+{
+    QDataStream socketStream(m_socket);
+    socketStream.setVersion(QDataStream::Qt_4_0);
+
+    while (m_sharedMemorySegmentsToAck > 0)
+    {
+        if (m_socket->bytesAvailable() < (int)sizeof(quint64)) return false;
+
+        quint64 segmentIndex = 0;
+        socketStream >> segmentIndex;
+
+        if (segmentIndex >= m_sharedMemorySegments.size() || !m_sharedMemorySegments[segmentIndex])
+        {
+            m_server->showErrorMessage(tr("Invalid shared memory segment released by the client: %1").arg(segmentIndex));
+            m_socket->abort();
+            return false;
+        }
+
+        delete m_sharedMemorySegments[segmentIndex];
+        m_sharedMemorySegments[segmentIndex] = NULL;
+        --m_sharedMemorySegmentsToAck;
+    }
+
+    releaseSharedMemory();
+    m_readState = ReadingCommand;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::releaseSharedMemory()
+{
+    for (size_t sIdx = 0; sIdx < m_sharedMemorySegments.size(); ++sIdx)
+    {
+        delete m_sharedMemorySegments[sIdx];
+    }
+
+    m_sharedMemorySegments.clear();
+    m_sharedMemorySegmentsToAck = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::slotBytesWritten()
+{
+    if (m_readState == WritingPropertyData)
+    {
+        writePropertyDataChunks();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/// 
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::slotDisconnected()
+{
+    if (m_timeStepCountToRead > 0
+        && m_currentTimeStepToRead < m_timeStepCountToRead
+        && m_socket->bytesAvailable()
+        && !m_invalidActiveCellCountDetected)
+    {
+        this->readPropertyDataFromOctave();
+    }
+
+    terminate();
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Stop handling the client, and delete the session and the socket when back in the event loop
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::terminate()
+{
+    m_isTerminated = true;
+
+    m_socket->disconnect(SIGNAL(disconnected()));
+    m_socket->disconnect(SIGNAL(readyRead()));
+    m_socket->disconnect(SIGNAL(bytesWritten(qint64)));
+
+    releaseSharedMemory();
+    m_currentReservoir = NULL;
+    if (m_progressDialog) m_progressDialog->deleteLater();
+
+    this->deleteLater();
+}
+
+//--------------------------------------------------------------------------------------------------
+///
+//--------------------------------------------------------------------------------------------------
+void RiaSocketSession::slotReadyRead()
+{
+    // The client may have sent several commands without waiting for the responses. 
+    // Handle everything that is complete
+
+    bool isProgressing = true;
+    while (isProgressing && !m_isTerminated)
+    {
+        switch (m_readState)
+        {
+            case ReadingCommand :
+            {
+                isProgressing = readCommandFromOctave();
+                break;
+            }
+
+            case ReadingPropertyData :
+            {
+                isProgressing = readPropertyDataFromOctave();
+                break;
+            }
+
+            case WritingPropertyData :
+            {
+                // Commands arriving while writing are read when all the data is written
+                isProgressing = false;
+                break;
+            }
+
+            case ReadingSharedMemoryAcks :
+            {
+                isProgressing = readSharedMemoryAcksFromOctave();
+                break;
+            }
+
+            default:
+                CVF_ASSERT(false);
+                isProgressing = false;
+                break;
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (C) 2011-2012 Statoil ASA, Ceetron AS
+// 
+//  ResInsight is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+// 
+//  ResInsight is distributed in the hope that it will be useful, but WITHOUT ANY
+//  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+//  FITNESS FOR A PARTICULAR PURPOSE.
+// 
+//  See the GNU General Public License at <http://www.gnu.org/licenses/gpl.html> 
+//  for more details.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+#include "cafPdmPointer.h"
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include <QPointer>
+
+#include <vector>
+
+class QTcpSocket;
+class QSharedMemory;
+class QProgressDialog;
+class RiaSocketServer;
+class RimReservoir;
+
+
+//==================================================================================================
+///
+/// One client connection to the socket server. Each session has its own command and read state,
+/// so several Octave clients can be served at the same time from the event loop.
+/// A connection can be kept open for many commands, which are executed in the order received.
+/// The session deletes itself when the client disconnects.
+///
+//==================================================================================================
+class RiaSocketSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ReadState {ReadingCommand, ReadingPropertyData, WritingPropertyData, ReadingSharedMemoryAcks};
+
+public:
+    RiaSocketSession(QTcpSocket* socket, RiaSocketServer* server);
+    ~RiaSocketSession();
+
+private slots:
+    void            slotReadyRead();
+    void            slotDisconnected();
+    void            slotBytesWritten();
+    void            slotCancelPropertyDataRead();
+
+private:
+    bool            readCommandFromOctave();
+    bool            readPropertyDataFromOctave();
+    void            finishPropertyDataRead(quint64 timeStepsStored);
+    void            propertyDataChanged(RimReservoir* reservoir, size_t scalarResultIndex, const QString& propertyName);
+    void            discardBytes(qint64 byteCount);
+    void            writeRequestId();
+    bool            startMultiCasePropertyDataStream(const std::vector<RimReservoir*>& reservoirs, const QString& propertyName, const QList<QByteArray>& options);
+    bool            startPropertyDataStream(const std::vector<RimReservoir*>& reservoirs, const std::vector<size_t>& scalarResultIndices, 
+                                            const QList<QByteArray>& options, bool writeCaseCount);
+    void            writePropertyDataChunks();
+    bool            areCasesToWriteLoaded() const;
+    void            loadTimeStepOfCasesToWrite(size_t timeStepIndex);
+    void            resetWriteState();
+
+    bool            isLocalClient() const;
+    QString         writePropertyDataToSharedMemory();
+    bool            readPropertyDataFromSharedMemory(std::vector< std::vector<double> >* scalarResultsToAdd);
+    bool            readSharedMemoryAcksFromOctave();
+    void            releaseSharedMemory();
+
+    void            terminate();
+
+private:
+    RiaSocketServer*    m_server;
+    QTcpSocket*         m_socket;
+    qint64              m_currentCommandSize; ///< The size in bytes of the command we are currently reading.
+    size_t              m_currentRequestId;   ///< Id given by the client to match the response with the command. UNDEFINED_SIZE_T if not given
+    bool                m_isTerminated;
+
+    // Vars used for reading data from octave and adding them to the available results
+    ReadState           m_readState;
+    quint64             m_timeStepCountToRead;
+    quint64             m_bytesPerTimeStepToRead;
+    size_t              m_currentTimeStepToRead;
+    quint64             m_bytesReadInTimeStep;
+    bool                m_isPropertyDataReadCancelled;
+    std::vector< std::vector<double> > m_scalarResultsToRead; ///< The data is stored in the result when all of it is read
+    QPointer<QProgressDialog>       m_progressDialog;
+    caf::PdmPointer<RimReservoir>   m_currentReservoir;
+    size_t              m_currentScalarIndex;
+    QString             m_currentPropertyName;
+    bool                m_invalidActiveCellCountDetected;
+
+    // Vars used for writing property data to octave in chunks
+    std::vector< caf::PdmPointer<RimReservoir> > m_casesToWrite;
+    std::vector<size_t> m_scalarIndicesToWrite;   ///< The result in each of the cases. UNDEFINED_SIZE_T if not found
+    std::vector<size_t> m_timeStepsToWrite;
+    std::vector<size_t> m_cellIndicesToWrite;     ///< Active cell indices of the values to write. Empty means all
+    size_t              m_valueCountToWrite;      ///< Number of values in each timestep
+    size_t              m_currentTimeStepToWrite; ///< Index into m_timeStepsToWrite
+    size_t              m_currentCaseToWrite;     ///< Index into m_casesToWrite
+    size_t              m_currentValueToWrite;
+    bool                m_writeSinglePrecision;
+
+    // Vars used for transferring property data through shared memory with clients on this host
+    QString             m_sharedMemoryKeyToRead;
+    std::vector<QSharedMemory*> m_sharedMemorySegments;   ///< Segments written to the client. NULL when released
+    size_t              m_sharedMemorySegmentsToAck;      ///< Number of segments the client has not released yet
+};
@@ -631,7 +631,7 @@ void RIMainWindow::slotOpenBinaryGridFiles()
 
             if (!fileNames.isEmpty())
             {
-                app->openEclipseCaseFromFile(fileName);
+                app->openEclipseCaseInBackground(fileName);
             }
         }
     }
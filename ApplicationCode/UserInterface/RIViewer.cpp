@@ -286,7 +286,7 @@ void RIViewer::handlePickAction(int winPosX, int winPosY)
                     const RigReservoir* reservoir = m_reservoirView->eclipseCase()->reservoirData();
                     const RigGridBase* grid = reservoir->grid(gridIndex);
                     const RigCell& cell = grid->cell(cellIndex);
-                    const caf::SizeTArray8& cellNodeIndices = cell.cornerIndices();
+                    const caf::UIntArray8& cellNodeIndices = cell.cornerIndices();
                     const std::vector<cvf::Vec3d>& nodes = reservoir->mainGrid()->nodes();
                     for (int i = 0; i < 8; ++i)
                     {
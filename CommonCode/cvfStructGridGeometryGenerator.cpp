@@ -30,7 +30,10 @@
 
 #include "cvfArray.h"
 #include "cvfOutlineEdgeExtractor.h"
+#include "cvfVertexWelder.h"
+#include "cvfBoundingBox.h"
 #include <cmath>
+#include <algorithm>
 
 
 namespace cvf {
@@ -147,6 +150,34 @@ CellRangeFilter::CellStateType CellRangeFilter::combine(CellRangeFilter::CellSta
 
 
 
+//==================================================================================================
+///
+/// \class CellFaceVisibilityFilter
+///
+//==================================================================================================
+
+//--------------------------------------------------------------------------------------------------
+/// Returns the visible faces of the cell as a bit mask, where bit n is set when face n is visible.
+/// Override to find all the faces in one go instead of testing each face with isFaceVisible()
+//--------------------------------------------------------------------------------------------------
+ubyte CellFaceVisibilityFilter::visibleFaceMask(size_t i, size_t j, size_t k, const UByteArray* cellVisibility) const
+{
+    ubyte faceMask = 0;
+
+    int face;
+    for (face = 0; face < 6; face++)
+    {
+        if (isFaceVisible(i, j, k, static_cast<StructGridInterface::FaceType>(face), cellVisibility))
+        {
+            faceMask |= static_cast<ubyte>(1 << face);
+        }
+    }
+
+    return faceMask;
+}
+
+
+
 
 
 //==================================================================================================
@@ -182,33 +213,49 @@ StructGridGeometryGenerator::~StructGridGeometryGenerator()
 //--------------------------------------------------------------------------------------------------
 ref<DrawableGeo> StructGridGeometryGenerator::generateSurface()
 {
+    ref<DrawableGeo> geo = new DrawableGeo;
+    if (!generateSurface(geo.p())) return NULL;
+
+    return geo;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Generate the surface from the specified region into the given drawable geo, making it possible
+/// to use a specialized DrawableGeo. Returns false if there are no visible faces
+//--------------------------------------------------------------------------------------------------
+bool StructGridGeometryGenerator::generateSurface(DrawableGeo* geo)
+{
+    CVF_ASSERT(geo);
+
     computeArrays();
 
     CVF_ASSERT(m_vertices.notNull());
 
-    if (m_vertices->size() == 0) return NULL;
+    if (m_vertices->size() == 0) return false;
 
-    ref<DrawableGeo> geo = new DrawableGeo;
     geo->setFromQuadVertexArray(m_vertices.p());
 
-    return geo;
+    return true;
 }
 
 
 
 //--------------------------------------------------------------------------------------------------
 /// Generates simplified mesh as line drawing
+/// The mesh has its own vertex array where coincident quad corners are shared, and each edge is 
+/// drawn only once even if it is shared by several quads
 /// Must call generateSurface first 
 //--------------------------------------------------------------------------------------------------
 ref<DrawableGeo> StructGridGeometryGenerator::createMeshDrawable()
 {
-   
     if (!(m_vertices.notNull() && m_vertices->size() != 0)) return NULL;
 
+    computeMeshArrays();
+
     ref<DrawableGeo> geo = new DrawableGeo;
-    geo->setVertexArray(m_vertices.p());
+    geo->setVertexArray(m_meshVertices.p());
     
-    ref<UIntArray> indices = lineIndicesFromQuadVertexArray(m_vertices.p());
+    ref<UIntArray> indices = uniqueLineIndicesFromQuadIndices(m_meshQuadIndices.p());
     ref<PrimitiveSetIndexedUInt> prim = new PrimitiveSetIndexedUInt(PT_LINES);
     prim->setIndices(indices.p());
 
@@ -225,10 +272,11 @@ ref<DrawableGeo> StructGridGeometryGenerator::createOutlineMeshDrawable(double c
 {
     if (!(m_vertices.notNull() && m_vertices->size() != 0)) return NULL;
 
-    cvf::OutlineEdgeExtractor ee(creaseAngle, *m_vertices);
+    // The edge extractor finds neighbour quads through shared vertex indices
+    computeMeshArrays();
 
-    ref<UIntArray> indices = lineIndicesFromQuadVertexArray(m_vertices.p());
-    ee.addPrimitives(4, *indices);
+    cvf::OutlineEdgeExtractor ee(creaseAngle, *m_meshVertices);
+    ee.addPrimitives(4, *m_meshQuadIndices);
 
     ref<cvf::UIntArray> lineIndices = ee.lineIndices();
     if (lineIndices->size() == 0)
@@ -240,7 +288,7 @@ ref<DrawableGeo> StructGridGeometryGenerator::createOutlineMeshDrawable(double c
     prim->setIndices(lineIndices.p());
 
     ref<DrawableGeo> geo = new DrawableGeo;
-    geo->setVertexArray(m_vertices.p());
+    geo->setVertexArray(m_meshVertices.p());
     geo->addPrimitiveSet(prim.p());
 
     return geo;
@@ -248,34 +296,104 @@ ref<DrawableGeo> StructGridGeometryGenerator::createOutlineMeshDrawable(double c
 
 
 //--------------------------------------------------------------------------------------------------
+/// Weld the quad corners for the mesh drawables. The welded arrays are shared by the mesh and the 
+/// outline mesh, and are computed again only after the quads have been regenerated
+//--------------------------------------------------------------------------------------------------
+void StructGridGeometryGenerator::computeMeshArrays()
+{
+    if (m_meshQuadIndices.notNull()) return;
+
+    m_meshQuadIndices = weldQuadVertices(m_vertices.p(), &m_meshVertices);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/// Merge coincident corners of the quads in \a quadVertexArray (4 vertices per quad)
 /// 
-/// 
-/// 
-/// 
+/// Returns 4 indices per quad into the vertex array returned in \a weldedVertexArray. Corners that 
+/// are separated by a fault are not coincident, and are kept apart
 //--------------------------------------------------------------------------------------------------
-ref<UIntArray> StructGridGeometryGenerator::lineIndicesFromQuadVertexArray(const Vec3fArray* vertexArray)
+ref<UIntArray> StructGridGeometryGenerator::weldQuadVertices(const Vec3fArray* quadVertexArray, ref<Vec3fArray>* weldedVertexArray)
 {
-    CVF_ASSERT(vertexArray);
+    CVF_ASSERT(quadVertexArray);
+    CVF_ASSERT(weldedVertexArray);
 
-    size_t numVertices = vertexArray->size();
-    int numQuads = static_cast<int>(numVertices/4);
+    size_t numVertices = quadVertexArray->size();
     CVF_ASSERT(numVertices%4 == 0);
 
-    ref<UIntArray> indices = new UIntArray;
-    indices->resize(numQuads*8);
+    BoundingBox bb;
+    bb.add(*quadVertexArray);
+
+    // Only corners that are equal to float precision are merged. Use the bounding box to guess 
+    // the cell size like DrawableGeo::weldVertices() does
+    double weldDistance = CVF_MAX(bb.radius()*1.0e-6, 1.0e-6);
+    double cellSize = CVF_MAX(bb.radius()/100, 3*weldDistance);
+
+    VertexWelder welder;
+    welder.initialize(weldDistance, cellSize, static_cast<uint>(numVertices));
+    welder.reserveVertices(static_cast<uint>(numVertices/4));
+
+    ref<UIntArray> quadIndices = new UIntArray;
+    quadIndices->resize(numVertices);
+
+    size_t i;
+    for (i = 0; i < numVertices; i++)
+    {
+        quadIndices->set(i, welder.weldVertex(quadVertexArray->get(i), NULL));
+    }
+
+    *weldedVertexArray = welder.createVertexArray();
+
+    return quadIndices;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/// Line indices for the edges of the quads given by \a quadIndices (4 indices per quad)
+/// 
+/// Edges shared by several quads are only included once, and collapsed edges are skipped
+//--------------------------------------------------------------------------------------------------
+ref<UIntArray> StructGridGeometryGenerator::uniqueLineIndicesFromQuadIndices(const UIntArray* quadIndices)
+{
+    CVF_ASSERT(quadIndices);
+
+    size_t numIndices = quadIndices->size();
+    int numQuads = static_cast<int>(numIndices/4);
+    CVF_ASSERT(numIndices%4 == 0);
+
+    // Each edge with the smallest vertex index first
+    std::vector<std::pair<uint, uint> > edgeKeys;
+    edgeKeys.resize(numQuads*4);
 
 #pragma omp parallel for
     for (int i = 0; i < numQuads; i++)
-    {        
-        int idx = 8*i;
-        indices->set(idx + 0, i*4 + 0);
-        indices->set(idx + 1, i*4 + 1);
-        indices->set(idx + 2, i*4 + 1);
-        indices->set(idx + 3, i*4 + 2);
-        indices->set(idx + 4, i*4 + 2);
-        indices->set(idx + 5, i*4 + 3);
-        indices->set(idx + 6, i*4 + 3);
-        indices->set(idx + 7, i*4 + 0);
+    {
+        int n;
+        for (n = 0; n < 4; n++)
+        {
+            uint v0 = quadIndices->get(i*4 + n);
+            uint v1 = quadIndices->get(i*4 + (n + 1)%4);
+            if (v0 > v1) std::swap(v0, v1);
+
+            edgeKeys[i*4 + n] = std::make_pair(v0, v1);
+        }
+    }
+
+    std::sort(edgeKeys.begin(), edgeKeys.end());
+    edgeKeys.erase(std::unique(edgeKeys.begin(), edgeKeys.end()), edgeKeys.end());
+
+    ref<UIntArray> indices = new UIntArray;
+    indices->reserve(edgeKeys.size()*2);
+
+    size_t e;
+    for (e = 0; e < edgeKeys.size(); e++)
+    {
+        uint v0 = edgeKeys[e].first;
+        uint v1 = edgeKeys[e].second;
+        if (v0 == v1) continue;
+
+        indices->add(v0);
+        indices->add(v1);
     }
 
     return indices;
@@ -287,6 +405,9 @@ ref<UIntArray> StructGridGeometryGenerator::lineIndicesFromQuadVertexArray(const
 void StructGridGeometryGenerator::addFaceVisibilityFilter(const CellFaceVisibilityFilter* cellVisibilityFilter)
 {
     m_cellVisibilityFilters.push_back(cellVisibilityFilter);
+
+    // The faces of all cells must be evaluated with the new filter
+    m_generatedCellVisibility = NULL;
 }
 
 
@@ -294,40 +415,129 @@ void StructGridGeometryGenerator::addFaceVisibilityFilter(const CellFaceVisibili
 //--------------------------------------------------------------------------------------------------
 /// 
 //--------------------------------------------------------------------------------------------------
-bool StructGridGeometryGenerator::isCellFaceVisible(size_t i, size_t j, size_t k, StructGridInterface::FaceType face) const
+ubyte StructGridGeometryGenerator::visibleCellFaces(size_t i, size_t j, size_t k) const
 {
+    ubyte faceMask = 0;
+
     size_t idx;
     for (idx = 0; idx < m_cellVisibilityFilters.size(); idx++)
     {
         const cvf::CellFaceVisibilityFilter* cellFilter = m_cellVisibilityFilters[idx];
-        if (cellFilter->isFaceVisible(i, j, k, face, m_cellVisibility.p()))
+        faceMask |= cellFilter->visibleFaceMask(i, j, k, m_cellVisibility.p());
+    }
+
+    return faceMask;
+}
+
+//--------------------------------------------------------------------------------------------------
+/// Find the K slabs that can keep their quads from the previous generation. The faces of a cell 
+/// depend on the visibility of the cell and its neighbours, so a slab is unchanged if no cell in 
+/// the slab or the slabs above and below changed visibility
+//--------------------------------------------------------------------------------------------------
+void StructGridGeometryGenerator::findUnchangedSlabs(std::vector<ubyte>* slabIsUnchanged) const
+{
+    CVF_ASSERT(slabIsUnchanged);
+
+    const size_t cellCountI = m_grid->cellCountI();
+    const size_t cellCountJ = m_grid->cellCountJ();
+    const int cellCountK = static_cast<int>(m_grid->cellCountK());
+
+    slabIsUnchanged->assign(cellCountK, 0);
+
+    // Changes can only be found when the visibility is replaced by a new array
+    if (m_vertices.isNull()) return;
+    if (m_cellVisibility.isNull() || m_generatedCellVisibility.isNull()) return;
+    if (m_cellVisibility.p() == m_generatedCellVisibility.p()) return;
+    if (m_cellVisibility->size() != m_generatedCellVisibility->size()) return;
+    if (m_slabQuadStarts.size() != static_cast<size_t>(cellCountK + 1)) return;
+
+    std::vector<ubyte> slabIsChanged(cellCountK, 0);
+
+#pragma omp parallel for
+    for (int k = 0; k < cellCountK; k++)
+    {
+        size_t j;
+        for (j = 0; j < cellCountJ && !slabIsChanged[k]; j++)
         {
-            return true;
+            size_t i;
+            for (i = 0; i < cellCountI; i++)
+            {
+                size_t cellIndex = m_grid->cellIndexFromIJK(i, j, k);
+                if ((*m_cellVisibility)[cellIndex] != (*m_generatedCellVisibility)[cellIndex])
+                {
+                    slabIsChanged[k] = 1;
+                    break;
+                }
+            }
         }
     }
 
-     return false;
+    int k;
+    for (k = 0; k < cellCountK; k++)
+    {
+        bool isChanged = slabIsChanged[k] 
+                         || (k > 0 && slabIsChanged[k - 1]) 
+                         || (k + 1 < cellCountK && slabIsChanged[k + 1]);
+
+        (*slabIsUnchanged)[k] = !isChanged;
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Compute the quads of the visible cell faces. When the cell visibility has been replaced by a new 
+/// array since the previous generation, only the K slabs affected by the changes are recomputed
 //--------------------------------------------------------------------------------------------------
 void StructGridGeometryGenerator::computeArrays()
 {
-    std::vector<Vec3f> vertices;
-    m_quadsToGridCells.clear();
-    m_quadsToFace.clear();
+    std::vector<ubyte> slabIsUnchanged;
+    findUnchangedSlabs(&slabIsUnchanged);
+
+    cvf::ref<cvf::Vec3fArray> prevVertices = m_vertices;
+    std::vector<size_t> prevQuadsToGridCells;
+    std::vector<StructGridInterface::FaceType> prevQuadsToFace;
+    std::vector<size_t> prevSlabQuadStarts;
+    prevQuadsToGridCells.swap(m_quadsToGridCells);
+    prevQuadsToFace.swap(m_quadsToFace);
+    prevSlabQuadStarts.swap(m_slabQuadStarts);
+
+    m_meshVertices = NULL;
+    m_meshQuadIndices = NULL;
 
     cvf::Vec3d offset = m_grid->displayModelOffset();
 
+    const StructGridInterface::FaceType faces[6] = 
+    {
+        StructGridInterface::NEG_I, StructGridInterface::POS_I,
+        StructGridInterface::NEG_J, StructGridInterface::POS_J,
+        StructGridInterface::NEG_K, StructGridInterface::POS_K
+    };
+
+    const size_t cellCountI = m_grid->cellCountI();
+    const size_t cellCountJ = m_grid->cellCountJ();
+    const int cellCountK = static_cast<int>(m_grid->cellCountK());
+    const size_t cellCountInSlab = cellCountI*cellCountJ;
+
+    // First pass: Find the visible faces of each cell as a bit mask, and count the visible faces in each K slab
+
+    std::vector<ubyte> visibleFaceMasks(cellCountInSlab*cellCountK, 0);
+    std::vector<size_t> slabQuadCounts(cellCountK, 0);
+
 #pragma omp parallel for schedule(dynamic)
-    for (int k = 0; k < static_cast<int>(m_grid->cellCountK()); k++)
+    for (int k = 0; k < cellCountK; k++)
     {
+        if (slabIsUnchanged[k])
+        {
+            slabQuadCounts[k] = prevSlabQuadStarts[k + 1] - prevSlabQuadStarts[k];
+            continue;
+        }
+
+        size_t slabQuadCount = 0;
+
         size_t j;
-        for (j = 0; j < m_grid->cellCountJ(); j++)
+        for (j = 0; j < cellCountJ; j++)
         {
             size_t i;
-            for (i = 0; i < m_grid->cellCountI(); i++)
+            for (i = 0; i < cellCountI; i++)
             {
                 size_t cellIndex = m_grid->cellIndexFromIJK(i, j, k);
                 if (m_cellVisibility.notNull() && !(*m_cellVisibility)[cellIndex])
@@ -335,52 +545,109 @@ void StructGridGeometryGenerator::computeArrays()
                     continue;
                 }
 
-                std::vector<StructGridInterface::FaceType> visibleFaces;
-                visibleFaces.reserve(6);
+                ubyte faceMask = visibleCellFaces(i, j, k);
+                if (!faceMask) continue;
 
-                if (isCellFaceVisible(i, j, k, StructGridInterface::NEG_I)) visibleFaces.push_back(cvf::StructGridInterface::NEG_I);
-                if (isCellFaceVisible(i, j, k, StructGridInterface::POS_I)) visibleFaces.push_back(cvf::StructGridInterface::POS_I);
-                if (isCellFaceVisible(i, j, k, StructGridInterface::NEG_J)) visibleFaces.push_back(cvf::StructGridInterface::NEG_J);
-                if (isCellFaceVisible(i, j, k, StructGridInterface::POS_J)) visibleFaces.push_back(cvf::StructGridInterface::POS_J);
-                if (isCellFaceVisible(i, j, k, StructGridInterface::NEG_K)) visibleFaces.push_back(cvf::StructGridInterface::NEG_K);
-                if (isCellFaceVisible(i, j, k, StructGridInterface::POS_K)) visibleFaces.push_back(cvf::StructGridInterface::POS_K);
+                int fIdx;
+                for (fIdx = 0; fIdx < 6; fIdx++)
+                {
+                    if (faceMask & (1 << fIdx)) slabQuadCount++;
+                }
 
-                if (visibleFaces.size() > 0)
+                visibleFaceMasks[k*cellCountInSlab + j*cellCountI + i] = faceMask;
+            }
+        }
+
+        slabQuadCounts[k] = slabQuadCount;
+    }
+
+    // The quads of each slab start where the quads of the previous slab end
+
+    std::vector<size_t> slabQuadStarts(cellCountK + 1, 0);
+    int k;
+    for (k = 0; k < cellCountK; k++)
+    {
+        slabQuadStarts[k + 1] = slabQuadStarts[k] + slabQuadCounts[k];
+    }
+
+    size_t quadCount = slabQuadStarts[cellCountK];
+
+    m_vertices = new cvf::Vec3fArray;
+    m_vertices->resize(quadCount*4);
+    m_quadsToGridCells.resize(quadCount);
+    m_quadsToFace.resize(quadCount);
+
+    // Second pass: Each slab fills its own part of the arrays. 
+    // The quads are ordered as if the grid was traversed sequentially, independent of the thread count
+
+#pragma omp parallel for schedule(dynamic)
+    for (k = 0; k < cellCountK; k++)
+    {
+        size_t quadIdx = slabQuadStarts[k];
+
+        if (slabIsUnchanged[k])
+        {
+            size_t prevQuadIdx;
+            for (prevQuadIdx = prevSlabQuadStarts[k]; prevQuadIdx < prevSlabQuadStarts[k + 1]; prevQuadIdx++)
+            {
+                int n;
+                for (n = 0; n < 4; n++)
                 {
-                    size_t cellIndex = m_grid->cellIndexFromIJK(i, j, k);
+                    m_vertices->set(quadIdx*4 + n, prevVertices->get(prevQuadIdx*4 + n));
+                }
 
-                    cvf::Vec3d cornerVerts[8];
-                    m_grid->cellCornerVertices(cellIndex, cornerVerts);
+                m_quadsToGridCells[quadIdx] = prevQuadsToGridCells[prevQuadIdx];
+                m_quadsToFace[quadIdx] = prevQuadsToFace[prevQuadIdx];
+
+                quadIdx++;
+            }
 
-                    size_t idx;
-                    for (idx = 0; idx < visibleFaces.size(); idx++)
+            CVF_ASSERT(quadIdx == slabQuadStarts[k + 1]);
+            continue;
+        }
+
+        size_t j;
+        for (j = 0; j < cellCountJ; j++)
+        {
+            size_t i;
+            for (i = 0; i < cellCountI; i++)
+            {
+                ubyte faceMask = visibleFaceMasks[k*cellCountInSlab + j*cellCountI + i];
+                if (!faceMask) continue;
+
+                size_t cellIndex = m_grid->cellIndexFromIJK(i, j, k);
+
+                cvf::Vec3d cornerVerts[8];
+                m_grid->cellCornerVertices(cellIndex, cornerVerts);
+
+                int fIdx;
+                for (fIdx = 0; fIdx < 6; fIdx++)
+                {
+                    if (!(faceMask & (1 << faces[fIdx]))) continue;
+
+                    ubyte faceConn[4];
+                    m_grid->cellFaceVertexIndices(faces[fIdx], faceConn);
+
+                    int n;
+                    for (n = 0; n < 4; n++)
                     {
-                        cvf::StructGridInterface::FaceType face = visibleFaces[idx];
-
-                        ubyte faceConn[4];
-                        m_grid->cellFaceVertexIndices(face, faceConn);
-
-                        // Critical section to avoid two threads accessing the arrays at the same time.
-                        #pragma omp critical
-                        {
-                            int n;
-                            for (n = 0; n < 4; n++)
-                            {
-                                vertices.push_back(cvf::Vec3f(cornerVerts[faceConn[n]] - offset));
-                            }
-
-                            // Keep track of the source cell index per quad
-                            m_quadsToGridCells.push_back(cellIndex);
-                            m_quadsToFace.push_back(face);
-                        }
+                        m_vertices->set(quadIdx*4 + n, cvf::Vec3f(cornerVerts[faceConn[n]] - offset));
                     }
+
+                    // Keep track of the source cell index per quad
+                    m_quadsToGridCells[quadIdx] = cellIndex;
+                    m_quadsToFace[quadIdx] = faces[fIdx];
+
+                    quadIdx++;
                 }
             }
         }
+
+        CVF_ASSERT(quadIdx == slabQuadStarts[k + 1]);
     }
 
-    m_vertices = new cvf::Vec3fArray;
-    m_vertices->assign(vertices);
+    m_slabQuadStarts.swap(slabQuadStarts);
+    m_generatedCellVisibility = m_cellVisibility;
 }
 
 
@@ -436,7 +703,8 @@ ref<cvf::Array<size_t> > StructGridGeometryGenerator::triangleToSourceGridCellMa
 
 
 //--------------------------------------------------------------------------------------------------
-/// 
+/// Set a new array, rather than modifying the current one, to regenerate only the K slabs where 
+/// the visibility changed
 //--------------------------------------------------------------------------------------------------
 void StructGridGeometryGenerator::setCellVisibility(const UByteArray* cellVisibility)
 {
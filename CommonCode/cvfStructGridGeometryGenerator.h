@@ -105,6 +105,7 @@ class CellFaceVisibilityFilter
 {
 public:
     virtual bool isFaceVisible(size_t i, size_t j, size_t k, StructGridInterface::FaceType face, const UByteArray* cellVisibility) const = 0;
+    virtual ubyte visibleFaceMask(size_t i, size_t j, size_t k, const UByteArray* cellVisibility) const;
 };
 
 
@@ -142,15 +143,20 @@ public:
 
     // Generated geometry
     ref<DrawableGeo>    generateSurface();
+    bool                generateSurface(DrawableGeo* geo);
     ref<DrawableGeo>    createMeshDrawable();
     ref<DrawableGeo>    createOutlineMeshDrawable(double creaseAngle);
 
 private:
     static ref<UIntArray> 
-                        lineIndicesFromQuadVertexArray(const Vec3fArray* vertexArray);
-    bool                isCellFaceVisible(size_t i, size_t j, size_t k, StructGridInterface::FaceType face) const;
+                        weldQuadVertices(const Vec3fArray* quadVertexArray, ref<Vec3fArray>* weldedVertexArray);
+    static ref<UIntArray> 
+                        uniqueLineIndicesFromQuadIndices(const UIntArray* quadIndices);
+    ubyte               visibleCellFaces(size_t i, size_t j, size_t k) const;
+    void                findUnchangedSlabs(std::vector<ubyte>* slabIsUnchanged) const;
     
     void                computeArrays();
+    void                computeMeshArrays();
 
 private:
     // Input
@@ -160,11 +166,16 @@ private:
 
     // Created arrays
     cvf::ref<cvf::Vec3fArray>                    m_vertices;
+    cvf::ref<cvf::Vec3fArray>                    m_meshVertices;             // Welded quad corners used by the mesh drawables
+    cvf::ref<cvf::UIntArray>                     m_meshQuadIndices;          // 4 indices into m_meshVertices per quad
     // Mappings
     std::vector<size_t>                          m_triangleIndexToGridCellIndex;
     std::vector<size_t>                          m_quadsToGridCells;
     std::vector<StructGridInterface::FaceType>   m_quadsToFace;
-    
+
+    // State of the previous generation, used to regenerate only the K slabs affected by visibility changes
+    cref<UByteArray>                             m_generatedCellVisibility;
+    std::vector<size_t>                          m_slabQuadStarts;
 };
 
 }
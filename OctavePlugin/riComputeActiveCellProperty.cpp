@@ -0,0 +1,129 @@
+#include <QtNetwork>
+#include <octave/oct.h>
+
+
+quint64 computeEclipseProperty(const QString &hostName, quint16 port, const QString& caseName, const QString& propertyName, const QString& expression)
+{
+    QString serverName = hostName;
+    quint16 serverPort = port;
+
+    const int Timeout = 5 * 1000;
+
+    QTcpSocket socket;
+    socket.connectToHost(serverName, serverPort);
+
+    if (!socket.waitForConnected(Timeout))
+    {
+        error((("Connection: ") + socket.errorString()).toLatin1().data());
+        return 0;
+    }
+
+    // Create command and send it. The expression follows a free standing "=", and can contain spaces
+
+    QString command("ComputeProperty ");
+    command += caseName + " " + propertyName + " = " + expression;
+    QByteArray cmdBytes = command.toLatin1();
+
+    QDataStream socketStream(&socket);
+    socketStream.setVersion(QDataStream::Qt_4_0);
+
+    socketStream << (qint64)(cmdBytes.size());
+    socket.write(cmdBytes);
+
+    // Get response: The number of timesteps computed
+
+    while (socket.bytesAvailable() < (int)(sizeof(quint64)))
+    {
+        if (!socket.waitForReadyRead(Timeout))
+        {
+            error((("Waiting for response: ") + socket.errorString()).toLatin1().data());
+            return 0;
+        }
+    }
+
+    quint64 timeStepCount;
+    socketStream >> timeStepCount;
+
+    QString tmp = QString("riComputeActiveCellProperty : ");
+    if (timeStepCount == 0)
+    {
+        tmp += QString("Could not compute %1. See the ResInsight error message.").arg(propertyName);
+    }
+    else
+    {
+        tmp += QString("Computed %1 timesteps of %2").arg(timeStepCount).arg(propertyName);
+        if (caseName.isEmpty())
+        {
+            tmp += QString(" in active case.");
+        }
+        else
+        {
+            tmp += QString(" in %1.").arg(caseName);
+        }
+    }
+    octave_stdout << tmp.toStdString() << std::endl;
+
+    return timeStepCount;
+}
+
+
+
+DEFUN_DLD (riComputeActiveCellProperty, args, nargout,
+           "Usage:\n"
+           "\n"
+           "\triComputeActiveCellProperty( [CaseName/CaseIndex], PropertyName, Expression )\n"
+           "\n"
+           "Computes a \"Generated\" property with the name \"PropertyName\" in ResInsight from an\n"
+           "expression of the other properties of the case, like \"SOIL*PORV\" or \"SOIL[1] - SOIL\".\n"
+           "No property data is transferred to Octave. The property is added to the active case if\n"
+           "no case specification is given, or to the Eclipse Case named \"CaseName\" or to the case\n"
+           "number \"CaseIndex\". Returns the number of timesteps computed."
+           )
+{
+    int nargin = args.length ();
+    if (nargin < 2)
+    {
+        error("riComputeActiveCellProperty: Too few arguments. The name of the property and the expression is neccesary\n");
+        print_usage();
+    }
+    else if (nargin > 3)
+    {
+        error("riComputeActiveCellProperty: Too many arguments.\n");
+        print_usage();
+    }
+    else
+    {
+        charMatrix caseName;
+        charMatrix propertyName;
+        charMatrix expression;
+
+        if (nargin > 2)
+        {
+            caseName = args(0).char_matrix_value();
+            propertyName = args(1).char_matrix_value();
+            expression = args(2).char_matrix_value();
+        }
+        else
+        {
+            propertyName = args(0).char_matrix_value();
+            expression = args(1).char_matrix_value();
+        }
+
+        if (error_state)
+        {
+            error("riComputeActiveCellProperty: The supplied Case / Property names or the expression are invalid");
+            return octave_value_list ();
+        }
+
+        quint64 timeStepCount = 0;
+        if (nargin > 2)
+            timeStepCount = computeEclipseProperty("127.0.0.1", 40001, caseName.row_as_string(0).c_str(), propertyName.row_as_string(0).c_str(), expression.row_as_string(0).c_str());
+        else
+            timeStepCount = computeEclipseProperty("127.0.0.1", 40001, "", propertyName.row_as_string(0).c_str(), expression.row_as_string(0).c_str());
+
+        return octave_value(static_cast<double>(timeStepCount));
+    }
+
+    return octave_value_list ();
+}
+
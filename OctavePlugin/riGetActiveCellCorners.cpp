@@ -0,0 +1,145 @@
+#include <QtNetwork>
+#include <octave/oct.h>
+
+
+void getActiveCellGeometry(NDArray& coordinates, const QString& command, size_t cornerCount, const QString &hostName, quint16 port, QString caseName)
+{
+    QString serverName = hostName;
+    quint16 serverPort = port;
+
+    const int Timeout = 5 * 1000;
+
+    QTcpSocket socket;
+    socket.connectToHost(serverName, serverPort);
+
+    if (!socket.waitForConnected(Timeout))
+    {
+        error((("Connection: ") + socket.errorString()).toLatin1().data());
+        return;
+    }
+
+    // Create command and send it:
+
+    QString fullCommand = command + " " + caseName;
+    QByteArray cmdBytes = fullCommand.toLatin1();
+
+    QDataStream socketStream(&socket);
+    socketStream.setVersion(QDataStream::Qt_4_0);
+
+    socketStream << (qint64)(cmdBytes.size());
+    socket.write(cmdBytes);
+
+    // Get response. First wait for the header
+
+    while (socket.bytesAvailable() < (int)(2*sizeof(quint64)))
+    {
+        if (!socket.waitForReadyRead(Timeout))
+        {
+            error((("Wating for header: ") + socket.errorString()).toLatin1().data());
+            return;
+        }
+    }
+
+    // Read column count and the byte size of each column
+
+    quint64 columnCount;
+    quint64 byteCount;
+
+    socketStream >> columnCount;
+    socketStream >> byteCount;
+
+    size_t activeCellCount = byteCount / sizeof(double);
+
+    if (!(byteCount && columnCount) || columnCount != 3*cornerCount)
+    {
+        error ("Could not find the requested data in ResInsight");
+        return;
+    }
+
+    // The columns are X, then Y, then Z. For the corners, each of them is split in one column per corner
+
+    if (cornerCount == 1)
+    {
+        dim_vector dv (2, 1);
+        dv(0) = activeCellCount;
+        dv(1) = 3;
+        coordinates.resize(dv);
+    }
+    else
+    {
+        dim_vector dv (3, 1);
+        dv(0) = activeCellCount;
+        dv(1) = cornerCount;
+        dv(2) = 3;
+        coordinates.resize(dv);
+    }
+
+    double* internalMatrixData = coordinates.fortran_vec();
+
+    for (size_t colIdx = 0; colIdx < columnCount; ++colIdx)
+    {
+        while (socket.bytesAvailable() < (int)byteCount)
+        {
+            if (!socket.waitForReadyRead(Timeout))
+            {
+                error((("Waiting for column number: ") + QString::number(colIdx) + " : " + socket.errorString()).toLatin1().data());
+                octave_stdout << "Active cells: " << activeCellCount << ", Columns: " << columnCount << std::endl;
+                return ;
+            }
+           OCTAVE_QUIT;
+        }
+
+        qint64 bytesRead = socket.read((char*)(internalMatrixData + colIdx * activeCellCount), byteCount);
+
+        if ((int)byteCount != bytesRead)
+        {
+            error("Could not read binary double data properly from socket");
+            octave_stdout << "Active cells: " << activeCellCount << ", Columns: " << columnCount << std::endl;
+        }
+
+        OCTAVE_QUIT;
+    }
+
+    return;
+}
+
+
+
+DEFUN_DLD (riGetActiveCellCorners, args, nargout,
+           "Usage:\n"
+           "\n"
+           "   riGetActiveCellCorners( [CaseName/CaseIndex])\n"
+           "\n"
+           "Returns a three dimentional matrix: [ActiveCells][8][3]\n"
+           "Containing the X, Y, Z coordinates of the 8 corners of each active cell in the Eclipse Case defined.\n"
+           "The rows are in the same order as the rows of riGetActiveCellInfo and riGetActiveCellProperty.\n"
+           "Z is the elevation, negative below sea level.\n"
+           "If the Eclipse Case is not defined, the active View in ResInsight is used."
+           )
+{
+    int nargin = args.length ();
+    if (nargin > 1)
+    {
+        error("riGetActiveCellCorners: Too many arguments. Only the name or index of the case is valid input.\n");
+        print_usage();
+    }
+    else if (nargout < 1)
+    {
+        error("riGetActiveCellCorners: Missing output argument.\n");
+        print_usage();
+    }
+    else
+    {
+        NDArray cellCorners;
+
+        if (nargin > 0)
+            getActiveCellGeometry(cellCorners, "GetActiveCellCorners", 8, "127.0.0.1", 40001, args(0).char_matrix_value().row_as_string(0).c_str());
+        else
+            getActiveCellGeometry(cellCorners, "GetActiveCellCorners", 8, "127.0.0.1", 40001, "");
+
+        return octave_value(cellCorners);
+    }
+
+    return octave_value_list ();
+}
+
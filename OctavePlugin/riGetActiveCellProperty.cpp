@@ -2,7 +2,7 @@
 #include <octave/oct.h>
 
 
-void getEclipseProperty(Matrix& propertyFrames, const QString &hostName, quint16 port, QString caseName, QString propertyName)
+void getEclipseProperty(Matrix& propertyFrames, const QString &hostName, quint16 port, QString caseName, QString propertyName, const int32NDArray& requestedTimeSteps)
 {
     QString serverName = hostName;
     quint16 serverPort = port;
@@ -22,6 +22,21 @@ void getEclipseProperty(Matrix& propertyFrames, const QString &hostName, quint16
 
     QString command("GetProperty ");
     command += caseName + " " + propertyName;
+
+    // Only the requested timesteps are read and sent by ResInsight. Octave indices are 1-based
+    if (requestedTimeSteps.length())
+    {
+        command += " TimeSteps=";
+        for (int i = 0; i < requestedTimeSteps.length(); ++i)
+        {
+            if (i > 0) command += ",";
+            command += QString::number(requestedTimeSteps(i).value() - 1);
+        }
+    }
+
+    // ResInsight runs on this host, so ask for the data through shared memory
+    command += " Transport=SharedMemory";
+
     QByteArray cmdBytes = command.toLatin1();
 
     QDataStream socketStream(&socket);
@@ -59,8 +74,60 @@ void getEclipseProperty(Matrix& propertyFrames, const QString &hostName, quint16
         return;
     }
 
+    // Read the shared memory key. If it is empty, the data is sent on the socket
+
+    while (socket.bytesAvailable() < (int)sizeof(quint64))
+    {
+        if (!socket.waitForReadyRead(Timeout))
+        {
+            error((("Waiting for shared memory key: ") + socket.errorString()).toLatin1().data());
+            return;
+        }
+    }
+
+    quint64 keyByteCount;
+    socketStream >> keyByteCount;
+
+    while (socket.bytesAvailable() < (int)keyByteCount)
+    {
+        if (!socket.waitForReadyRead(Timeout))
+        {
+            error((("Waiting for shared memory key: ") + socket.errorString()).toLatin1().data());
+            return;
+        }
+    }
+
+    QString sharedMemoryKey = QString::fromLatin1(socket.read(keyByteCount));
+
+    // Copy each timestep from its shared memory segment, and tell ResInsight to release it
+    for (size_t tIdx = 0; !sharedMemoryKey.isEmpty() && tIdx < timestepCount; ++tIdx)
+    {
+        QSharedMemory segment(sharedMemoryKey + "-" + QString::number(tIdx));
+
+        if (!segment.attach(QSharedMemory::ReadOnly) || segment.size() < (int)byteCount)
+        {
+            error((("Reading shared memory: ") + segment.errorString()).toLatin1().data());
+            return;
+        }
+
+        double * internalMatrixData = propertyFrames.fortran_vec();
+        memcpy(internalMatrixData + tIdx * activeCellCount, segment.constData(), byteCount);
+
+        segment.detach();
+
+        socketStream << (quint64)tIdx;
+        socket.flush();
+
+        OCTAVE_QUIT;
+    }
+
+    while (socket.bytesToWrite() && socket.waitForBytesWritten(Timeout))
+    {
+        OCTAVE_QUIT;
+    }
+
     // Wait for available data for each timestep, then read data for each timestep
-    for (size_t tIdx = 0; tIdx < timestepCount; ++tIdx)
+    for (size_t tIdx = 0; sharedMemoryKey.isEmpty() && tIdx < timestepCount; ++tIdx)
     {
         while (socket.bytesAvailable() < (int)byteCount)
         {
@@ -116,11 +183,12 @@ void getEclipseProperty(Matrix& propertyFrames, const QString &hostName, quint16
 DEFUN_DLD (riGetActiveCellProperty, args, nargout,
            "Usage:\n"
            "\n"
-           "   riGetActiveCellProperty( [CaseName/CaseIndex], PropertyName )\n"
+           "   riGetActiveCellProperty( [CaseName/CaseIndex], PropertyName, [RequestedTimeSteps] )\n"
            "\n"
            "Returns a two dimentional matrix: [ActiveCells][Timesteps]\n"
            "Containing the requested property data from the Eclipse Case defined.\n"
-           "If the Eclipse Case is not defined, the active View in ResInsight is used."
+           "If the Eclipse Case is not defined, the active View in ResInsight is used.\n"
+           "RequestedTimeSteps is a vector of 1-based timestep indices. All timesteps are returned if it is omitted."
            )
 {
     int nargin = args.length ();
@@ -138,10 +206,21 @@ DEFUN_DLD (riGetActiveCellProperty, args, nargout,
     {
         Matrix propertyFrames;
 
-        if (nargin > 1)
-            getEclipseProperty(propertyFrames, "127.0.0.1", 40001, args(0).char_matrix_value().row_as_string(0).c_str(), args(1).char_matrix_value().row_as_string(0).c_str());
-        else
-            getEclipseProperty(propertyFrames, "127.0.0.1", 40001, "", args(0).char_matrix_value().row_as_string(0).c_str());
+        // The case is given if the second argument is the property name
+        bool hasCaseName = nargin > 1 && args(1).is_string();
+        int propertyArgIndex = hasCaseName ? 1 : 0;
+
+        QString caseName;
+        if (hasCaseName) caseName = args(0).char_matrix_value().row_as_string(0).c_str();
+        QString propertyName = args(propertyArgIndex).char_matrix_value().row_as_string(0).c_str();
+
+        int32NDArray requestedTimeSteps;
+        if (nargin > propertyArgIndex + 1)
+        {
+            requestedTimeSteps = args(propertyArgIndex + 1).int32_array_value();
+        }
+
+        getEclipseProperty(propertyFrames, "127.0.0.1", 40001, caseName, propertyName, requestedTimeSteps);
 
         return octave_value(propertyFrames);
     }
@@ -0,0 +1,137 @@
+#include <QtNetwork>
+#include <octave/oct.h>
+
+
+void getGridDimensions(int32NDArray& gridDimensions, const QString &hostName, quint16 port, QString caseName)
+{
+    QString serverName = hostName;
+    quint16 serverPort = port;
+
+    const int Timeout = 5 * 1000;
+
+    QTcpSocket socket;
+    socket.connectToHost(serverName, serverPort);
+
+    if (!socket.waitForConnected(Timeout))
+    {
+        error((("Connection: ") + socket.errorString()).toLatin1().data());
+        return;
+    }
+
+    // Create command and send it:
+
+    QString command("GetGridDimensions ");
+    command += caseName;
+    QByteArray cmdBytes = command.toLatin1();
+
+    QDataStream socketStream(&socket);
+    socketStream.setVersion(QDataStream::Qt_4_0);
+
+    socketStream << (qint64)(cmdBytes.size());
+    socket.write(cmdBytes);
+
+    // Get response. First wait for the grid count
+
+    while (socket.bytesAvailable() < (int)(sizeof(quint64)))
+    {
+        if (!socket.waitForReadyRead(Timeout))
+        {
+            error((("Wating for header: ") + socket.errorString()).toLatin1().data());
+            return;
+        }
+    }
+
+    quint64 gridCount;
+    socketStream >> gridCount;
+
+    if (gridCount == 0)
+    {
+        error ("Could not find the requested data in ResInsight");
+        return;
+    }
+
+    // Then the I, J, K dimensions of each grid
+
+    while (socket.bytesAvailable() < (int)(3*gridCount*sizeof(quint64)))
+    {
+        if (!socket.waitForReadyRead(Timeout))
+        {
+            error((("Waiting for grid dimensions: ") + socket.errorString()).toLatin1().data());
+            return;
+        }
+        OCTAVE_QUIT;
+    }
+
+    dim_vector dv (2, 1);
+    dv(0) = gridCount;
+    dv(1) = 3;
+    gridDimensions.resize(dv);
+
+    for (size_t gIdx = 0; gIdx < gridCount; ++gIdx)
+    {
+        quint64 iCount;
+        quint64 jCount;
+        quint64 kCount;
+
+        socketStream >> iCount;
+        socketStream >> jCount;
+        socketStream >> kCount;
+
+        gridDimensions(gIdx, 0) = iCount;
+        gridDimensions(gIdx, 1) = jCount;
+        gridDimensions(gIdx, 2) = kCount;
+    }
+
+    QString tmp = QString("riGetGridDimensions : Read grid dimensions");
+    if (caseName.isEmpty())
+    {
+        tmp += QString(" from active case.");
+    }
+    else
+    {
+        tmp += QString(" from %1.").arg(caseName);
+    }
+    octave_stdout << tmp.toStdString() << " Grids: " << gridCount << std::endl;
+
+    return;
+}
+
+
+
+DEFUN_DLD (riGetGridDimensions, args, nargout,
+           "Usage:\n"
+           "\n"
+           "   riGetGridDimensions( [CaseName/CaseIndex])\n"
+           "\n"
+           "Returns a matrix: [NumberOfGrids][3] \n"
+           "Containing the I, J, K dimensions of the main grid and all the LGR's in the requested case.\n"
+           "Row 1 is the main grid. The row of a grid is its GridIndex from riGetActiveCellInfo plus one.\n"
+           "If the Eclipse Case is not defined, the active View in ResInsight is used."
+           )
+{
+    int nargin = args.length ();
+    if (nargin > 1)
+    {
+        error("riGetGridDimensions: Too many arguments. Only the name or index of the case is valid input.\n");
+        print_usage();
+    }
+    else if (nargout < 1)
+    {
+        error("riGetGridDimensions: Missing output argument.\n");
+        print_usage();
+    }
+    else
+    {
+        int32NDArray gridDimensions;
+
+        if (nargin > 0)
+            getGridDimensions(gridDimensions, "127.0.0.1", 40001, args(0).char_matrix_value().row_as_string(0).c_str());
+        else
+            getGridDimensions(gridDimensions, "127.0.0.1", 40001, "");
+
+        return octave_value(gridDimensions);
+    }
+
+    return octave_value_list ();
+}
+
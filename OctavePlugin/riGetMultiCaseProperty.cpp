@@ -0,0 +1,232 @@
+#include <QtNetwork>
+#include <octave/oct.h>
+
+
+void getMultiCaseProperty(NDArray& propertyFrames, const QString &hostName, quint16 port, QString caseList, QString propertyName, const int32NDArray& requestedTimeSteps)
+{
+    QString serverName = hostName;
+    quint16 serverPort = port;
+
+    const int Timeout = 5 * 1000;
+
+    QTcpSocket socket;
+    socket.connectToHost(serverName, serverPort);
+
+    if (!socket.waitForConnected(Timeout))
+    {
+        error((("Connection: ") + socket.errorString()).toLatin1().data());
+        return;
+    }
+
+    // Create command and send it:
+
+    QString command("GetMultiCaseProperty ");
+    command += caseList + " " + propertyName;
+
+    // Only the requested timesteps are read and sent by ResInsight. Octave indices are 1-based
+    if (requestedTimeSteps.length())
+    {
+        command += " TimeSteps=";
+        for (int i = 0; i < requestedTimeSteps.length(); ++i)
+        {
+            if (i > 0) command += ",";
+            command += QString::number(requestedTimeSteps(i).value() - 1);
+        }
+    }
+
+    // ResInsight runs on this host, so ask for the data through shared memory
+    command += " Transport=SharedMemory";
+
+    QByteArray cmdBytes = command.toLatin1();
+
+    QDataStream socketStream(&socket);
+    socketStream.setVersion(QDataStream::Qt_4_0);
+
+    socketStream << (qint64)(cmdBytes.size());
+    socket.write(cmdBytes);
+
+    // Get response. First wait for the header
+
+    while (socket.bytesAvailable() < (int)(3*sizeof(quint64)))
+    {
+        if (!socket.waitForReadyRead(Timeout))
+        {
+            error((("Wating for header: ") + socket.errorString()).toLatin1().data());
+            return;
+        }
+    }
+
+    // Read case count, timestep count and blocksize
+
+    quint64 caseCount;
+    quint64 timestepCount;
+    quint64 byteCount;
+    size_t  activeCellCount;
+
+    socketStream >> caseCount;
+    socketStream >> timestepCount;
+    socketStream >> byteCount;
+
+    if (!(caseCount && byteCount && timestepCount))
+    {
+        error ("Could not find the requested data in ResInsight");
+        return;
+    }
+
+    activeCellCount = byteCount / sizeof(double);
+
+    dim_vector dv (activeCellCount, timestepCount, caseCount);
+    propertyFrames.resize(dv);
+
+    // Read the shared memory key. If it is empty, the data is sent on the socket
+
+    while (socket.bytesAvailable() < (int)sizeof(quint64))
+    {
+        if (!socket.waitForReadyRead(Timeout))
+        {
+            error((("Waiting for shared memory key: ") + socket.errorString()).toLatin1().data());
+            return;
+        }
+    }
+
+    quint64 keyByteCount;
+    socketStream >> keyByteCount;
+
+    while (socket.bytesAvailable() < (int)keyByteCount)
+    {
+        if (!socket.waitForReadyRead(Timeout))
+        {
+            error((("Waiting for shared memory key: ") + socket.errorString()).toLatin1().data());
+            return;
+        }
+    }
+
+    QString sharedMemoryKey = QString::fromLatin1(socket.read(keyByteCount));
+
+    // The data comes timestep by timestep, with all the cases for each timestep. 
+    // Put it into the [ActiveCells][Timesteps][Cases] array
+
+    double * internalMatrixData = propertyFrames.fortran_vec();
+
+    for (size_t tIdx = 0; tIdx < timestepCount; ++tIdx)
+    {
+        for (size_t cIdx = 0; cIdx < caseCount; ++cIdx)
+        {
+            double* target = internalMatrixData + (cIdx * timestepCount + tIdx) * activeCellCount;
+
+            if (!sharedMemoryKey.isEmpty())
+            {
+                // Copy from the shared memory segment, and tell ResInsight to release it
+                quint64 segmentIndex = tIdx * caseCount + cIdx;
+                QSharedMemory segment(sharedMemoryKey + "-" + QString::number(segmentIndex));
+
+                if (!segment.attach(QSharedMemory::ReadOnly) || segment.size() < (int)byteCount)
+                {
+                    error((("Reading shared memory: ") + segment.errorString()).toLatin1().data());
+                    return;
+                }
+
+                memcpy(target, segment.constData(), byteCount);
+                segment.detach();
+
+                socketStream << segmentIndex;
+                socket.flush();
+            }
+            else
+            {
+                while (socket.bytesAvailable() < (int)byteCount)
+                {
+                    if (!socket.waitForReadyRead(Timeout))
+                    {
+                        error((("Waiting for timestep data number: ") + QString::number(tIdx) + ": " + socket.errorString()).toLatin1().data());
+                        return ;
+                    }
+                    OCTAVE_QUIT;
+                }
+
+                // Use raw data transfer. Faster.
+                qint64 bytesRead = socket.read((char*)(target), byteCount);
+
+                if ((int)byteCount != bytesRead)
+                {
+                    error("Could not read binary double data properly from socket");
+                    return;
+                }
+            }
+
+            OCTAVE_QUIT;
+        }
+    }
+
+    while (socket.bytesToWrite() && socket.waitForBytesWritten(Timeout))
+    {
+        OCTAVE_QUIT;
+    }
+
+    octave_stdout << "riGetMultiCaseProperty : Read " << propertyName.toStdString() << " from " << caseCount << " cases." 
+                  << " Active cells : " << activeCellCount << ", Timesteps : " << timestepCount << std::endl;
+
+    return;
+}
+
+
+
+DEFUN_DLD (riGetMultiCaseProperty, args, nargout,
+           "Usage:\n"
+           "\n"
+           "   riGetMultiCaseProperty( CaseNames/CaseIndices, PropertyName, [RequestedTimeSteps] )\n"
+           "\n"
+           "Returns a three dimentional matrix: [ActiveCells][Timesteps][Cases]\n"
+           "Containing the requested property data from all the requested Eclipse Cases, read in one go.\n"
+           "The cases are given as a vector of case indices, a comma separated string of case names,\n"
+           "or \"All\" for all the cases in the project. The cases must have the same number of active cells.\n"
+           "Values are undefined (Inf) for cases without the property, or with fewer timesteps.\n"
+           "RequestedTimeSteps is a vector of 1-based timestep indices. All timesteps are returned if it is omitted."
+           )
+{
+    int nargin = args.length ();
+    if (nargin < 2)
+    {
+        error("riGetMultiCaseProperty: Too few arguments. The cases and the name of the property requested is neccesary.\n");
+        print_usage();
+    }
+    else if (nargout < 1)
+    {
+        error("riGetMultiCaseProperty: Missing output argument.\n");
+        print_usage();
+    }
+    else
+    {
+        NDArray propertyFrames;
+
+        QString caseList;
+        if (args(0).is_string())
+        {
+            caseList = args(0).char_matrix_value().row_as_string(0).c_str();
+        }
+        else
+        {
+            int32NDArray caseIndices = args(0).int32_array_value();
+            for (int i = 0; i < caseIndices.length(); ++i)
+            {
+                if (i > 0) caseList += ",";
+                caseList += QString::number(caseIndices(i).value());
+            }
+        }
+
+        QString propertyName = args(1).char_matrix_value().row_as_string(0).c_str();
+
+        int32NDArray requestedTimeSteps;
+        if (nargin > 2)
+        {
+            requestedTimeSteps = args(2).int32_array_value();
+        }
+
+        getMultiCaseProperty(propertyFrames, "127.0.0.1", 40001, caseList, propertyName, requestedTimeSteps);
+
+        return octave_value(propertyFrames);
+    }
+
+    return octave_value_list ();
+}
+
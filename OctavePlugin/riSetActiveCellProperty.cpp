@@ -1,5 +1,6 @@
 #include <QtNetwork>
 #include <octave/oct.h>
+#include <limits>
 
 
 void setEclipseProperty(const Matrix& propertyFrames, const QString &hostName, quint16 port, QString caseName, QString propertyName)
@@ -8,6 +9,7 @@ void setEclipseProperty(const Matrix& propertyFrames, const QString &hostName, q
     quint16 serverPort = port;
 
     const int Timeout = 5 * 1000;
+    const int MaxAckTimeoutCount = 12; // Give ResInsight a minute to copy the data
 
     QTcpSocket socket;
     socket.connectToHost(serverName, serverPort);
@@ -18,10 +20,40 @@ void setEclipseProperty(const Matrix& propertyFrames, const QString &hostName, q
         return;
     }
 
+    dim_vector mxDims = propertyFrames.dims();
+
+    qint64 cellCount = mxDims.elem(0);
+    qint64 timeStepCount = mxDims.elem(1);
+    qint64 timeStepByteCount = cellCount * sizeof(double);
+
+    const double* internalData = propertyFrames.fortran_vec();
+
+    // ResInsight runs on this host, so hand the data over in one shared memory segment per timestep.
+    // Fall back to sending it on the socket if the segments can not be created
+
+    QString sharedMemoryKey = QString("ResInsightOctave-%1-%2").arg(QCoreApplication::applicationPid()).arg(QDateTime::currentMSecsSinceEpoch());
+    std::vector<QSharedMemory*> segments;
+
+    for (qint64 tIdx = 0; tIdx < timeStepCount; ++tIdx)
+    {
+        QSharedMemory* segment = new QSharedMemory(sharedMemoryKey + "-" + QString::number(tIdx));
+        segments.push_back(segment);
+
+        if (timeStepByteCount > std::numeric_limits<int>::max() || !segment->create((int)timeStepByteCount))
+        {
+            for (size_t sIdx = 0; sIdx < segments.size(); ++sIdx) delete segments[sIdx];
+            segments.clear();
+            break;
+        }
+
+        memcpy(segment->data(), internalData + tIdx * cellCount, timeStepByteCount);
+    }
+
     // Create command and send it:
 
     QString command("SetProperty ");
     command += caseName + " " + propertyName;
+    if (!segments.empty()) command += " SharedMemoryKey=" + sharedMemoryKey;
     QByteArray cmdBytes = command.toLatin1();
 
     QDataStream socketStream(&socket);
@@ -32,17 +64,47 @@ void setEclipseProperty(const Matrix& propertyFrames, const QString &hostName, q
 
     // Write property data header
 
-    dim_vector mxDims = propertyFrames.dims();
-
-    qint64 cellCount = mxDims.elem(0);
-    qint64 timeStepCount = mxDims.elem(1);
-    qint64 timeStepByteCount = cellCount * sizeof(double);
-
     socketStream << (qint64)(timeStepCount);
     socketStream << (qint64)timeStepByteCount;
 
-    const double* internalData = propertyFrames.fortran_vec();
-    int dataWritten = socket.write((const char *)internalData, timeStepByteCount*timeStepCount);
+    qint64 dataWritten = 0;
+
+    if (!segments.empty())
+    {
+        // Keep the segments until ResInsight acknowledges that it has copied them
+
+        int timeoutCount = 0;
+        while (socket.bytesAvailable() < (int)sizeof(quint64))
+        {
+            if (!socket.waitForReadyRead(Timeout))
+            {
+                if (socket.state() != QAbstractSocket::ConnectedState || ++timeoutCount >= MaxAckTimeoutCount)
+                {
+                    break;
+                }
+            }
+            OCTAVE_QUIT;
+        }
+
+        bool isAcknowledged = socket.bytesAvailable() >= (int)sizeof(quint64);
+        if (isAcknowledged)
+        {
+            quint64 timeStepsRead = 0;
+            socketStream >> timeStepsRead;
+            dataWritten = timeStepsRead * timeStepByteCount;
+        }
+
+        for (size_t sIdx = 0; sIdx < segments.size(); ++sIdx) delete segments[sIdx];
+
+        if (!isAcknowledged)
+        {
+            error((("Waiting for ResInsight to read the data: ") + socket.errorString()).toLatin1().data());
+        }
+    }
+    else
+    {
+        dataWritten = socket.write((const char *)internalData, timeStepByteCount*timeStepCount);
+    }
 
     if (dataWritten == timeStepByteCount*timeStepCount)
     {
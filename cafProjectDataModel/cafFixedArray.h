@@ -35,11 +35,12 @@ public:
     template<typename IndexType> T  operator[](const IndexType& index) const { CVF_TIGHT_ASSERT(static_cast<size_t>(index) < size); return m_array[index]; }
 };
 
-typedef FixedArray<int, 3>    IntArray3;
-typedef FixedArray<int, 4>    IntArray4;
-typedef FixedArray<int, 8>    IntArray8;
-typedef FixedArray<size_t, 3> SizeTArray3;
-typedef FixedArray<size_t, 4> SizeTArray4;
-typedef FixedArray<size_t, 8> SizeTArray8;
+typedef FixedArray<int, 3>          IntArray3;
+typedef FixedArray<int, 4>          IntArray4;
+typedef FixedArray<int, 8>          IntArray8;
+typedef FixedArray<unsigned int, 8> UIntArray8;
+typedef FixedArray<size_t, 3>       SizeTArray3;
+typedef FixedArray<size_t, 4>       SizeTArray4;
+typedef FixedArray<size_t, 8>       SizeTArray8;
 
 }
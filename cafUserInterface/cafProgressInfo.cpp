@@ -239,12 +239,18 @@ static QString currentComposedLabel()
 
 }
 
+//--------------------------------------------------------------------------------------------------
+/// Progress is only shown for work done in the GUI thread. Checked before the dialog is touched,
+/// as it must not be created by a worker thread. Workers report progress by other means.
+//--------------------------------------------------------------------------------------------------
 static bool isUpdatePossible()
 {
     if (!qApp) return false;
 
+    if (QThread::currentThread() != qApp->thread()) return false;
+
     if (!progressDialog()) return false;
-    
+
     return progressDialog()->thread() == QThread::currentThread();
 }
 //==================================================================================================